@@ -36,8 +36,8 @@ extern "C" {
 #define DEBUG      0
 /*---------- Print the data travelling over the SPI in the .csv format for the GUI -----------*/
 #define PRINT_CSV_FORMAT      0
-/*---------- Number of Bytes reserved for HCI Read Packet -----------*/
-#define HCI_READ_PACKET_SIZE      128
+/*---------- Number of Bytes reserved for HCI Read Packet (largest HCI event: type + header + 255 bytes of parameters) -----------*/
+#define HCI_READ_PACKET_SIZE      258
 /*---------- Number of Bytes reserved for HCI Max Payload -----------*/
 #define HCI_MAX_PAYLOAD_SIZE      128
 /*---------- Scan Interval: time interval from when the Controller started its last scan until it begins the subsequent scan (for a number N, Time = N x 0.625 msec) -----------*/
@@ -60,14 +60,96 @@ extern "C" {
 #define ADV_INTERV_MIN      2048
 /*---------- Maximum Advertising Interval (for a number N, Time = N x 0.625 msec) -----------*/
 #define ADV_INTERV_MAX      4096
+/*---------- Minimum Advertising Interval of the fast burst after a start or a disconnection (for a number N, Time = N x 0.625 msec) -----------*/
+#define ADV_FAST_INTERV_MIN      32
+/*---------- Maximum Advertising Interval of the fast burst (for a number N, Time = N x 0.625 msec) -----------*/
+#define ADV_FAST_INTERV_MAX      48
+/*---------- Duration (ms) of the fast burst, then the advertising uses ADV_INTERV_MIN/ADV_INTERV_MAX -----------*/
+#define ADV_FAST_DURATION_MS      30000
+/*---------- Interval (ms) between two attempts to start the advertising after a failure -----------*/
+#define ADV_RETRY_MS      1000
+/*---------- Maximum number of simultaneous links, power of two (the BlueNRG-MS supports 8, lowered at run time for the BlueNRG) -----------*/
+#define BLE_MAX_LINKS      8
+/*---------- Values a link may have in the controller, given back by the Number Of Completed Packets event of the link or a TX pool available event (until the ACL buffers of the controller are read and split across the links) -----------*/
+#define BLE_LINK_TX_CREDITS      4
+/*---------- Time (ms) without a credit given back after which a link gets its credits back, in case a completed packets event was lost -----------*/
+#define BLE_LINK_CREDIT_TIMEOUT_MS      250
+/*---------- Number of characteristics whose notification and indication subscribers are tracked per link (32 at most) -----------*/
+#define BLE_MAX_SUBSCRIBED_CHARS      8
+/*---------- Values queued per characteristic while the controller TX pool is full -----------*/
+#define NOTIFY_QUEUE_DEPTH      8
+/*---------- ATT MTU offered in the MTU exchange (158 at most for the BlueNRG-MS) -----------*/
+#define BLE_ATT_MTU_MAX      158
+/*---------- Maximum length of a queued notification value (118 at most: one ACI_GATT_UPDATE_CHAR_VALUE command) -----------*/
+#define NOTIFY_VALUE_MAX      118
+/*---------- Maximum length of a long characteristic value sent in chunks (512 for the BlueNRG-MS) -----------*/
+#define NOTIFY_LONG_VALUE_MAX      512
+/*---------- Maximum length of a characteristic value kept in a host shadow -----------*/
+#define VALUE_SHADOW_MAX      20
+/*---------- Maximum number of attribute handles of the GATT database table -----------*/
+#define GATT_DB_MAX_ATTRS      32
+/*---------- Longest wait for EVT_BLUE_HAL_INITIALIZED after the reset of the BlueNRG (ms) -----------*/
+#define BLE_BOOT_READY_TIMEOUT_MS      100
+/*---------- IFR profile programmed at start-up, BLE_IFR_PROFILE_* of ble_ifr.h (0: keep the IFR of the BlueNRG-MS) -----------*/
+#define BLE_IFR_PROFILE      0
+/*---------- Accuracy (ppm) of the 32 kHz sleep clock of the board, announced by the low power profile -----------*/
+#define BLE_IFR_SLEEP_CLOCK_PPM      50
+/*---------- Bytes of each of the two RAM buffers of the application update, programmed to flash when full (multiple of 4) -----------*/
+#define DFU_BUF_SIZE      2048
+/*---------- Bytes programmed between two progress notifications of the application update -----------*/
+#define DFU_ACK_BYTES      8192
+/*---------- Application update over GATT (DFU service). It reflashes the board: off unless the product provisions BLE_DFU_PASSKEY and BLE_DFU_KEY -----------*/
+#define BLE_DFU_ENABLE      0
+/*---------- Fixed passkey (6 digits) of the authenticated pairing the DFU service requires, secret of each product -----------*/
+/* #define BLE_DFU_PASSKEY      123456 */
+/*---------- HMAC-SHA256 key (32 bytes) the images must be signed with, secret of each product -----------*/
+/* #define BLE_DFU_KEY      {0x00, ...} */
 /*---------- Minimum Connection Event Interval (for a number N, Time = N x 1.25 msec) -----------*/
 #define L2CAP_INTERV_MIN      9
 /*---------- Maximum Connection Event Interval (for a number N, Time = N x 1.25 msec) -----------*/
 #define L2CAP_INTERV_MAX      20
 /*---------- Timeout Multiplier (for a number N, Time = N x 10 msec) -----------*/
 #define L2CAP_TIMEOUT_MULTIPLIER      600
+/*---------- Minimum Connection Event Interval requested while a link is idle (for a number N, Time = N x 1.25 msec), L2CAP_INTERV_MIN/MAX during transfers -----------*/
+#define CONN_IDLE_INTERV_MIN      80
+/*---------- Maximum Connection Event Interval requested while a link is idle (for a number N, Time = N x 1.25 msec) -----------*/
+#define CONN_IDLE_INTERV_MAX      160
+/*---------- Slave latency requested while a link is idle (connection events), 0 during transfers -----------*/
+#define CONN_IDLE_LATENCY      4
+/*---------- Period (ms) of the evaluation of the traffic of the links -----------*/
+#define CONN_PARAMS_PERIOD_MS      250
+/*---------- Notifications per second from which a link is busy -----------*/
+#define CONN_PARAMS_BUSY_RATE      10
+/*---------- Time (ms) without traffic after which a link is idle -----------*/
+#define CONN_PARAMS_IDLE_MS      2000
+/*---------- Minimum time (ms) between two connection parameter update requests of a link -----------*/
+#define CONN_PARAMS_MIN_GAP_MS      5000
+/*---------- Maximum time (ms) between two requests after successive rejections -----------*/
+#define CONN_PARAMS_MAX_BACKOFF_MS      60000
 
 #define HCI_DEFAULT_TIMEOUT_MS        1000
+/*---------- Number of asynchronous commands waiting for a controller credit (hci_send_cmd_async) -----------*/
+#define HCI_CMD_QUEUE_LEN             4
+/*---------- Number of commands sent and waiting for their Command Complete/Status event -----------*/
+#define HCI_CMD_INFLIGHT_MAX          4
+/*---------- Bytes kept for the events that find no room in the receive ring while a command response is awaited -----------*/
+#define HCI_EVT_SPILL_SIZE            512
+/*---------- Bytes of the HCI receive ring: events are stored with their actual length (multiple of 4) -----------*/
+#define HCI_RX_RING_SIZE              1024
+/*---------- Read HCI event payloads with a single SPI1 DMA burst (0: polled burst) -----------*/
+#define HCI_TL_SPI_RX_DMA      1
+/*---------- Payloads shorter than this number of bytes are read with a polled burst even in DMA mode -----------*/
+#define HCI_TL_SPI_RX_DMA_MIN_LEN      8
+/*---------- Interval (ms) between two attempts to write a command the BlueNRG did not accept -----------*/
+#define HCI_TL_SPI_TX_RETRY_MS      1
+/*---------- Drain the BlueNRG from PendSV (lowest priority) instead of the EXTI0 interrupt (0: drain in the EXTI0 interrupt) -----------*/
+#define HCI_TL_DEFERRED_ISR      1
+/*---------- Maximum number of packets read by one run of the PendSV bottom half -----------*/
+#define HCI_TL_DRAIN_BUDGET      4
+/*---------- Collect cycle statistics in the transport and HCI layers (DWT cycle counter) -----------*/
+#define BLUENRG_STATS      1
+/*---------- Build the on-target benchmarks of ble_bench.c, results are printed on USART2 -----------*/
+#define BLE_BENCH      0
 
 #define BLUENRG_memcpy                memcpy
 #define BLUENRG_memset                memset
@@ -78,6 +160,15 @@ extern "C" {
 #define PRINTF(...)
 #endif
 
+#if (BLUENRG_STATS == 1)
+#define BLUENRG_CYCLES()              (DWT->CYCCNT)
+#define BLUENRG_CYCLES_INIT()         do { CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; \
+                                           DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk; } while(0)
+#else
+#define BLUENRG_CYCLES()              0U
+#define BLUENRG_CYCLES_INIT()
+#endif
+
 #if PRINT_CSV_FORMAT
 #include <stdio.h>
 #define PRINT_CSV(...)                printf(__VA_ARGS__)
@@ -30,8 +30,66 @@
 #define MAX_BUFFER_SIZE   255U
 #define TIMEOUT_DURATION  15U
 
+#if (HCI_TL_SPI_RX_DMA == 1) && (USE_BUS_SPI1_DMA != 1U)
+#error "HCI_TL_SPI_RX_DMA requires USE_BUS_SPI1_DMA"
+#endif
+
 EXTI_HandleTypeDef hexti0;
 
+/* Dummy bytes clocked out on MOSI while the payload is read (up to a full HCI event) */
+static uint8_t SpiFillBuffer[HCI_READ_PACKET_SIZE];
+
+static tHciTlSpiRxStats SpiRxStats;
+static uint32_t         SpiCsLowStart;
+
+#if (HCI_TL_SPI_RX_DMA == 1)
+static uint8_t          SpiRxMode = HCI_TL_SPI_RX_MODE_DMA;
+static volatile uint8_t SpiRxDmaBusy = 0;
+static uint16_t         SpiRxDmaLen;
+static uint8_t*         SpiRxDmaBuffer;
+#endif
+
+#define HCI_TL_SPI_TX_IDLE     0U
+#define HCI_TL_SPI_TX_PENDING  1U
+
+static uint8_t           SpiTxFrame[HCI_MAX_PAYLOAD_SIZE];
+static uint16_t          SpiTxLen;
+static volatile uint8_t  SpiTxState = HCI_TL_SPI_TX_IDLE;
+static uint32_t          SpiTxStart;
+static uint32_t          SpiTxLastTry;
+static tHciTlSpiTxStats  SpiTxStats;
+
+static tHciTlIsrStats    IsrStats;
+#if (HCI_TL_DEFERRED_ISR == 1)
+static uint8_t           IsrMode = HCI_TL_SPI_ISR_MODE_DEFERRED;
+#define HCI_TL_PEND_BOTTOM_HALF()  (SCB->ICSR = SCB_ICSR_PENDSVSET_Msk)
+#endif
+
+static int32_t IsDataAvailable(void);
+static void HCI_TL_SPI_TxDone(int32_t status);
+
+/**
+ * @brief  Update the receive statistics when the CS line is released.
+ *
+ * @param  len : Number of payload bytes read in the transaction
+ * @param  dma : 1 if the payload has been read by DMA
+ * @retval None
+ */
+static void HCI_TL_SPI_RxStatsUpdate(uint16_t len, uint8_t dma)
+{
+  uint32_t cs_low = BLUENRG_CYCLES() - SpiCsLowStart;
+  
+  if (len == 0)
+    return;
+  
+  SpiRxStats.rx_transfers++;
+  SpiRxStats.rx_dma_transfers += dma;
+  SpiRxStats.rx_bytes += len;
+  SpiRxStats.cs_low_cycles += cs_low;
+  if (cs_low > SpiRxStats.cs_low_cycles_max)
+    SpiRxStats.cs_low_cycles_max = cs_low;
+}
+
 /******************** IO Operation and BUS services ***************************/
 
 /**
@@ -65,6 +123,9 @@ int32_t HCI_TL_SPI_Init(void* pConf)
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(HCI_TL_SPI_CS_PORT, &GPIO_InitStruct); 
+  
+  memset(SpiFillBuffer, 0xFF, sizeof(SpiFillBuffer));
+  BLUENRG_CYCLES_INIT();
     
   return BSP_SPI1_Init();
 }
@@ -101,23 +162,26 @@ int32_t HCI_TL_SPI_Reset(void)
 
 /**
  * @brief  Reads from BlueNRG SPI buffer and store data into local buffer.
+ *         The payload is clocked in one burst: by DMA when it is long enough
+ *         and the DMA mode is selected, with a single polled transfer otherwise.
  *
  * @param  buffer : Buffer where data from SPI are stored
  * @param  size   : Buffer size
- * @retval int32_t: Number of read bytes
+ * @retval int32_t: Number of read bytes, HCI_IO_RX_PENDING if the payload
+ *                  is being read by DMA (completion is reported to the HCI
+ *                  layer through hci_notify_receive_complete())
  */
 int32_t HCI_TL_SPI_Receive(uint8_t* buffer, uint16_t size)
 {
   uint16_t byte_count;
-  uint8_t len = 0;
-  uint8_t char_ff = 0xff;
-  volatile uint8_t read_char;
+  uint16_t len = 0;
 
   uint8_t header_master[HEADER_SIZE] = {0x0b, 0x00, 0x00, 0x00, 0x00};
   uint8_t header_slave[HEADER_SIZE];
 
   /* CS reset */
   HAL_GPIO_WritePin(HCI_TL_SPI_CS_PORT, HCI_TL_SPI_CS_PIN, GPIO_PIN_RESET);
+  SpiCsLowStart = BLUENRG_CYCLES();
 
   /* Read the header */  
   BSP_SPI1_SendRecv(header_master, header_slave, HEADER_SIZE);
@@ -134,16 +198,32 @@ int32_t HCI_TL_SPI_Receive(uint8_t* buffer, uint16_t size)
       if (byte_count > size){
         byte_count = size;
       }        
+      
+#if (HCI_TL_SPI_RX_DMA == 1)
+      if ((SpiRxMode == HCI_TL_SPI_RX_MODE_DMA) && (byte_count >= HCI_TL_SPI_RX_DMA_MIN_LEN))
+      {
+        SpiRxDmaBuffer = buffer;
+        SpiRxDmaLen = byte_count;
+        SpiRxDmaBusy = 1;
+        
+        if (BSP_SPI1_SendRecv_DMA(SpiFillBuffer, buffer, byte_count) == BSP_ERROR_NONE)
+        {
+          /* CS is released in HCI_TL_SPI_RxDmaDone() */
+          return HCI_IO_RX_PENDING;
+        }
+        SpiRxDmaBusy = 0;
+      }
+#endif
   
-      for(len = 0; len < byte_count; len++)
-      {                                               
-        BSP_SPI1_SendRecv(&char_ff, (uint8_t*)&read_char, 1);  
-        buffer[len] = read_char;
-      }      
+      if (BSP_SPI1_SendRecv(SpiFillBuffer, buffer, byte_count) == BSP_ERROR_NONE)
+      {
+        len = byte_count;
+      }
     }    
   }
   /* Release CS line */
   HAL_GPIO_WritePin(HCI_TL_SPI_CS_PORT, HCI_TL_SPI_CS_PIN, GPIO_PIN_SET);
+  HCI_TL_SPI_RxStatsUpdate(len, 0);
   
 #if PRINT_CSV_FORMAT
   if (len > 0) {
@@ -158,61 +238,279 @@ int32_t HCI_TL_SPI_Receive(uint8_t* buffer, uint16_t size)
   return len;  
 }
 
+#if (HCI_TL_SPI_RX_DMA == 1)
 /**
- * @brief  Writes data from local buffer to SPI.
+ * @brief  End of a DMA payload read: release CS, hand the packet back to the
+ *         HCI layer and keep draining if the BlueNRG has more data.
  *
- * @param  buffer : data buffer to be written
- * @param  size   : size of first data buffer to be written
- * @retval int32_t: Number of read bytes
+ * @param  len : Number of bytes read, 0 on transfer error
+ * @retval None
  */
-int32_t HCI_TL_SPI_Send(uint8_t* buffer, uint16_t size)
-{  
-  int32_t result;  
+static void HCI_TL_SPI_RxDmaDone(uint16_t len)
+{
+  /* Release CS line */
+  HAL_GPIO_WritePin(HCI_TL_SPI_CS_PORT, HCI_TL_SPI_CS_PIN, GPIO_PIN_SET);
+  HCI_TL_SPI_RxStatsUpdate(len, 1);
+  SpiRxDmaBusy = 0;
+  
+#if PRINT_CSV_FORMAT
+  if (len > 0) {
+    print_csv_time();
+    for (int i=0; i<len; i++) {
+      PRINT_CSV(" %02x", SpiRxDmaBuffer[i]);
+    }
+    PRINT_CSV("\n");
+  }
+#endif
+  
+  hci_notify_receive_complete(len);
+  
+  /* The IRQ line may have stayed high: no new edge will be seen on EXTI.
+     A write held back by the read is restarted the same way. */
+  if (IsDataAvailable() || (SpiTxState == HCI_TL_SPI_TX_PENDING))
+  {
+    HAL_EXTI_GenerateSWI(&hexti0);
+  }
+}
+
+/**
+ * @brief  SPI full duplex DMA transfer completed.
+ *
+ * @param  hspi : SPI handle
+ * @retval None
+ */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  if ((hspi->Instance == BUS_SPI1_INSTANCE) && SpiRxDmaBusy)
+  {
+    HCI_TL_SPI_RxDmaDone(SpiRxDmaLen);
+  }
+}
+
+/**
+ * @brief  SPI transfer error: the packet being read is dropped.
+ *
+ * @param  hspi : SPI handle
+ * @retval None
+ */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+  if ((hspi->Instance == BUS_SPI1_INSTANCE) && SpiRxDmaBusy)
+  {
+    HCI_TL_SPI_RxDmaDone(0);
+  }
+}
+
+#endif /* HCI_TL_SPI_RX_DMA */
+
+/**
+ * @brief  Select how the event payloads are read.
+ *         Without HCI_TL_SPI_RX_DMA the polled burst is always used.
+ *
+ * @param  mode : HCI_TL_SPI_RX_MODE_POLLED or HCI_TL_SPI_RX_MODE_DMA
+ * @retval None
+ */
+void HCI_TL_SPI_SetRxMode(uint8_t mode)
+{
+#if (HCI_TL_SPI_RX_DMA == 1)
+  SpiRxMode = mode;
+#else
+  (void)mode;
+#endif
+}
+
+/**
+ * @brief  Get the receive path statistics.
+ *
+ * @param  stats : Filled with the statistics collected since the last reset
+ * @retval None
+ */
+void HCI_TL_SPI_GetRxStats(tHciTlSpiRxStats *stats)
+{
+  *stats = SpiRxStats;
+}
+
+/**
+ * @brief  Reset the receive path statistics.
+ *
+ * @param  None
+ * @retval None
+ */
+void HCI_TL_SPI_ResetRxStats(void)
+{
+  memset(&SpiRxStats, 0, sizeof(SpiRxStats));
+}
+
+/**
+ * @brief  Try once to write the pending frame to the BlueNRG.
+ *         Called from the IRQ line handler and from the SysTick retry timer,
+ *         both running at the same priority, so the bus is never shared with
+ *         a read in progress.
+ *
+ * @param  None
+ * @retval None
+ */
+static void HCI_TL_SPI_TxTry(void)
+{
+  int32_t result = 0;
   
   uint8_t header_master[HEADER_SIZE] = {0x0a, 0x00, 0x00, 0x00, 0x00};
   uint8_t header_slave[HEADER_SIZE];
   
   static uint8_t read_char_buf[MAX_BUFFER_SIZE];
-  uint32_t tickstart = HAL_GetTick();
   
-  do
+  if (SpiTxState != HCI_TL_SPI_TX_PENDING)
+    return;
+  
+#if (HCI_TL_SPI_RX_DMA == 1)
+  /* Retried at the end of the DMA read */
+  if (SpiRxDmaBusy)
+    return;
+#endif
+  
+  SpiTxLastTry = HAL_GetTick();
+  
+  /* CS reset */
+  HAL_GPIO_WritePin(HCI_TL_SPI_CS_PORT, HCI_TL_SPI_CS_PIN, GPIO_PIN_RESET);
+  
+  /* Read header */  
+  BSP_SPI1_SendRecv(header_master, header_slave, HEADER_SIZE);
+  
+  if(header_slave[0] == 0x02) 
   {
-    result = 0;
-    
-    /* CS reset */
-    HAL_GPIO_WritePin(HCI_TL_SPI_CS_PORT, HCI_TL_SPI_CS_PIN, GPIO_PIN_RESET);
-    
-    /* Read header */  
-    BSP_SPI1_SendRecv(header_master, header_slave, HEADER_SIZE);
-    
-    if(header_slave[0] == 0x02) 
+    /* SPI is ready */
+    if(header_slave[1] >= SpiTxLen) 
     {
-      /* SPI is ready */
-      if(header_slave[1] >= size) 
-      {
-        BSP_SPI1_SendRecv(buffer, read_char_buf, size);
-      } 
-      else 
-      {
-        /* Buffer is too small */
-        result = -2;
-      }
-    } else {
-      /* SPI is not ready */
-      result = -1;
-    }
-    
-    /* Release CS line */
-    HAL_GPIO_WritePin(HCI_TL_SPI_CS_PORT, HCI_TL_SPI_CS_PIN, GPIO_PIN_SET);
-    
-    if((HAL_GetTick() - tickstart) > TIMEOUT_DURATION)
+      BSP_SPI1_SendRecv(SpiTxFrame, read_char_buf, SpiTxLen);
+    } 
+    else 
     {
-      result = -3;
-      break;
+      /* Buffer is too small */
+      SpiTxStats.tx_buffer_too_small++;
+      result = -2;
     }
-  } while(result < 0);
+  } else {
+    /* SPI is not ready */
+    SpiTxStats.tx_not_ready++;
+    result = -1;
+  }
+  
+  /* Release CS line */
+  HAL_GPIO_WritePin(HCI_TL_SPI_CS_PORT, HCI_TL_SPI_CS_PIN, GPIO_PIN_SET);
+  
+  if (result == 0)
+  {
+    SpiTxStats.tx_frames++;
+    HCI_TL_SPI_TxDone(0);
+  }
+  else if ((SpiTxLastTry - SpiTxStart) > TIMEOUT_DURATION)
+  {
+    SpiTxStats.tx_timeout++;
+    HCI_TL_SPI_TxDone(-3);
+  }
+}
+
+/**
+ * @brief  Release the TX slot and report the outcome to the HCI layer.
+ *
+ * @param  status : 0 if the frame has been written, -3 on timeout
+ * @retval None
+ */
+static void HCI_TL_SPI_TxDone(int32_t status)
+{
+  SpiTxState = HCI_TL_SPI_TX_IDLE;
+  hci_notify_send_complete(status);
+}
+
+/**
+ * @brief  Queue a frame to be written to the BlueNRG.
+ *         The frame is copied in the TX slot, unless it has been built there
+ *         (HCI_TL_SPI_GetTxBuffer()), and written from the IRQ line
+ *         handler; while the BlueNRG is not ready or has not enough room the
+ *         write is retried every HCI_TL_SPI_TX_RETRY_MS, up to TIMEOUT_DURATION.
+ *         The outcome is reported through hci_notify_send_complete().
+ *
+ * @param  buffer : data buffer to be written
+ * @param  size   : size of first data buffer to be written
+ * @retval int32_t: 0 if the frame is queued, HCI_IO_TX_BUSY if the slot still
+ *                  holds the previous frame, -2 if the frame is too long
+ */
+int32_t HCI_TL_SPI_Send(uint8_t* buffer, uint16_t size)
+{  
+  if (SpiTxState != HCI_TL_SPI_TX_IDLE)
+    return HCI_IO_TX_BUSY;
+  
+  if (size > sizeof(SpiTxFrame))
+    return -2;
+  
+  /* Frames built in place by the HCI layer are not copied */
+  if (buffer != SpiTxFrame)
+  {
+    memcpy(SpiTxFrame, buffer, size);
+  }
+  SpiTxLen = size;
+  SpiTxStart = HAL_GetTick();
+  SpiTxLastTry = SpiTxStart;
+  SpiTxState = HCI_TL_SPI_TX_PENDING;
+  
+  /* First attempt from the IRQ line handler, where the reads run */
+  HAL_EXTI_GenerateSWI(&hexti0);
+  
+  return 0;
+}
+
+/**
+ * @brief  The HCI layer has free packets again: restart the reads if the
+ *         BlueNRG kept data while the reads were stopped (the IRQ line stayed
+ *         high, no new edge will be seen on EXTI).
+ *
+ * @param  buffer : Not used
+ * @param  len    : Not used
+ * @retval int32_t: 0
+ */
+int32_t HCI_TL_SPI_DataAck(uint8_t* buffer, uint16_t* len)
+{
+  (void)buffer;
+  (void)len;
   
-  return result;
+  if (IsDataAvailable())
+  {
+    HAL_EXTI_GenerateSWI(&hexti0);
+  }
+  return 0;
+}
+
+/**
+ * @brief  Give the TX slot to the HCI layer to build the next frame in place.
+ *
+ * @param  None
+ * @retval uint8_t*: The TX slot, NULL while it holds a frame not yet written
+ */
+uint8_t* HCI_TL_SPI_GetTxBuffer(void)
+{
+  return (SpiTxState == HCI_TL_SPI_TX_IDLE) ? SpiTxFrame : NULL;
+}
+
+/**
+ * @brief  Get the send path statistics.
+ *
+ * @param  stats : Filled with the statistics collected since the last reset
+ * @retval None
+ */
+void HCI_TL_SPI_GetTxStats(tHciTlSpiTxStats *stats)
+{
+  *stats = SpiTxStats;
+}
+
+/**
+ * @brief  Reset the send path statistics.
+ *
+ * @param  None
+ * @retval None
+ */
+void HCI_TL_SPI_ResetTxStats(void)
+{
+  memset(&SpiTxStats, 0, sizeof(SpiTxStats));
 }
 
 /**
@@ -238,7 +536,7 @@ void hci_tl_lowlevel_init(void)
   /* USER CODE BEGIN hci_tl_lowlevel_init 1 */
   
   /* USER CODE END hci_tl_lowlevel_init 1 */
-  tHciIO fops;  
+  tHciIO fops = {0};  
   
   /* Register IO bus services */
   fops.Init    = HCI_TL_SPI_Init;
@@ -247,6 +545,8 @@ void hci_tl_lowlevel_init(void)
   fops.Receive = HCI_TL_SPI_Receive;
   fops.Reset   = HCI_TL_SPI_Reset;
   fops.GetTick = BSP_GetTick;
+  fops.GetTxBuffer = HCI_TL_SPI_GetTxBuffer;
+  fops.DataAck = HCI_TL_SPI_DataAck;
   
   hci_register_io_bus (&fops);
   
@@ -259,6 +559,9 @@ void hci_tl_lowlevel_init(void)
   HAL_EXTI_RegisterCallback(&hexti0, HAL_EXTI_COMMON_CB_ID, hci_tl_lowlevel_isr);
   HAL_NVIC_SetPriority(EXTI0_IRQn, 0, 0);
   HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+#if (HCI_TL_DEFERRED_ISR == 1)
+  HAL_NVIC_SetPriority(PendSV_IRQn, HCI_TL_PENDSV_PRIORITY, 0);
+#endif
 
   /* USER CODE BEGIN hci_tl_lowlevel_init 3 */
   
@@ -267,26 +570,174 @@ void hci_tl_lowlevel_init(void)
 }
 
 /**
- * @brief HCI 传输层低级中断服务程序
- * @details 当 BlueNRG-MS 模块通过中断通知主机有数据可用时调用。
- *          该函数会检查是否有数据可用，并调用 HCI 异步事件通知函数处理数据。
- * @param  None
- * @retval None
+ * @brief  Write the pending command frame and read the BlueNRG.
+ *
+ * @param  budget : Maximum number of packets to read
+ * @retval uint8_t: 1 if the budget ran out with data still available
  */
-void hci_tl_lowlevel_isr(void)
+static uint8_t HCI_TL_SPI_Drain(uint32_t budget)
 {
+  /* 先尝试写出挂起的命令帧 */
+  HCI_TL_SPI_TxTry();
+  
   // 调用 hci_notify_asynch_evt() 处理异步事件
   while(IsDataAvailable()) // 检查是否有数据可用
   {        
+    if (budget == 0)
+    {
+      return 1;
+    }
+    budget--;
+    
     if (hci_notify_asynch_evt(NULL)) // 如果事件处理完成，则退出
     {
-      return;
+      return 0;
     }
   }
+  return 0;
+}
+
+/**
+ * @brief  Keep the longest run of an interrupt context.
+ *
+ * @param  max   : Longest run so far, in CPU cycles
+ * @param  start : Cycle counter at the start of the run
+ * @retval None
+ */
+static void HCI_TL_IsrStatsUpdate(uint32_t *max, uint32_t start)
+{
+  uint32_t cycles = BLUENRG_CYCLES() - start;
+  
+  if (cycles > *max)
+    *max = cycles;
+}
+
+/**
+ * @brief HCI 传输层低级中断服务程序
+ * @details 当 BlueNRG-MS 模块通过中断通知主机有数据可用时调用。
+ *          延迟模式下只挂起 PendSV，由 hci_tl_lowlevel_bottom_half() 读取数据；
+ *          否则直接在中断中检查是否有数据可用，并调用 HCI 异步事件通知函数处理数据。
+ * @param  None
+ * @retval None
+ */
+void hci_tl_lowlevel_isr(void)
+{
+  uint32_t start = BLUENRG_CYCLES();
+  
+  IsrStats.isr_runs++;
+  
+#if (HCI_TL_DEFERRED_ISR == 1)
+  if (IsrMode == HCI_TL_SPI_ISR_MODE_DEFERRED)
+  {
+    HCI_TL_PEND_BOTTOM_HALF();
+  }
+  else
+#endif
+  {
+    HCI_TL_SPI_Drain(UINT32_MAX);
+  }
 
   /* USER CODE BEGIN hci_tl_lowlevel_isr */
 
   /* USER CODE END hci_tl_lowlevel_isr */ 
+  
+  HCI_TL_IsrStatsUpdate(&IsrStats.isr_cycles_max, start);
+}
+
+/**
+ * @brief  Bottom half of the IRQ line handling, run from PendSV at the lowest
+ *         priority. At most HCI_TL_DRAIN_BUDGET packets are read per run, PendSV
+ *         is pended again when the BlueNRG still has data.
+ *
+ * @param  None
+ * @retval None
+ */
+void hci_tl_lowlevel_bottom_half(void)
+{
+#if (HCI_TL_DEFERRED_ISR == 1)
+  uint32_t start = BLUENRG_CYCLES();
+  
+  IsrStats.bh_runs++;
+  
+  if (HCI_TL_SPI_Drain(HCI_TL_DRAIN_BUDGET))
+  {
+    IsrStats.bh_budget_exhausted++;
+    HCI_TL_PEND_BOTTOM_HALF();
+  }
+  
+  HCI_TL_IsrStatsUpdate(&IsrStats.bh_cycles_max, start);
+#endif
+}
+
+/**
+ * @brief  Retry timer of the send path, to be called every 1 ms (SysTick).
+ *         A frame the BlueNRG did not accept is written again, or failed on
+ *         timeout, even when the IRQ line does not toggle.
+ *
+ * @param  None
+ * @retval None
+ */
+void hci_tl_lowlevel_tick(void)
+{
+#if (BLUENRG_STATS == 1)
+  /* SysTick counts down from LOAD: the elapsed cycles are the entry latency */
+  uint32_t latency = SysTick->LOAD - SysTick->VAL;
+  
+  if (latency > IsrStats.tick_latency_max)
+    IsrStats.tick_latency_max = latency;
+#endif
+  
+  if ((SpiTxState == HCI_TL_SPI_TX_PENDING) &&
+      ((HAL_GetTick() - SpiTxLastTry) >= HCI_TL_SPI_TX_RETRY_MS))
+  {
+#if (HCI_TL_DEFERRED_ISR == 1)
+    /* The bottom half may be in the middle of a transaction */
+    if (IsrMode == HCI_TL_SPI_ISR_MODE_DEFERRED)
+    {
+      HCI_TL_PEND_BOTTOM_HALF();
+      return;
+    }
+#endif
+    HCI_TL_SPI_TxTry();
+  }
+}
+
+/**
+ * @brief  Select where the BlueNRG is drained.
+ *         Without HCI_TL_DEFERRED_ISR the EXTI0 interrupt is always used.
+ *
+ * @param  mode : HCI_TL_SPI_ISR_MODE_INLINE or HCI_TL_SPI_ISR_MODE_DEFERRED
+ * @retval None
+ */
+void HCI_TL_SPI_SetIsrMode(uint8_t mode)
+{
+#if (HCI_TL_DEFERRED_ISR == 1)
+  IsrMode = mode;
+#else
+  (void)mode;
+#endif
+}
+
+/**
+ * @brief  Get the interrupt latency statistics.
+ *
+ * @param  stats : Filled with the statistics collected since the last reset
+ * @retval None
+ */
+void HCI_TL_SPI_GetIsrStats(tHciTlIsrStats *stats)
+{
+  *stats = IsrStats;
+}
+
+/**
+ * @brief  Reset the interrupt latency statistics.
+ *
+ * @param  None
+ * @retval None
+ */
+void HCI_TL_SPI_ResetIsrStats(void)
+{
+  memset(&IsrStats, 0, sizeof(IsrStats));
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
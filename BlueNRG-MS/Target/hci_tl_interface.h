@@ -47,6 +47,53 @@
 #define HCI_TL_RST_PORT       GPIOA
 #define HCI_TL_RST_PIN        GPIO_PIN_8
 
+#define HCI_TL_SPI_RX_MODE_POLLED  0U
+#define HCI_TL_SPI_RX_MODE_DMA     1U
+
+#define HCI_TL_SPI_ISR_MODE_INLINE    0U
+#define HCI_TL_SPI_ISR_MODE_DEFERRED  1U
+
+/* Lowest priority: the bottom half never delays another interrupt */
+#define HCI_TL_PENDSV_PRIORITY     15U
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Statistics of the HCI event read path
+ */
+typedef struct
+{
+  uint32_t rx_transfers;      /**< Read transactions that returned a payload */
+  uint32_t rx_dma_transfers;  /**< Read transactions whose payload was read by DMA */
+  uint32_t rx_bytes;          /**< Payload bytes read from the BlueNRG */
+  uint32_t cs_low_cycles;     /**< Accumulated CS low time of the read transactions, in CPU cycles */
+  uint32_t cs_low_cycles_max; /**< Longest CS low time of a read transaction, in CPU cycles */
+} tHciTlSpiRxStats;
+
+/**
+ * @brief Statistics of the HCI command write path
+ */
+typedef struct
+{
+  uint32_t tx_frames;           /**< Frames written to the BlueNRG */
+  uint32_t tx_not_ready;        /**< Attempts refused because the BlueNRG was not ready */
+  uint32_t tx_buffer_too_small; /**< Attempts refused because the BlueNRG write buffer was too small */
+  uint32_t tx_timeout;          /**< Frames dropped after TIMEOUT_DURATION */
+} tHciTlSpiTxStats;
+
+/**
+ * @brief Interrupt latency statistics of the IRQ line handling
+ */
+typedef struct
+{
+  uint32_t isr_runs;            /**< Runs of the EXTI0 handler */
+  uint32_t isr_cycles_max;      /**< Longest run of the EXTI0 handler, in CPU cycles */
+  uint32_t bh_runs;             /**< Runs of the PendSV bottom half */
+  uint32_t bh_cycles_max;       /**< Longest run of the PendSV bottom half, in CPU cycles */
+  uint32_t bh_budget_exhausted; /**< Bottom half runs stopped by HCI_TL_DRAIN_BUDGET */
+  uint32_t tick_latency_max;    /**< Longest SysTick entry latency, in CPU cycles */
+} tHciTlIsrStats;
+
 /* Exported variables --------------------------------------------------------*/
 extern EXTI_HandleTypeDef     hexti0;
 #define H_EXTI_0 hexti0
@@ -57,6 +104,17 @@ int32_t HCI_TL_SPI_DeInit  (void);
 int32_t HCI_TL_SPI_Receive (uint8_t* buffer, uint16_t size);
 int32_t HCI_TL_SPI_Send    (uint8_t* buffer, uint16_t size);
 int32_t HCI_TL_SPI_Reset   (void);
+uint8_t* HCI_TL_SPI_GetTxBuffer(void);
+int32_t HCI_TL_SPI_DataAck (uint8_t* buffer, uint16_t* len);
+
+void HCI_TL_SPI_SetRxMode    (uint8_t mode);
+void HCI_TL_SPI_GetRxStats   (tHciTlSpiRxStats *stats);
+void HCI_TL_SPI_ResetRxStats (void);
+void HCI_TL_SPI_GetTxStats   (tHciTlSpiTxStats *stats);
+void HCI_TL_SPI_ResetTxStats (void);
+void HCI_TL_SPI_SetIsrMode   (uint8_t mode);
+void HCI_TL_SPI_GetIsrStats  (tHciTlIsrStats *stats);
+void HCI_TL_SPI_ResetIsrStats(void);
 
 /**
  * @brief  Register hci_tl_interface IO bus services
@@ -74,6 +132,22 @@ void hci_tl_lowlevel_init(void);
  */
 void hci_tl_lowlevel_isr(void);
 
+/**
+ * @brief HCI Transport Layer Low Level bottom half, called from PendSV_Handler
+ *
+ * @param  None
+ * @retval None
+ */
+void hci_tl_lowlevel_bottom_half(void);
+
+/**
+ * @brief HCI Transport Layer Low Level retry timer, called every 1 ms
+ *
+ * @param  None
+ * @retval None
+ */
+void hci_tl_lowlevel_tick(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,39 @@
+/*
+ * advertising.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INC_ADVERTISING_H_
+#define INC_ADVERTISING_H_
+
+#include <stdint.h>
+
+/* State of the advertising */
+typedef enum {
+	ADV_STATE_OFF,			/* Not wanted: connected or stopped by the application */
+	ADV_STATE_PENDING,		/* Wanted, (re)started by the next adv_process() */
+	ADV_STATE_FAST,			/* Advertising with the fast interval */
+	ADV_STATE_SLOW,			/* Advertising with the slow interval */
+} adv_state_t;
+
+/* Advertising counters */
+typedef struct {
+	uint32_t commands;		/* Commands sent to the controller */
+	uint32_t starts;		/* Advertising started (fast or slow) */
+	uint32_t slow_downs;	/* Fast bursts ended by the slow interval */
+	uint32_t failures;		/* Commands that failed, retried after ADV_RETRY_MS */
+	uint32_t first_start_tick;	/* Tick of the first start, 0 before */
+} adv_stats_t;
+
+void adv_init(const char *local_name, uint8_t len);
+void adv_process(void);
+void adv_start(void);
+void adv_stop(void);
+void adv_on_connected(void);
+void adv_on_disconnected(void);
+void adv_set_local_name(const char *local_name, uint8_t len);
+adv_state_t adv_get_state(void);
+void adv_get_stats(adv_stats_t *stats);
+
+#endif /* INC_ADVERTISING_H_ */
@@ -12,10 +12,8 @@
 
 void MX_BlueNRG_MS_Init(void);
 void MX_BlueNRG_MS_Process(void);
-void event_user_notify(void *);
 void set_connectable_status(void);
 void reset_connectable_status(void);
-tBleStatus establish_connection(void);
 
 
 #endif /* INC_APP_BLE_H_ */
@@ -0,0 +1,36 @@
+/*
+ * ble_bench.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INC_BLE_BENCH_H_
+#define INC_BLE_BENCH_H_
+
+#include "bluenrg_conf.h"
+#include <stdint.h>
+
+#if (BLE_BENCH == 1)
+void ble_bench_run(void);
+void ble_bench_spi_rx(void);
+void ble_bench_spi_tx(void);
+void ble_bench_isr(void);
+void ble_bench_cmd_build(void);
+void ble_bench_cmd_pipeline(void);
+void ble_bench_rx_handoff(void);
+void ble_bench_evt_mask(void);
+void ble_bench_adv_idle(void);
+void ble_bench_fanout(void);
+void ble_bench_notify_stream(void);
+void ble_bench_conn_params(void);
+void ble_bench_long_value(void);
+void ble_bench_shadow(void);
+void ble_bench_gatt_db(void);
+void ble_bench_boot(void);
+void ble_bench_ctrl(void);
+void ble_bench_ifr(void);
+void ble_bench_dfu(void);
+void ble_bench_flow_stats(void);
+#endif
+
+#endif /* INC_BLE_BENCH_H_ */
@@ -0,0 +1,38 @@
+/*
+ * ble_boot.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Start-up of the BlueNRG: wait for the controller to report that it is
+ *  initialized, write the configuration data it does not already hold and
+ *  record the time taken by each step.
+ */
+
+#ifndef INC_BLE_BOOT_H_
+#define INC_BLE_BOOT_H_
+
+#include "bluenrg_conf.h"
+#include "bluenrg_aci_const.h"
+#include <stdint.h>
+
+/* Milestones of the start-up, in ms since the reset of the MCU (HAL_GetTick()), 0 if not reached */
+typedef struct {
+	uint32_t init_ms;			/* ble_boot_init(), before the reset of the controller */
+	uint32_t ready_ms;			/* EVT_BLUE_HAL_INITIALIZED received */
+	uint32_t gatt_ms;			/* GATT database built */
+	uint32_t adv_ms;			/* First advertising started */
+	uint32_t resets;			/* EVT_BLUE_HAL_INITIALIZED received, later ones are restarts of the controller */
+	uint8_t reset_reason;		/* Reason of the last one, RESET_* */
+	uint8_t ready_timeout;		/* Not received within BLE_BOOT_READY_TIMEOUT_MS */
+	uint8_t gatt_status;		/* Status of the GATT database build */
+	uint8_t config_writes;		/* Configuration data written */
+	uint8_t config_skipped;		/* Configuration data already held by the controller */
+} ble_boot_stats_t;
+
+void ble_boot_init(void);
+int ble_boot_wait_ready(void);
+tBleStatus ble_boot_config_data(uint8_t offset, uint8_t len, const uint8_t *value);
+void ble_boot_gatt_built(tBleStatus status);
+void ble_boot_get_stats(ble_boot_stats_t *stats);
+
+#endif /* INC_BLE_BOOT_H_ */
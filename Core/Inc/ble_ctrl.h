@@ -0,0 +1,82 @@
+/*
+ * ble_ctrl.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Controller of the expansion board, probed once at start-up: the ACI
+ *  commands and events that differ between the BlueNRG (X-NUCLEO-IDB04A1)
+ *  and the BlueNRG-MS (X-NUCLEO-IDB05A1) are reached through the function
+ *  table of the controller found, and its capabilities are cached.
+ */
+
+#ifndef INC_BLE_CTRL_H_
+#define INC_BLE_CTRL_H_
+
+#include "bluenrg_conf.h"
+#include "bluenrg_aci_const.h"
+#include "bluenrg_types.h"
+#include <stdint.h>
+
+/* Controller variants */
+#define BLE_CTRL_UNKNOWN      0		/* Not probed, or the probe failed */
+#define BLE_CTRL_IDB04A1      1		/* BlueNRG */
+#define BLE_CTRL_IDB05A1      2		/* BlueNRG-MS */
+
+/* Bits of the LE supported features, see ble_ctrl_has_feature() */
+#define BLE_CTRL_FEAT_ENCRYPTION          0
+#define BLE_CTRL_FEAT_CONN_PARAMS_REQ     1
+#define BLE_CTRL_FEAT_EXT_REJECT_IND      2
+#define BLE_CTRL_FEAT_SLAVE_FEAT_EXCHANGE 3
+#define BLE_CTRL_FEAT_PING                4
+#define BLE_CTRL_FEAT_DATA_LEN_EXT        5
+
+/* Capabilities of the controller, read once by ble_ctrl_probe() */
+typedef struct {
+	uint8_t variant;			/* BLE_CTRL_* */
+	uint8_t hw_version;			/* e.g. 0x31 for cut 3.1 */
+	uint16_t fw_version;		/* 0xJJMN: major, minor, patch */
+	uint8_t hci_version;
+	uint16_t hci_revision;
+	uint8_t lmp_pal_version;
+	uint16_t manufacturer;
+	uint16_t lmp_pal_subversion;
+	uint16_t acl_pkt_len;		/* Length of the ACL data packets of the controller */
+	uint8_t acl_pkts;			/* Number of ACL data packets the controller buffers */
+	uint8_t max_links;			/* Links accepted as a peripheral */
+	uint8_t features[8];		/* LE supported features */
+} ble_ctrl_caps_t;
+
+/* Attribute modified event, whatever the layout of the controller */
+typedef struct {
+	uint16_t conn_handle;
+	uint16_t attr_handle;
+	uint16_t offset;			/* 0 for the IDB04A1 */
+	uint8_t len;
+	uint8_t *data;
+} ble_ctrl_attr_modified_t;
+
+/*
+ * @brief Commands and events that differ between the controllers, with the
+ * 			parameters of the IDB05A1: the extra ones are ignored by the
+ * 			IDB04A1
+ */
+typedef struct {
+	/* role: GAP_*_ROLE_IDB05A1, converted for the IDB04A1 */
+	tBleStatus (*gap_init)(uint8_t role, uint8_t privacy_enabled, uint8_t dev_name_len,
+			uint16_t *service_handle, uint16_t *dev_name_char_handle, uint16_t *appearance_char_handle);
+	tBleStatus (*set_direct_connectable)(uint8_t own_addr_type, uint8_t directed_adv_type, uint8_t initiator_addr_type,
+			const uint8_t *initiator_addr, uint16_t adv_interv_min, uint16_t adv_interv_max);
+	tBleStatus (*set_non_connectable)(uint8_t adv_type, uint8_t own_address_type);
+	tBleStatus (*allow_rebond)(uint16_t conn_handle);
+	/* actual_address: not returned by the IDB04A1 */
+	tBleStatus (*resolve_private_address)(const tBDAddr private_address, tBDAddr actual_address);
+	/* pData: parameters of EVT_BLUE_GATT_ATTRIBUTE_MODIFIED */
+	void (*attr_modified)(void *pData, ble_ctrl_attr_modified_t *evt);
+} ble_ctrl_ops_t;
+
+tBleStatus ble_ctrl_probe(void);
+const ble_ctrl_caps_t *ble_ctrl_caps(void);
+const ble_ctrl_ops_t *ble_ctrl_ops(void);
+uint8_t ble_ctrl_has_feature(uint8_t bit);
+
+#endif /* INC_BLE_CTRL_H_ */
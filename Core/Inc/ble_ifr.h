@@ -0,0 +1,45 @@
+/*
+ * ble_ifr.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Profiles of the IFR configuration of the BlueNRG-MS. The stack mode
+ *  shares the RAM of the controller between the number of links and the
+ *  buffers of each link, the sleep clock accuracy sets the receive window
+ *  of the connection events. A profile is programmed once, at start-up,
+ *  through the updater of the controller.
+ */
+
+#ifndef INC_BLE_IFR_H_
+#define INC_BLE_IFR_H_
+
+#include "bluenrg_conf.h"
+#include "bluenrg_utils.h"
+#include <stdint.h>
+
+/* Profiles, see BLE_IFR_PROFILE */
+#define BLE_IFR_PROFILE_NONE             0	/* Keep the IFR */
+#define BLE_IFR_PROFILE_MAX_THROUGHPUT   1	/* Stack mode 2: 1 link, RAM1 and RAM2 */
+#define BLE_IFR_PROFILE_MAX_LINKS        2	/* Stack mode 3: 8 links */
+#define BLE_IFR_PROFILE_LOW_POWER        3	/* Stack mode 1: 1 link, RAM1 only, sleep clock accuracy of the board */
+#define BLE_IFR_PROFILE_COUNT            4
+
+/* Result of the last ble_ifr_apply() */
+typedef struct {
+	int status;					/* BLE_UTIL_* */
+	uint8_t profile;
+	uint8_t old_mode;			/* Stack mode read from the IFR, 0 if unknown */
+	uint8_t new_mode;			/* Stack mode running after the call */
+	uint8_t written;			/* The IFR differed from the profile and was programmed */
+	uint8_t rolled_back;		/* The new IFR failed its check, the old one was programmed back */
+	uint8_t rollback_failed;
+	uint32_t duration_ms;
+} ble_ifr_state_t;
+
+int ble_ifr_apply(uint8_t profile);
+void ble_ifr_profile_config(uint8_t profile, IFR_config2_TypeDef *config);
+uint8_t ble_ifr_sca_class(uint16_t ppm);
+uint8_t ble_ifr_links(void);
+const ble_ifr_state_t *ble_ifr_state(void);
+
+#endif /* INC_BLE_IFR_H_ */
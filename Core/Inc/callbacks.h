@@ -11,8 +11,9 @@
 #include<stdint.h>
 
 void cb_on_gap_connection_complete(uint8_t *, uint16_t);
-void cb_on_gap_disconnection_complete(void);
-void cb_on_read_request(uint16_t);
+void cb_on_gap_disconnection_complete(uint16_t);
+void cb_on_read_request(uint16_t, uint16_t);
+void cb_on_attribute_modified(uint16_t, uint16_t, uint16_t, uint8_t []);
 uint8_t is_notification_enabled(void);
 uint8_t is_connected(void);
 
@@ -0,0 +1,33 @@
+/*
+ * conn_params.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Connection parameters requested to the master from the traffic of each
+ *  link: short interval and no slave latency during transfers, long
+ *  interval with slave latency when idle.
+ */
+
+#ifndef INC_CONN_PARAMS_H_
+#define INC_CONN_PARAMS_H_
+
+#include <stdint.h>
+
+/* Parameters of a link, conn_policy_t.profile */
+#define CONN_PARAMS_NONE      0		/* Chosen by the master */
+#define CONN_PARAMS_FAST      1		/* L2CAP_INTERV_MIN/MAX, no slave latency */
+#define CONN_PARAMS_IDLE      2		/* CONN_IDLE_INTERV_MIN/MAX, CONN_IDLE_LATENCY */
+
+typedef struct {
+	uint32_t requests;		/* Connection parameter update requests sent */
+	uint32_t accepted;		/* Requests accepted by the master */
+	uint32_t rejected;		/* Requests rejected by the master */
+	uint32_t timeouts;		/* Requests the master did not answer */
+	uint32_t errors;		/* Requests the controller refused to send */
+} conn_params_stats_t;
+
+void conn_params_init(void);
+void conn_params_process(void);
+void conn_params_get_stats(conn_params_stats_t *stats);
+
+#endif /* INC_CONN_PARAMS_H_ */
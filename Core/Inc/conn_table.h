@@ -0,0 +1,82 @@
+/*
+ * conn_table.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Table of the links in progress, BLE_MAX_LINKS at most, looked up by
+ *  connection handle, and of the links subscribed to each characteristic
+ *  (CCCD written by the client).
+ */
+
+#ifndef INC_CONN_TABLE_H_
+#define INC_CONN_TABLE_H_
+
+#include "bluenrg_conf.h"
+#include <stdint.h>
+
+#define CONN_ROLE_MASTER      0x00
+#define CONN_ROLE_SLAVE       0x01
+
+#define CONN_ATT_DEFAULT_MTU  23
+#define CONN_ATT_HDR_SIZE     3		/* Opcode and handle of a notification or indication */
+
+/* Client Characteristic Configuration bits */
+#define CONN_CCCD_NOTIFY      0x0001
+#define CONN_CCCD_INDICATE    0x0002
+
+/* Set of links, one bit per slot of the table */
+typedef uint8_t conn_mask_t;
+
+/* Connection parameter policy of a link, see conn_params.c */
+typedef struct {
+	uint8_t profile;			/* Parameters accepted by the master, CONN_PARAMS_* */
+	uint8_t requested;			/* Parameters of the request in progress, CONN_PARAMS_NONE if none */
+	uint32_t request_tick;		/* Tick of the last request */
+	uint32_t active_tick;		/* Tick of the last traffic seen */
+	uint32_t backoff_ms;		/* Time before the next request, doubled on each rejection */
+	uint32_t notifications;		/* conn_t.notifications at the last evaluation */
+} conn_policy_t;
+
+/* State of a link */
+typedef struct {
+	uint16_t handle;
+	uint8_t in_use;
+	uint8_t role;				/* CONN_ROLE_MASTER or CONN_ROLE_SLAVE */
+	uint8_t peer_addr_type;
+	uint8_t peer_addr[6];
+	uint16_t mtu;				/* ATT MTU, CONN_ATT_DEFAULT_MTU until exchanged */
+	uint16_t interval;			/* Connection interval (N x 1.25 ms) */
+	uint16_t latency;			/* Slave latency (connection events) */
+	uint16_t superv_timeout;	/* Supervision timeout (N x 10 ms) */
+	uint8_t encrypted;			/* Link encrypted, see the Encryption Change event */
+	uint32_t notify;			/* Characteristics the peer enabled notifications of, one bit per id */
+	uint32_t indicate;			/* Characteristics the peer enabled indications of, one bit per id */
+	uint8_t indication_pending;	/* Indication sent, waiting for the confirmation of the peer, holds the indications */
+	uint8_t tx_credits;			/* Values the link may still queue in the controller, see conn_blocked() */
+	uint32_t credit_tick;		/* Tick of the last credit taken or given back */
+	uint32_t notifications;		/* Notifications sent to the link */
+	uint32_t indications;		/* Indications sent to the link */
+	conn_policy_t policy;
+} conn_t;
+
+/*
+ * @brief Function called for each subscriber of a characteristic
+ * @param conn Subscribed link
+ * @param ctx Context given to conn_fanout()
+ */
+typedef void (*conn_visit_t)(conn_t *conn, void *ctx);
+
+void conn_table_init(void);
+conn_t *conn_find(uint16_t handle);
+conn_t *conn_get(uint8_t index);
+uint8_t conn_count(void);
+uint8_t conn_free_slots(void);
+void conn_set_limits(uint8_t links, uint8_t acl_pkts);
+void conn_set_cccd(uint16_t handle, uint8_t char_id, uint16_t cccd);
+conn_mask_t conn_subscribers(uint8_t char_id, uint16_t type);
+uint8_t conn_fanout(uint8_t char_id, uint16_t type, conn_visit_t visit, void *ctx);
+void conn_take_credit(conn_t *conn);
+conn_mask_t conn_blocked(uint8_t char_id);
+uint16_t conn_min_payload(uint8_t char_id, uint16_t type);
+
+#endif /* INC_CONN_TABLE_H_ */
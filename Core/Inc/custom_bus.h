@@ -60,6 +60,12 @@
 #define BUS_SPI1_SCK_GPIO_CLK_ENABLE() __HAL_RCC_GPIOB_CLK_ENABLE()
 #define BUS_SPI1_SCK_GPIO_PORT GPIOB
 #define BUS_SPI1_SCK_GPIO_CLK_DISABLE() __HAL_RCC_GPIOB_CLK_DISABLE()
+#define BUS_SPI1_DMA_RX_INSTANCE DMA2_Stream0
+#define BUS_SPI1_DMA_RX_CHANNEL DMA_CHANNEL_3
+#define BUS_SPI1_DMA_RX_IRQn DMA2_Stream0_IRQn
+#define BUS_SPI1_DMA_TX_INSTANCE DMA2_Stream3
+#define BUS_SPI1_DMA_TX_CHANNEL DMA_CHANNEL_3
+#define BUS_SPI1_DMA_TX_IRQn DMA2_Stream3_IRQn
 #ifndef BUS_SPI1_POLL_TIMEOUT
   #define BUS_SPI1_POLL_TIMEOUT                   0x1000U
 #endif
@@ -91,6 +97,10 @@ typedef struct
   */
 
 extern SPI_HandleTypeDef hspi1;
+#if (USE_BUS_SPI1_DMA == 1U)
+extern DMA_HandleTypeDef hdma_spi1_rx;
+extern DMA_HandleTypeDef hdma_spi1_tx;
+#endif /* USE_BUS_SPI1_DMA */
 
 /**
   * @}
@@ -107,6 +117,9 @@ int32_t BSP_SPI1_DeInit(void);
 int32_t BSP_SPI1_Send(uint8_t *pData, uint16_t Length);
 int32_t BSP_SPI1_Recv(uint8_t *pData, uint16_t Length);
 int32_t BSP_SPI1_SendRecv(uint8_t *pTxData, uint8_t *pRxData, uint16_t Length);
+#if (USE_BUS_SPI1_DMA == 1U)
+int32_t BSP_SPI1_SendRecv_DMA(uint8_t *pTxData, uint8_t *pRxData, uint16_t Length);
+#endif /* USE_BUS_SPI1_DMA */
 #if (USE_HAL_SPI_REGISTER_CALLBACKS == 1U)
 int32_t BSP_SPI1_RegisterDefaultMspCallbacks (void);
 int32_t BSP_SPI1_RegisterMspCallbacks (BSP_SPI_Cb_t *Callbacks);
@@ -39,6 +39,10 @@
    
 /* IRQ priorities */
 #define BSP_BUTTON_USER_IT_PRIORITY         15U
+#define BUS_SPI1_DMA_IT_PRIORITY            0U
+
+/* SPI1 DMA define (DMA2 Stream0/Stream3, Channel 3) */
+#define USE_BUS_SPI1_DMA                    1U
 
 /* I2C1 Frequeny in Hz  */
 #define BUS_I2C1_FREQUENCY                  100000U /* Frequency of I2C1 = 100 KHz*/
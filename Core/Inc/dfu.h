@@ -0,0 +1,113 @@
+/*
+ * dfu.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Update of the application over GATT. The image is written by a client
+ *  to the data characteristic of the DFU service (write without response)
+ *  and stored in the download slot, the upper half of the flash. Once the
+ *  whole image is programmed, it is checked with the CRC unit and its
+ *  HMAC-SHA256 with the key of the product (BLE_DFU_KEY), then marked
+ *  complete; dfu_boot() copies it over the application at the next reset.
+ *
+ *  dfu_boot() is the boot stage: it lives alone in sector 0, which no
+ *  update erases, and starts the application linked after it. The image
+ *  sent is the application only, without the boot stage:
+ *  arm-none-eabi-objcopy -O binary -R .boot app.elf app.bin
+ *
+ *  The characteristics need an authenticated, encrypted link and the
+ *  operations a bonded peer. START is not reassembled from a long write:
+ *  the client exchanges an ATT MTU of DFU_START_MTU or more first. The
+ *  service is only added with BLE_DFU_ENABLE, see bluenrg_conf.h.
+ */
+
+#ifndef INC_DFU_H_
+#define INC_DFU_H_
+
+#include "bluenrg_conf.h"
+#include "notify_queue.h"
+#include "sha256.h"
+#include <stdint.h>
+
+/* Flash of the STM32F401RE: the boot stage in sector 0, the application in sectors 1 to 5,
+ * the download slot in sectors 6 and 7 */
+#define DFU_APP_ADDR          0x08004000UL
+#define DFU_APP_SIZE          0x0003C000UL	/* 240 KB, see STM32F401RETX_FLASH.ld */
+#define DFU_APP_SECTOR        1
+#define DFU_SLOT_ADDR         0x08040000UL
+#define DFU_SLOT_SIZE         0x00040000UL
+#define DFU_SLOT_SECTOR       6				/* First sector of the slot, 128 KB each */
+#define DFU_SECTOR_SIZE       0x00020000UL
+#define DFU_IMAGE_MAX         DFU_APP_SIZE	/* Fits the slot after the header */
+
+#define DFU_MAGIC             0x44465531UL	/* "DFU1" */
+#define DFU_STATE_PENDING     0xFFFFFFFFUL	/* Not installed yet, or copy interrupted: the word stays erased */
+#define DFU_STATE_INSTALLED   0x00000000UL
+
+/* Operations written to the control point: op, then the parameters (little-endian) */
+#define DFU_OP_START          0x01	/* size (4 bytes), CRC (4 bytes), HMAC-SHA256 of the image (32 bytes): erase the slot */
+#define DFU_OP_ABORT          0x02
+#define DFU_OP_APPLY          0x03	/* Reset to install the checked image */
+#define DFU_START_LEN         (9 + SHA256_DIGEST_SIZE)
+#define DFU_START_MTU         (DFU_START_LEN + 3)	/* START in a single write request */
+
+/* Notifications of the control point: event, status, bytes programmed (4 bytes) */
+#define DFU_EVT_READY         0x01	/* Slot erased, the client may stream the image */
+#define DFU_EVT_PROGRESS      0x02	/* Every DFU_ACK_BYTES programmed */
+#define DFU_EVT_DONE          0x03	/* Image programmed and checked, status DFU_OK or the error */
+#define DFU_EVT_LEN           6
+
+/* Status of the notifications */
+#define DFU_OK                0x00
+#define DFU_ERR_STATE         0x01	/* Operation or data not expected in the current state */
+#define DFU_ERR_PARAM         0x02	/* Bad length or size */
+#define DFU_ERR_FLASH         0x03	/* Erase or program failed */
+#define DFU_ERR_CRC           0x04	/* CRC of the slot differs from the one announced */
+#define DFU_ERR_IMAGE         0x05	/* No valid vector table at the start of the image */
+#define DFU_ERR_OVERFLOW      0x06	/* More data than announced */
+#define DFU_ERR_AUTH          0x07	/* Link not encrypted or peer not bonded */
+#define DFU_ERR_MAC           0x08	/* Image not signed with the key of the product */
+#define DFU_ERR_MTU           0x09	/* ATT MTU of the link below DFU_START_MTU */
+
+#define DFU_IDLE              0
+#define DFU_RECEIVING         1
+#define DFU_COMPLETE          2	/* Checked, installed by dfu_boot() at the next reset */
+
+/*
+ * @brief Header at the start of the download slot, the image follows it.
+ * 			Written once the image is checked; the CRC is the one of the
+ * 			CRC unit: CRC-32 (0x04C11DB7, initial value 0xFFFFFFFF, no
+ * 			reflection, no final XOR) of the image read as little-endian
+ * 			32-bit words, the last one padded with 0xFF.
+ */
+typedef struct {
+	uint32_t magic;
+	uint32_t size;
+	uint32_t crc;
+	uint32_t state;		/* DFU_STATE_* */
+} dfu_header_t;
+
+typedef struct {
+	uint32_t start_tick;
+	uint32_t erase_ms;		/* Erase of the slot, blocking */
+	uint32_t program_ms;	/* Time spent programming the buffers */
+	uint32_t mac_ms;		/* Check of the HMAC of the image */
+	uint32_t total_ms;		/* From the start to the check of the image */
+	uint32_t bytes;			/* Bytes received */
+	uint32_t chunks;		/* Writes received */
+	uint32_t buffers;		/* Buffers programmed */
+	uint32_t stalls;		/* Buffers filled while the other was waiting, programmed at once */
+	uint32_t notifications;	/* Notifications queued */
+	uint8_t status;			/* DFU_OK or error of the last update */
+} dfu_stats_t;
+
+void dfu_init(notify_queue_t *q);
+void dfu_control_write(uint16_t conn_handle, uint16_t len, uint8_t data[]);
+void dfu_data_write(uint16_t conn_handle, uint16_t len, uint8_t data[]);
+void dfu_process(void);
+uint8_t dfu_get_state(void);
+void dfu_get_stats(dfu_stats_t *stats);
+uint32_t dfu_crc(const uint32_t *data, uint32_t words);
+__attribute__((noreturn)) void dfu_boot(void);
+
+#endif /* INC_DFU_H_ */
@@ -0,0 +1,55 @@
+/*
+ * event_dispatch.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Dispatch of the events received from the BlueNRG to the handlers
+ *  subscribed by the application modules. The HCI events, the LE meta
+ *  subevents and the vendor (EVT_BLUE_*) events are each looked up in a
+ *  table indexed by their code.
+ */
+
+#ifndef INC_EVENT_DISPATCH_H_
+#define INC_EVENT_DISPATCH_H_
+
+#include <stdint.h>
+
+/* Kind of event a handler subscribes to */
+#define EVT_DISPATCH_HCI       0	/* HCI event code, e.g. EVT_DISCONN_COMPLETE */
+#define EVT_DISPATCH_LE        1	/* LE meta subevent, e.g. EVT_LE_CONN_COMPLETE */
+#define EVT_DISPATCH_VENDOR    2	/* Vendor event code, e.g. EVT_BLUE_GATT_ATTRIBUTE_MODIFIED */
+
+/* Number of codes of each table */
+#define EVT_DISPATCH_HCI_CODES       0x40
+#define EVT_DISPATCH_LE_CODES        0x20
+#define EVT_DISPATCH_VENDOR_GROUPS   4		/* HAL, GAP, L2CAP, GATT: ecode bits 10-11 */
+#define EVT_DISPATCH_VENDOR_CODES    0x20	/* ecode bits 0-4 */
+
+/*
+ * @brief Event handler
+ * @param pData Parameters of the event: after the event header for an HCI
+ * 			event, after the subevent code for an LE meta event, after the
+ * 			ecode for a vendor event
+ */
+typedef void (*evt_handler_t)(void *pData);
+
+/*
+ * @brief Subscription of a handler, owned by the subscriber (usually static)
+ * 			and linked in the table until evt_dispatch_unsubscribe()
+ */
+typedef struct evt_subscription {
+	evt_handler_t handler;
+	uint32_t calls;					/* Events delivered to the handler */
+	uint16_t code;
+	uint8_t kind;
+	struct evt_subscription *next;	/* Next handler of the same code */
+} evt_subscription_t;
+
+int evt_dispatch_subscribe(evt_subscription_t *sub, uint8_t kind, uint16_t code, evt_handler_t handler);
+void evt_dispatch_unsubscribe(evt_subscription_t *sub);
+uint8_t evt_dispatch_is_subscribed(uint8_t kind, uint16_t code);
+uint32_t evt_dispatch_generation(void);
+uint32_t evt_dispatch_unhandled(void);
+void evt_dispatch(void *pData);
+
+#endif /* INC_EVENT_DISPATCH_H_ */
@@ -0,0 +1,31 @@
+/*
+ * event_mask.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Controller event masks derived from the handlers subscribed with
+ *  evt_dispatch_subscribe(): the controller only reports the events the
+ *  application listens to.
+ */
+
+#ifndef INC_EVENT_MASK_H_
+#define INC_EVENT_MASK_H_
+
+#include <stdint.h>
+
+/* Event masks of the controller */
+typedef struct {
+	uint8_t hci[8];		/* hci_set_event_mask() */
+	uint8_t le[8];		/* hci_le_set_event_mask() */
+	uint16_t gap;		/* aci_gap_set_event_mask(), GAP and L2CAP events */
+	uint32_t gatt;		/* aci_gatt_set_event_mask() */
+} evt_masks_t;
+
+void evt_mask_reset(void);
+void evt_mask_update(void);
+void evt_mask_restore_defaults(void);
+void evt_mask_compute(evt_masks_t *masks);
+void evt_mask_get(evt_masks_t *masks);
+uint32_t evt_mask_commands(void);
+
+#endif /* INC_EVENT_MASK_H_ */
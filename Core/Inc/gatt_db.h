@@ -0,0 +1,102 @@
+/*
+ * gatt_db.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  GATT database described by const tables of services, characteristics
+ *  and descriptors, added to the controller by gatt_db_build(). The builder
+ *  pipelines the commands, sizes each service with the exact number of
+ *  attribute records and maps every handle it adds to its characteristic,
+ *  so the writes and the read requests of the clients are dispatched with
+ *  one array lookup.
+ */
+
+#ifndef INC_GATT_DB_H_
+#define INC_GATT_DB_H_
+
+#include "bluenrg_conf.h"
+#include "bluenrg_aci_const.h"
+#include <stdint.h>
+
+/* Number of elements of a table */
+#define GATT_DB_COUNT(table)      (sizeof(table) / sizeof((table)[0]))
+
+/* Kind of attribute behind a handle */
+#define GATT_DB_ATTR_NONE      0	/* Service or characteristic declaration */
+#define GATT_DB_ATTR_VALUE     1	/* Characteristic value */
+#define GATT_DB_ATTR_CCCD      2	/* Client characteristic configuration */
+#define GATT_DB_ATTR_DESC      3	/* Descriptor of the table */
+
+/*
+ * @brief Handler of a value written by a client
+ * @param conn_handle Connection of the client
+ * @param len Length of the data
+ * @param data Data written
+ */
+typedef void (*gatt_write_handler_t)(uint16_t conn_handle, uint16_t len, uint8_t data[]);
+
+/*
+ * @brief Handler of a read request, called before the read is allowed
+ * @param conn_handle Connection of the client
+ */
+typedef void (*gatt_read_handler_t)(uint16_t conn_handle);
+
+typedef struct {
+	const uint8_t *uuid;
+	uint8_t uuid_type;				/* UUID_TYPE_16 or UUID_TYPE_128 */
+	uint8_t value_max;
+	uint8_t value_len;				/* Length of the initial value */
+	const void *value;				/* Initial value */
+	uint8_t permissions;			/* ATTR_PERMISSION_* */
+	uint8_t access;					/* ATTR_ACCESS_* */
+	uint8_t evt_mask;
+	uint16_t *handle;				/* Set by gatt_db_build() */
+} gatt_desc_def_t;
+
+typedef struct {
+	const uint8_t *uuid;
+	uint8_t uuid_type;				/* UUID_TYPE_16 or UUID_TYPE_128 */
+	uint8_t value_max;
+	uint8_t properties;				/* CHAR_PROP_*, broadcast and extended properties not supported */
+	uint8_t permissions;			/* ATTR_PERMISSION_* */
+	uint8_t evt_mask;				/* GATT_NOTIFY_* */
+	uint8_t is_variable;
+	uint8_t char_id;				/* Subscription id of the CCCD, see conn_set_cccd() */
+	gatt_write_handler_t on_write;	/* With GATT_NOTIFY_ATTRIBUTE_WRITE */
+	gatt_read_handler_t on_read;	/* With GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP */
+	const gatt_desc_def_t *descs;
+	uint8_t desc_count;
+	uint16_t *handle;				/* Set by gatt_db_build() */
+} gatt_char_def_t;
+
+typedef struct {
+	const uint8_t *uuid;
+	uint8_t uuid_type;				/* UUID_TYPE_16 or UUID_TYPE_128 */
+	const gatt_char_def_t *chars;
+	uint8_t char_count;
+	uint16_t *handle;				/* Set by gatt_db_build() */
+} gatt_service_def_t;
+
+/*
+ * @brief Callback at the end of gatt_db_build()
+ * @param status BLE_STATUS_SUCCESS or status of the first command that failed
+ */
+typedef void (*gatt_db_done_t)(tBleStatus status);
+
+/*
+ * @brief Entry of the dispatch array, one per handle added by the builder
+ */
+typedef struct {
+	const gatt_char_def_t *chr;		/* Characteristic owning the handle */
+	uint8_t kind;					/* GATT_DB_ATTR_* */
+} gatt_attr_t;
+
+uint8_t gatt_db_attr_records(const gatt_service_def_t *serv);
+int gatt_db_build(const gatt_service_def_t *services, uint8_t count, gatt_db_done_t done);
+uint8_t gatt_db_is_building(void);
+const gatt_attr_t *gatt_db_find(uint16_t handle);
+void gatt_db_attribute_modified(uint16_t conn_handle, uint16_t handle, uint16_t len, uint8_t data[]);
+void gatt_db_read_request(uint16_t conn_handle, uint16_t handle);
+void gatt_db_get_range(uint16_t *first, uint16_t *count);
+
+#endif /* INC_GATT_DB_H_ */
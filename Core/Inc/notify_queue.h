@@ -0,0 +1,94 @@
+/*
+ * notify_queue.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Queues of characteristic values to notify, pushed to the controller as
+ *  fast as its TX pool accepts them, and long values written in chunks.
+ */
+
+#ifndef INC_NOTIFY_QUEUE_H_
+#define INC_NOTIFY_QUEUE_H_
+
+#include "bluenrg_conf.h"
+#include "hci_tl.h"
+#include "bluenrg_aci_const.h"
+#include <stdint.h>
+
+/* Value bytes carried by one ACI_GATT_UPDATE_CHAR_VALUE_EXT command */
+#define NOTIFY_LONG_CHUNK_MAX    (HCI_MAX_CMD_PARAM_SIZE - GATT_UPD_CHAR_VAL_EXT_CP_SIZE)
+
+/*
+ * @brief Values waiting to be notified for one characteristic, owned by the
+ * 			service (usually static) and registered with notify_queue_register()
+ */
+typedef struct notify_queue {
+	uint16_t serv_handle;
+	uint16_t char_handle;
+	uint8_t char_id;						/* Subscriptions of the characteristic, see conn_set_cccd() */
+	uint8_t head;							/* Oldest value */
+	uint8_t count;							/* Values queued */
+	uint8_t len[NOTIFY_QUEUE_DEPTH];
+	uint8_t value[NOTIFY_QUEUE_DEPTH][NOTIFY_VALUE_MAX];
+	struct notify_queue *next;				/* Next registered queue */
+} notify_queue_t;
+
+struct notify_long;
+
+/*
+ * @brief End of a long value update, called from the main loop
+ * @param xfer The update, free to be reused
+ * @param status BLE_STATUS_SUCCESS or the error of the failed chunk
+ */
+typedef void (*notify_long_cb_t)(struct notify_long *xfer, tBleStatus status);
+
+/*
+ * @brief Update of a long characteristic value, owned by the caller until
+ * 			its callback. The value is split into chunks of at most
+ * 			NOTIFY_LONG_CHUNK_MAX bytes; only the last one asks for the
+ * 			notification or indication.
+ */
+typedef struct notify_long {
+	uint16_t serv_handle;
+	uint16_t char_handle;
+	uint8_t update_type;			/* NOTIFICATION and/or INDICATION, 0 to only update the value */
+	uint8_t busy;
+	const uint8_t *value;			/* Must stay valid until the callback */
+	uint16_t len;
+	uint16_t sent;					/* Bytes handed to the command pipeline */
+	uint16_t acked;					/* Bytes completed by the controller */
+	tBleStatus status;
+	notify_long_cb_t done;
+	struct notify_long *next;		/* Next update waiting */
+} notify_long_t;
+
+typedef struct {
+	uint32_t notifications;	/* Values accepted by the controller */
+	uint32_t bytes;			/* Bytes of these values */
+	uint32_t parks;			/* Controller TX pool found full */
+	uint32_t resumes;		/* TX pool available events that resumed the queues */
+	uint32_t held;			/* Queues passed over: a subscriber without credit or with an indication pending */
+	uint32_t rejected;		/* Pushes refused: queue full or value longer than notify_queue_payload() */
+	uint32_t dropped;		/* Values discarded because no link subscribed any more */
+	uint32_t errors;		/* Values refused by the controller for another reason */
+	uint32_t long_values;	/* Long values updated */
+	uint32_t long_bytes;	/* Bytes of these values */
+	uint32_t long_chunks;	/* Chunks completed by the controller */
+	uint32_t long_errors;	/* Long value updates that failed */
+} notify_stats_t;
+
+void notify_init(void);
+void notify_queue_register(notify_queue_t *q, uint16_t serv_handle, uint16_t char_handle, uint8_t char_id);
+int notify_queue_push(notify_queue_t *q, const uint8_t *value, uint8_t len);
+uint8_t notify_queue_space(const notify_queue_t *q);
+uint16_t notify_queue_payload(const notify_queue_t *q);
+int notify_long_update(notify_long_t *xfer, uint16_t serv_handle, uint16_t char_handle, uint8_t update_type,
+		const uint8_t *value, uint16_t len, notify_long_cb_t done);
+void notify_process(void);
+uint32_t notify_queued_bytes(void);
+uint32_t notify_queued_bytes_of(uint32_t chars);
+uint8_t notify_is_parked(void);
+void notify_get_stats(notify_stats_t *stats);
+void notify_reset_stats(void);
+
+#endif /* INC_NOTIFY_QUEUE_H_ */
@@ -9,24 +9,32 @@
 #define INC_SERVICES_H_
 
 #include "bluenrg_aci_const.h"
+#include "notify_queue.h"
+#include "gatt_db.h"
 #include <stdint.h>
 #include <stdbool.h>
 
+/* Characteristic ids of the subscriptions, see conn_set_cccd() */
+#define PB_CHAR_ID      0
+#define RECORD_CHAR_ID      1
+#define DFU_CHAR_ID      2
+
+/* Maximum length of a record: the ACI declares characteristics of 255 bytes at most */
+#define RECORD_VALUE_MAX      255
+
 void read_data(uint8_t *, uint8_t);
 void set_notification_pending(void);
-void set_connection_handle(uint16_t);
 void send_notification(void);
 void update_data(uint16_t);
-void service_read_request(void);
+tBleStatus update_led_status_value(void);
 void change_led_state(uint16_t, uint8_t []);
 
-tBleStatus addNucleoService(void);
-tBleStatus addPbService(void);
+int addServices(gatt_db_done_t);
 
-uint16_t get_connection_handle(void);
+int send_record(const uint8_t *, uint16_t);
+bool is_record_pending(void);
+void get_record_handles(uint16_t *, uint16_t *);
 
-bool is_led_control_attribute(uint16_t);
-bool is_pb_notification_attribute(uint16_t);
-bool is_led_status_read_charac(uint16_t);
+notify_queue_t *get_pb_notify_queue(void);
 
 #endif /* INC_SERVICES_H_ */
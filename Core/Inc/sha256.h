@@ -0,0 +1,31 @@
+/*
+ * sha256.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  SHA-256 (FIPS 180-4) and HMAC-SHA256 (RFC 2104), for the MAC of the
+ *  application images received over GATT. The STM32F401 has no hash unit.
+ */
+
+#ifndef INC_SHA256_H_
+#define INC_SHA256_H_
+
+#include <stdint.h>
+
+#define SHA256_BLOCK_SIZE     64
+#define SHA256_DIGEST_SIZE    32
+
+typedef struct {
+	uint32_t state[8];
+	uint64_t bytes;					/* Bytes hashed */
+	uint8_t block[SHA256_BLOCK_SIZE];
+	uint8_t fill;					/* Bytes in block */
+} sha256_t;
+
+void sha256_init(sha256_t *ctx);
+void sha256_update(sha256_t *ctx, const uint8_t *data, uint32_t len);
+void sha256_final(sha256_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+void hmac_sha256(const uint8_t *key, uint32_t key_len, const uint8_t *data, uint32_t len,
+		uint8_t mac[SHA256_DIGEST_SIZE]);
+
+#endif /* INC_SHA256_H_ */
@@ -0,0 +1,39 @@
+/*
+ * value_shadow.h
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Host copy of characteristic values held by the controller, so that the
+ *  controller answers the reads by itself and a value is only written when
+ *  it changes.
+ */
+
+#ifndef INC_VALUE_SHADOW_H_
+#define INC_VALUE_SHADOW_H_
+
+#include "bluenrg_conf.h"
+#include "bluenrg_aci_const.h"
+#include <stdint.h>
+
+/*
+ * @brief Shadow of a characteristic value, owned by the service (usually static)
+ */
+typedef struct {
+	uint16_t serv_handle;
+	uint16_t char_handle;
+	uint8_t len;
+	uint8_t valid;					/* The controller holds value */
+	uint8_t value[VALUE_SHADOW_MAX];
+} value_shadow_t;
+
+typedef struct {
+	uint32_t writes;		/* Values written to the controller */
+	uint32_t skipped;		/* Updates with the value already held by the controller */
+	uint32_t errors;		/* Writes refused by the controller */
+} value_shadow_stats_t;
+
+void value_shadow_init(value_shadow_t *shadow, uint16_t serv_handle, uint16_t char_handle);
+tBleStatus value_shadow_set(value_shadow_t *shadow, const uint8_t *value, uint8_t len);
+void value_shadow_get_stats(value_shadow_stats_t *stats);
+
+#endif /* INC_VALUE_SHADOW_H_ */
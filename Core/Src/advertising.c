@@ -0,0 +1,203 @@
+/*
+ * advertising.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Advertising state machine: the advertising is started once and only
+ *  started again after a connection, while links are free, after a
+ *  disconnection or after a change of its parameters.
+ *  Each start is a burst with the fast interval (ADV_FAST_INTERV_MIN/MAX)
+ *  for ADV_FAST_DURATION_MS, then the advertising backs off to the slow
+ *  interval (ADV_INTERV_MIN/MAX) until a client connects.
+ */
+
+#include "advertising.h"
+#include "main.h"
+#include "hci_const.h"
+#include "hci_le.h"
+#include "bluenrg_gap.h"
+#include "bluenrg_gap_aci.h"
+#include "bluenrg_conf.h"
+
+#include <string.h>
+
+#define ADV_LOCAL_NAME_MAX    24
+
+static adv_state_t state = ADV_STATE_OFF;
+static adv_stats_t stats;
+static uint32_t state_tick;				/* Tick of the last start or failure */
+static uint8_t failed;					/* Last start failed, retry after ADV_RETRY_MS */
+static uint8_t local_name[ADV_LOCAL_NAME_MAX + 1];
+static uint8_t local_name_len;
+
+/*
+ * @brief Send the commands that make the device discoverable
+ * @param interv_min Minimum advertising interval (N x 0.625 ms)
+ * @param interv_max Maximum advertising interval (N x 0.625 ms)
+ * @retvalue Status of the last command sent
+ */
+static tBleStatus start(uint16_t interv_min, uint16_t interv_max){
+	tBleStatus ret;
+
+	// 设置扫描响应数据为空（0 字节）
+	stats.commands++;
+	hci_le_set_scan_resp_data(0, NULL);
+
+	// 设置设备为可发现模式（Discoverable Mode），并通过广播发送设备名称
+	stats.commands++;
+	ret = aci_gap_set_discoverable(
+		ADV_DATA_TYPE,        // 广播类型：间接广播
+		interv_min,           // 最小广告间隔（单位：625微秒）
+		interv_max,           // 最大广告间隔（单位：625微秒）
+		PUBLIC_ADDR,          // 使用公共地址
+		NO_WHITE_LIST_USE,    // 不使用白名单
+		local_name_len,       // 广播数据的长度
+		(const char *)local_name, // 广播数据（设备名称）
+		0,                    // 无服务 UUID 列表
+		NULL,                 // 服务 UUID 列表为空
+		0,                    // 从机连接间隔最小值：不指定
+		0                     // 从机连接间隔最大值：不指定
+	);
+	return ret;
+}
+
+/*
+ * @brief Stop the advertising in progress
+ */
+static void stop(void){
+	stats.commands++;
+	aci_gap_set_non_discoverable();
+}
+
+/*
+ * @brief Initialize the advertising, started by the next adv_process()
+ * @param name Complete local name advertised
+ * @param len Length of the name
+ */
+void adv_init(const char *name, uint8_t len){
+	memset(&stats, 0, sizeof(stats));
+	adv_set_local_name(name, len);
+}
+
+/*
+ * @brief Advance the state machine, called from the main loop. No command
+ * 			is sent while the state does not change.
+ */
+void adv_process(void){
+	uint32_t now = HAL_GetTick();
+
+	switch(state){
+		case ADV_STATE_PENDING:
+			if(failed && (now - state_tick) < ADV_RETRY_MS)
+				break;
+			if(start(ADV_FAST_INTERV_MIN, ADV_FAST_INTERV_MAX) == BLE_STATUS_SUCCESS){
+				state = ADV_STATE_FAST;
+				stats.starts++;
+				failed = FALSE;
+				if(stats.first_start_tick == 0)
+					stats.first_start_tick = now;
+			}
+			else{
+				stats.failures++;
+				failed = TRUE;
+			}
+			state_tick = now;
+			break;
+		case ADV_STATE_FAST:
+			if((now - state_tick) < ADV_FAST_DURATION_MS)
+				break;
+			stop();
+			if(start(ADV_INTERV_MIN, ADV_INTERV_MAX) == BLE_STATUS_SUCCESS){
+				state = ADV_STATE_SLOW;
+				stats.starts++;
+				stats.slow_downs++;
+			}
+			else{
+				/* Fast burst again after ADV_RETRY_MS */
+				state = ADV_STATE_PENDING;
+				stats.failures++;
+				failed = TRUE;
+			}
+			state_tick = now;
+			break;
+		case ADV_STATE_OFF:
+		case ADV_STATE_SLOW:
+			break;
+	}
+}
+
+/*
+ * @brief Start advertising with a fast burst, if not already advertising
+ */
+void adv_start(void){
+	if(state == ADV_STATE_OFF){
+		state = ADV_STATE_PENDING;
+		failed = FALSE;
+	}
+}
+
+/*
+ * @brief Stop advertising until adv_start()
+ */
+void adv_stop(void){
+	if(state == ADV_STATE_FAST || state == ADV_STATE_SLOW)
+		stop();
+	state = ADV_STATE_OFF;
+}
+
+/*
+ * @brief A client connected: the controller stopped advertising by itself
+ */
+void adv_on_connected(void){
+	state = ADV_STATE_OFF;
+}
+
+/*
+ * @brief A client disconnected: advertise again, with a fast burst so
+ * 			that it reconnects quickly. A slow advertising in progress
+ * 			(other links still connected) is restarted fast.
+ */
+void adv_on_disconnected(void){
+	if(state == ADV_STATE_SLOW){
+		stop();
+		state = ADV_STATE_PENDING;
+		failed = FALSE;
+	}
+	else
+		adv_start();
+}
+
+/*
+ * @brief Change the advertised local name. An advertising in progress is
+ * 			started again with a fast burst to publish it.
+ * @param name Complete local name
+ * @param len Length of the name, truncated to ADV_LOCAL_NAME_MAX
+ */
+void adv_set_local_name(const char *name, uint8_t len){
+	if(len > ADV_LOCAL_NAME_MAX)
+		len = ADV_LOCAL_NAME_MAX;
+
+	local_name[0] = AD_TYPE_COMPLETE_LOCAL_NAME;
+	memcpy(local_name + 1, name, len);
+	local_name_len = len + 1;
+
+	if(state == ADV_STATE_FAST || state == ADV_STATE_SLOW){
+		stop();
+		state = ADV_STATE_PENDING;
+		failed = FALSE;
+	}
+}
+
+/*
+ * @brief Current state of the advertising
+ */
+adv_state_t adv_get_state(void){
+	return state;
+}
+
+/*
+ * @brief Get the advertising counters
+ */
+void adv_get_stats(adv_stats_t *s){
+	*s = stats;
+}
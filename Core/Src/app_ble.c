@@ -6,20 +6,31 @@
 #include "hci_le.h"
 #include "bluenrg_gatt_aci.h"
 #include "bluenrg_gap_aci.h"
+#include "sm.h"
 #include "bluenrg_utils.h"
 #include "services.h"
 #include "callbacks.h"
+#include "event_dispatch.h"
+#include "event_mask.h"
+#include "advertising.h"
+#include "conn_table.h"
+#include "notify_queue.h"
+#include "conn_params.h"
+#include "ble_boot.h"
+#include "ble_ctrl.h"
+#include "ble_ifr.h"
+#include "dfu.h"
 
 #include <stdint.h>
 #include <stdbool.h>
 
 #define BDADDR_SIZE 6
-
-static bool CONNECTABLE = TRUE;
+#define ADV_LOCAL_NAME "Dinesh-Lab" // 广播的设备名称
 
 void MX_BlueNRG_MS_Init(void);
 void MX_BlueNRG_MS_Process(void);
-void event_user_notify(void *);
+static void subscribe_events(void);
+static void on_services_added(tBleStatus status);
 
 /* @brief BlueNRG-MS initialization
  * @retvalue None
@@ -33,32 +44,62 @@ void MX_BlueNRG_MS_Init(void){
 	uint16_t service_handle, dev_name_char_handle, appearance_char_handle; // 服务句柄、设备名称句柄和外观句柄
 
 	/* 初始化 HCI（Host Controller Interface）
-	 * 注册 BLE 回调函数 --- event_user_notify
+	 * 注册 BLE 回调函数 --- evt_dispatch，事件按代码分发给 subscribe_events() 订阅的处理函数
 	 * 注册按键回调函数  --- hci_tl_lowlevel_isr
 	 */
-	hci_init(&event_user_notify, NULL);
-	hci_reset();    // 复位 control 芯片
-	HAL_Delay(100); // 延迟 100 毫秒，确保 control 复位完成
+	conn_table_init(); // 连接表先于应用订阅连接事件，应用回调运行时连接表已更新
+	notify_init();     // 通知队列在 TX 缓冲满时挂起，收到 TX_POOL_AVAILABLE 后恢复
+	conn_params_init(); // 按链路流量请求连接参数
+	ble_boot_init();    // 记录启动各阶段的时间，订阅 EVT_BLUE_HAL_INITIALIZED
+	subscribe_events();
+	hci_init(&evt_dispatch, NULL); // 通过复位引脚复位 control 芯片，无需再发送 hci_reset()
+	ble_boot_wait_ready(); // 等待 control 上报初始化完成，而不是固定延迟 100 毫秒
+#if BLE_IFR_PROFILE != BLE_IFR_PROFILE_NONE
+	ble_ifr_apply(BLE_IFR_PROFILE); // IFR 与配置的档位不同时重新编程（control 会重启），失败时恢复原 IFR
+#endif
+	evt_mask_reset(); // 复位后 control 恢复默认事件掩码（全部事件）
+	ble_ctrl_probe(); // 识别 control 型号（IDB04A1/IDB05A1），绑定其命令表并缓存其能力
 
 	// 将服务器地址复制到本地地址缓冲区
 	BLUENRG_memcpy(bdaddr, server_bdaddr, sizeof(server_bdaddr));
 
-	// 配置蓝牙设备的公共地址
-	aci_hal_write_config_data(CONFIG_DATA_PUBADDR_OFFSET,
+	// 配置蓝牙设备的公共地址，control 已保存相同地址时不再写入
+	ble_boot_config_data(CONFIG_DATA_PUBADDR_OFFSET,
 			CONFIG_DATA_PUBADDR_LEN,
 			bdaddr);
 
 	// 初始化 GATT（Generic Attribute Profile）
 	aci_gatt_init();
 	// 初始化 GAP（Generic Access Profile），设置设备角色为外设，并初始化服务和特征句柄
-	aci_gap_init_IDB05A1(GAP_PERIPHERAL_ROLE_IDB05A1, 0, strlen(name), &service_handle, &dev_name_char_handle, &appearance_char_handle);
+	ble_ctrl_ops()->gap_init(GAP_PERIPHERAL_ROLE_IDB05A1, 0, strlen(name), &service_handle, &dev_name_char_handle, &appearance_char_handle);
 	// 更新设备名称特征值
 	aci_gatt_update_char_value(service_handle, dev_name_char_handle, 0,
 			strlen(name), (uint8_t *)name);
+#if BLE_DFU_ENABLE
+	// 升级服务要求经过认证（MITM，固定配对码）并绑定的加密链路
+	aci_gap_set_io_capability(IO_CAP_DISPLAY_ONLY);
+	aci_gap_set_auth_requirement(MITM_PROTECTION_REQUIRED, OOB_AUTH_DATA_ABSENT, NULL, 7, 16,
+			USE_FIXED_PIN_FOR_PAIRING, BLE_DFU_PASSKEY, BONDING);
+#endif
 
 	// 初始化自定义服务
-	addNucleoService(); // 添加 Nucleo 服务
-	addPbService(); // 添加按键服务
+	// 按服务表添加 Nucleo 服务和按键服务，命令流水线发送，完成后由 on_services_added() 开始广播
+	addServices(on_services_added);
+
+	// 只让 control 上报已订阅的事件
+	evt_mask_update();
+
+	// 广播设备名称，由 MX_BlueNRG_MS_Process() 启动
+	adv_init(ADV_LOCAL_NAME, strlen(ADV_LOCAL_NAME));
+}
+
+/*
+ * @brief 服务添加完成：记录启动时间，开始广播
+ * @param status 添加服务的状态
+ */
+static void on_services_added(tBleStatus status){
+	ble_boot_gatt_built(status);
+	adv_start();
 }
 
 /*
@@ -67,11 +108,16 @@ void MX_BlueNRG_MS_Init(void){
  */
 void MX_BlueNRG_MS_Process(void){
 
-    // 如果设备处于可连接状态，则尝试建立连接
-	if(CONNECTABLE == TRUE)
-		establish_connection(); // 调用函数以通过广播建立连接
+	// 广播状态机：只在启动、断连或参数变化时发送命令
+	adv_process();
 
-	send_notification(); // 发送通知数据（如果有需要）
+	send_notification(); // 按键通知入队（如果有需要）
+	notify_process();    // 发送队列中的通知，直到 control 的 TX 缓冲已满
+	conn_params_process(); // 传输时请求短连接间隔，空闲时请求长间隔和从机延迟
+#if BLE_DFU_ENABLE
+	dfu_process();       // 将已收满的升级数据缓冲区写入 flash 下载区
+#endif
+	evt_mask_update();   // 订阅变化后重新设置事件掩码
 	hci_user_evt_proc(); // 处理 HCI 用户事件
 }
 
@@ -79,109 +125,74 @@ void MX_BlueNRG_MS_Process(void){
  * @brief set connectable status on disconnection complete
  */
 void set_connectable_status(void){
-	CONNECTABLE = TRUE;
+	adv_on_disconnected();
 }
 
 /*
- * @brief reset connectable status on connection complete
+ * @brief reset connectable status on connection complete, keep
+ * 			advertising while the connection table has free slots
  */
 void reset_connectable_status(void){
-	CONNECTABLE = FALSE;
+	adv_on_connected();
+	if(conn_free_slots() > 0)
+		adv_start();
 }
 
 /*
- * 通过可发现模式的间接广告建立联系
+ * @brief 断连事件：调用 GAP 层断连完成的回调函数
  */
-tBleStatus establish_connection(void){
-	tBleStatus ret;
-	// 定义本地设备名称，包含完整的设备名称字段（AD_TYPE_COMPLETE_LOCAL_NAME）
-	const char local_name[] = {AD_TYPE_COMPLETE_LOCAL_NAME, 'D', 'i', 'n', 'e', 's', 'h', '-', 'L', 'a', 'b'};
-
-    // 设置扫描响应数据为空（0 字节）
-	hci_le_set_scan_resp_data(0, NULL);
-
-	// 设置设备为可发现模式（Discoverable Mode），并通过广播发送设备名称
-    ret = aci_gap_set_discoverable(
-		ADV_IND,              // 广播类型：间接广播
-		0,                    // 最小广告间隔（单位：625微秒）
-		0,                    // 最大广告间隔（单位：625微秒）
-		PUBLIC_ADDR,          // 使用公共地址
-		NO_WHITE_LIST_USE,    // 不使用白名单
-		sizeof(local_name),   // 广播数据的长度
-		local_name,           // 广播数据（设备名称）
-		0,                    // 无服务 UUID 列表
-		NULL,                 // 服务 UUID 列表为空
-		0,                    // 无服务 UUID 列表长度
-		0                     // 无服务 UUID 列表长度
-    );
-	return ret;
+static void on_disconnection_complete(void *pData){
+	evt_disconn_complete *disconn_evt = pData;
+
+	if(disconn_evt->status == 0)
+		cb_on_gap_disconnection_complete(disconn_evt->handle);
+}
+
+/*
+ * @brief LE 连接完成事件：调用 GAP 层连接完成的回调函数，传入对端地址和连接句柄
+ */
+static void on_le_connection_complete(void *pData){
+	evt_le_connection_complete *hci_con_comp_evt = pData;
+
+	if(hci_con_comp_evt->status == 0)
+		cb_on_gap_connection_complete(hci_con_comp_evt->peer_bdaddr, hci_con_comp_evt->handle);
+}
+
+/*
+ * @brief GATT 读许可请求事件：调用读请求的回调函数，传入属性句柄
+ */
+static void on_gatt_read_permit_req(void *pData){
+	evt_gatt_read_permit_req *read_pmt_req_evt = pData;
+
+	cb_on_read_request(read_pmt_req_evt->conn_handle, read_pmt_req_evt->attr_handle);
 }
 
 /*
- * @brief 这是一个状态机，根据到达 HCI（Host Controller Interface）的数据，将数据转发到适当的回调函数。
- * @param *pData 指向到达 HCI 的数据缓冲区的指针。
+ * @brief GATT 属性修改事件：调用属性修改的回调函数，传入属性句柄、数据长度和修改后的数据，
+ * 			这里最终会改变开发板上绿灯的亮灭
  */
-void event_user_notify(void *pData)
-{
-	// 将传入的数据指针转换为 HCI UART 数据包结构
-	hci_uart_pckt *hci_pkt = pData;
-	// 提取 HCI 事件数据包
-	hci_event_pckt *hci_evt_pkt = (void *)hci_pkt->data;
-
-	// 如果数据包类型不是 HCI 事件包，则直接返回
-	if(hci_pkt->type != HCI_EVENT_PKT)
+static void on_gatt_attribute_modified(void *pData){
+	ble_ctrl_attr_modified_t attr_modified_evt;
+
+	// 两种 control 的事件格式不同，由探测时绑定的函数解析
+	ble_ctrl_ops()->attr_modified(pData, &attr_modified_evt);
+	// 长写（Prepared Write）的后续分片不重组：服务的取值都在一次写内，DFU 的 START 要求足够的 MTU
+	if(attr_modified_evt.offset != 0)
 		return;
+	cb_on_attribute_modified(attr_modified_evt.conn_handle,
+			attr_modified_evt.attr_handle,
+			attr_modified_evt.len,
+			attr_modified_evt.data);
+}
+
+/*
+ * @brief 订阅应用处理的事件，其余事件由 evt_dispatch() 计入未处理计数
+ */
+static void subscribe_events(void){
+	static evt_subscription_t disconn_sub, conn_sub, read_req_sub, attr_mod_sub;
 
-	// 根据事件类型进行处理
-	switch(hci_evt_pkt->evt){
-		case EVT_DISCONN_COMPLETE: // 断连事件
-		{
-			// 调用 GAP 层断连完成的回调函数
-			cb_on_gap_disconnection_complete();
-		}
-		break;
-		case  EVT_LE_META_EVENT:
-		{
-			evt_le_meta_event *hci_meta_evt = (void *)hci_evt_pkt->data;
-			switch(hci_meta_evt->subevent) {
-				case EVT_LE_CONN_COMPLETE: // LE 连接完成事件
-				{
-					// 提取 LE 连接完成事件数据
-					evt_le_connection_complete *hci_con_comp_evt = (void *)hci_meta_evt->data;
-					// 调用 GAP 层连接完成的回调函数，传入对端地址和连接句柄
-					cb_on_gap_connection_complete(hci_con_comp_evt->peer_bdaddr, hci_con_comp_evt->handle);
-				}
-				break;
-			}
-		}
-		break;
-		case EVT_VENDOR: // 厂商自定义事件
-		{
-			// 提取厂商事件数据
-			evt_blue_aci *vendor_evt = (void *)hci_evt_pkt->data;
-			// 根据厂商事件代码进行处理
-			switch(vendor_evt->ecode){
-				case EVT_BLUE_GATT_READ_PERMIT_REQ: // GATT 读许可请求事件
-				{
-					// 提取读许可请求事件数据
-					evt_gatt_read_permit_req *read_pmt_req_evt = (void *)vendor_evt->data;
-					// 调用读请求的回调函数，传入属性句柄
-					cb_on_read_request(read_pmt_req_evt->attr_handle);
-				}
-				break;
-				case EVT_BLUE_GATT_ATTRIBUTE_MODIFIED: // GATT 属性修改事件
-				{
-					// 提取属性修改事件数据
-					evt_gatt_attr_modified_IDB05A1 *attr_modified_evt = (void *)vendor_evt->data;
-					// 调用属性修改的回调函数，传入属性句柄、数据长度和修改后的数据，这里最终会改变开发板上绿灯的亮灭
-					cb_on_attribute_modified(attr_modified_evt->attr_handle,
-							attr_modified_evt->data_length,
-							attr_modified_evt->att_data);
-
-				}
-				break;
-			}
-		}
-		break;
-	}
+	evt_dispatch_subscribe(&disconn_sub, EVT_DISPATCH_HCI, EVT_DISCONN_COMPLETE, on_disconnection_complete);
+	evt_dispatch_subscribe(&conn_sub, EVT_DISPATCH_LE, EVT_LE_CONN_COMPLETE, on_le_connection_complete);
+	evt_dispatch_subscribe(&read_req_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_GATT_READ_PERMIT_REQ, on_gatt_read_permit_req);
+	evt_dispatch_subscribe(&attr_mod_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_GATT_ATTRIBUTE_MODIFIED, on_gatt_attribute_modified);
 }
@@ -0,0 +1,798 @@
+/*
+ * ble_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  On-target benchmarks of the BLE stack. They are built with BLE_BENCH
+ *  (bluenrg_conf.h), run once after MX_BlueNRG_MS_Init() and print their
+ *  results on USART2.
+ */
+
+#include "ble_bench.h"
+
+#if (BLE_BENCH == 1)
+
+#include "main.h"
+#include "hci.h"
+#include "hci_le.h"
+#include "hci_tl.h"
+#include "ble_list.h"
+#include "hci_const.h"
+#include "bluenrg_aci_const.h"
+#include "bluenrg_gatt_aci.h"
+#include "bluenrg_gap.h"
+#include "event_mask.h"
+#include "services.h"
+#include "app_ble.h"
+#include "advertising.h"
+#include "conn_table.h"
+#include "event_dispatch.h"
+#include "notify_queue.h"
+#include "callbacks.h"
+#include "conn_params.h"
+#include "value_shadow.h"
+#include "gatt_db.h"
+#include "ble_boot.h"
+#include "ble_ctrl.h"
+#include "ble_ifr.h"
+#include "dfu.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SPI_RX_ROUNDS    200
+#define BENCH_CMD_ROUNDS       100
+#define BENCH_PIPE_ROUNDS      200
+#define BENCH_STACK_WORDS      256
+#define BENCH_LIST_NODES       5
+#define BENCH_MASK_MS          2000
+#define BENCH_ADV_MS           5000
+#define BENCH_FANOUT_HANDLE    0x0801
+#define BENCH_STREAM_WAIT_MS   30000
+#define BENCH_STREAM_MS        5000
+#define BENCH_RECORD_LEN       250
+#define BENCH_RECORD_ROUNDS    20
+#define BENCH_SHADOW_ROUNDS    100
+#define BENCH_PARAMS_PHASE_MS  (CONN_PARAMS_IDLE_MS + CONN_PARAMS_MIN_GAP_MS + 3000)
+#define BENCH_STACK_PAINT      0xC5C5C5C5U
+
+/*
+ * @brief Convert CPU cycles to microseconds
+ */
+static uint32_t cycles_to_us(uint32_t cycles){
+	return cycles / (SystemCoreClock / 1000000U);
+}
+
+/*
+ * @brief Read the supported states of the controller BENCH_SPI_RX_ROUNDS times
+ * 			and report the event read path statistics
+ * @param mode HCI_TL_SPI_RX_MODE_POLLED or HCI_TL_SPI_RX_MODE_DMA
+ * @param name Name of the path printed in the report
+ */
+static void bench_spi_rx_mode(uint8_t mode, const char *name){
+	tHciTlSpiRxStats stats;
+	uint8_t states[8];
+	uint32_t tickstart, elapsed, bus_rate = 0;
+	int i;
+
+	HCI_TL_SPI_SetRxMode(mode);
+	HCI_TL_SPI_ResetRxStats();
+
+	tickstart = HAL_GetTick();
+	for(i = 0; i < BENCH_SPI_RX_ROUNDS; i++)
+		hci_le_read_supported_states(states);
+	elapsed = HAL_GetTick() - tickstart;
+
+	HCI_TL_SPI_GetRxStats(&stats);
+	if(stats.cs_low_cycles > 0)
+		bus_rate = (uint32_t)(((uint64_t)stats.rx_bytes * SystemCoreClock) / stats.cs_low_cycles);
+
+	printf("[bench] spi rx %s: %lu reads (%lu dma), %lu bytes in %lu ms, %lu B/s while CS low, "
+			"CS low avg %lu us max %lu us\r\n",
+			name, stats.rx_transfers, stats.rx_dma_transfers, stats.rx_bytes, elapsed, bus_rate,
+			stats.rx_transfers ? cycles_to_us(stats.cs_low_cycles / stats.rx_transfers) : 0,
+			cycles_to_us(stats.cs_low_cycles_max));
+}
+
+/*
+ * @brief Compare the polled and the DMA event read paths
+ */
+void ble_bench_spi_rx(void){
+	bench_spi_rx_mode(HCI_TL_SPI_RX_MODE_POLLED, "polled");
+	bench_spi_rx_mode(HCI_TL_SPI_RX_MODE_DMA, "dma");
+}
+
+/*
+ * @brief Send BENCH_SPI_RX_ROUNDS commands and report how often the
+ * 			controller pushed back on the command write path
+ */
+void ble_bench_spi_tx(void){
+	tHciTlSpiTxStats stats;
+	uint8_t states[8];
+	uint32_t tickstart, elapsed;
+	int i;
+
+	HCI_TL_SPI_ResetTxStats();
+
+	tickstart = HAL_GetTick();
+	for(i = 0; i < BENCH_SPI_RX_ROUNDS; i++)
+		hci_le_read_supported_states(states);
+	elapsed = HAL_GetTick() - tickstart;
+
+	HCI_TL_SPI_GetTxStats(&stats);
+	printf("[bench] spi tx: %lu frames in %lu ms, %lu not ready, %lu buffer too small, %lu timeouts\r\n",
+			stats.tx_frames, elapsed, stats.tx_not_ready, stats.tx_buffer_too_small, stats.tx_timeout);
+}
+
+/*
+ * @brief Read the supported states of the controller BENCH_SPI_RX_ROUNDS times
+ * 			and report the interrupt latencies of the IRQ line handling
+ * @param mode HCI_TL_SPI_ISR_MODE_INLINE or HCI_TL_SPI_ISR_MODE_DEFERRED
+ * @param name Name of the mode printed in the report
+ */
+static void bench_isr_mode(uint8_t mode, const char *name){
+	tHciTlIsrStats stats;
+	uint8_t states[8];
+	int i;
+
+	HCI_TL_SPI_SetIsrMode(mode);
+	HCI_TL_SPI_ResetIsrStats();
+
+	for(i = 0; i < BENCH_SPI_RX_ROUNDS; i++)
+		hci_le_read_supported_states(states);
+
+	HCI_TL_SPI_GetIsrStats(&stats);
+	printf("[bench] isr %s: EXTI0 %lu runs max %lu us, bottom half %lu runs max %lu us (%lu over budget), "
+			"SysTick latency max %lu us\r\n",
+			name, stats.isr_runs, cycles_to_us(stats.isr_cycles_max), stats.bh_runs,
+			cycles_to_us(stats.bh_cycles_max), stats.bh_budget_exhausted,
+			cycles_to_us(stats.tick_latency_max));
+}
+
+/*
+ * @brief Compare the worst case interrupt latencies with the BlueNRG drained
+ * 			in the EXTI0 interrupt and in the PendSV bottom half
+ */
+void ble_bench_isr(void){
+	bench_isr_mode(HCI_TL_SPI_ISR_MODE_INLINE, "inline");
+	bench_isr_mode(HCI_TL_SPI_ISR_MODE_DEFERRED, "deferred");
+}
+
+/*
+ * @brief aci_gatt_update_char_value() as it was before the command builder:
+ * 			parameters serialized in a stack buffer and copied by hci_send_req()
+ */
+static tBleStatus legacy_update_char_value(uint16_t servHandle, uint16_t charHandle,
+		uint8_t charValueLen, const void *charValue){
+	struct hci_request rq;
+	uint8_t status;
+	uint8_t buffer[HCI_MAX_PAYLOAD_SIZE];
+	uint8_t indx = 0;
+
+	BLUENRG_memcpy(buffer + indx, &servHandle, 2);
+	indx += 2;
+	BLUENRG_memcpy(buffer + indx, &charHandle, 2);
+	indx += 2;
+	buffer[indx++] = 0;
+	buffer[indx++] = charValueLen;
+	BLUENRG_memcpy(buffer + indx, charValue, charValueLen);
+	indx += charValueLen;
+
+	BLUENRG_memset(&rq, 0, sizeof(rq));
+	rq.ogf = OGF_VENDOR_CMD;
+	rq.ocf = OCF_GATT_UPD_CHAR_VAL;
+	rq.cparam = buffer;
+	rq.clen = indx;
+	rq.rparam = &status;
+	rq.rlen = 1;
+
+	if(hci_send_req(&rq, FALSE) < 0)
+		return BLE_STATUS_TIMEOUT;
+	return status;
+}
+
+/*
+ * @brief Send BENCH_CMD_ROUNDS updates of a 20 bytes value and report the peak
+ * 			stack usage (painted stack below the caller) and the cycles per command.
+ * 			The handles are not allocated: the controller answers with an error
+ * 			status, which is enough to measure the host side of the command.
+ * @param legacy 1 to use the stack buffer path, 0 for the in place builder
+ * @param name Name of the path printed in the report
+ */
+static void bench_cmd_path(uint8_t legacy, const char *name){
+	uint8_t value[20] = {0};
+	volatile uint32_t *top = (uint32_t *)__get_MSP() - 16;
+	volatile uint32_t *p;
+	uint32_t start, cycles = 0, used = 0;
+	int i;
+
+	for(i = 0; i < BENCH_CMD_ROUNDS; i++){
+		for(p = top - BENCH_STACK_WORDS; p < top; p++)
+			*p = BENCH_STACK_PAINT;
+
+		start = BLUENRG_CYCLES();
+		if(legacy)
+			legacy_update_char_value(0x0001, 0x0002, sizeof(value), value);
+		else
+			aci_gatt_update_char_value(0x0001, 0x0002, 0, sizeof(value), value);
+		cycles += BLUENRG_CYCLES() - start;
+
+		for(p = top - BENCH_STACK_WORDS; (p < top) && (*p == BENCH_STACK_PAINT); p++);
+		if((uint32_t)(top - p) * 4U > used)
+			used = (uint32_t)(top - p) * 4U;
+	}
+
+	printf("[bench] cmd %s: peak stack %lu bytes, %lu cycles (%lu us) per command\r\n",
+			name, used, cycles / BENCH_CMD_ROUNDS, cycles_to_us(cycles / BENCH_CMD_ROUNDS));
+}
+
+/*
+ * @brief Compare the stack buffer and the in place command paths
+ */
+void ble_bench_cmd_build(void){
+	bench_cmd_path(1, "stack buffer");
+	bench_cmd_path(0, "in place");
+}
+
+static volatile uint32_t pipe_done;
+
+/*
+ * @brief Completion callback of the pipelined commands
+ */
+static void bench_pipe_cb(uint16_t opcode, uint8_t status, const uint8_t *rparam, uint16_t rlen, void *ctx){
+	pipe_done++;
+}
+
+/*
+ * @brief Compare the commands per second of the blocking wrappers with the
+ * 			asynchronous command pipeline, on LE Read Supported States
+ */
+void ble_bench_cmd_pipeline(void){
+	uint8_t states[8];
+	uint32_t tickstart, serial_ms, pipe_ms, sent = 0;
+	int i;
+
+	tickstart = HAL_GetTick();
+	for(i = 0; i < BENCH_PIPE_ROUNDS; i++)
+		hci_le_read_supported_states(states);
+	serial_ms = HAL_GetTick() - tickstart;
+
+	pipe_done = 0;
+	tickstart = HAL_GetTick();
+	while(pipe_done < BENCH_PIPE_ROUNDS){
+		if((sent < BENCH_PIPE_ROUNDS) &&
+				(hci_send_cmd_async(OGF_LE_CTL, OCF_LE_READ_SUPPORTED_STATES, 0, NULL, bench_pipe_cb, NULL) == 0))
+			sent++;
+		hci_user_evt_proc();
+	}
+	pipe_ms = HAL_GetTick() - tickstart;
+
+	printf("[bench] cmd pipeline: serial %lu cmd/s, async %lu cmd/s\r\n",
+			serial_ms ? BENCH_PIPE_ROUNDS * 1000U / serial_ms : 0,
+			pipe_ms ? BENCH_PIPE_ROUNDS * 1000U / pipe_ms : 0);
+}
+
+/*
+ * @brief Compare the event handoff from the interrupts to the main loop:
+ * 			the list of the former packet pool, where every operation runs with
+ * 			the interrupts disabled, and the receive ring, measured by the HCI
+ * 			layer during the previous benchmarks with no interrupt disabled
+ */
+void ble_bench_rx_handoff(void){
+	tListNode head, nodes[BENCH_LIST_NODES];
+	tListNode *node;
+	tHciRxRingStats ring;
+	uint32_t start, cycles, put_max = 0, get_max = 0, size_cycles;
+	int i;
+
+	list_init_head(&head);
+	for(i = 0; i < BENCH_LIST_NODES; i++){
+		start = BLUENRG_CYCLES();
+		list_insert_tail(&head, &nodes[i]);
+		cycles = BLUENRG_CYCLES() - start;
+		if(cycles > put_max)
+			put_max = cycles;
+	}
+
+	start = BLUENRG_CYCLES();
+	list_get_size(&head);
+	size_cycles = BLUENRG_CYCLES() - start;
+
+	for(i = 0; i < BENCH_LIST_NODES; i++){
+		start = BLUENRG_CYCLES();
+		list_remove_head(&head, &node);
+		cycles = BLUENRG_CYCLES() - start;
+		if(cycles > get_max)
+			get_max = cycles;
+	}
+
+	hci_get_rx_ring_stats(&ring);
+	printf("[bench] rx handoff list: put %lu, get %lu, size of %d %lu cycles (IRQs off for each)\r\n",
+			put_max, get_max, BENCH_LIST_NODES, size_cycles);
+	printf("[bench] rx handoff ring: put max %lu, get max %lu cycles, size O(1) (IRQs never off)\r\n",
+			ring.put_cycles_max, ring.get_cycles_max);
+}
+
+/*
+ * @brief Run the scanning and notification workload for BENCH_MASK_MS
+ * @retvalue SPI reads of the BlueNRG per second
+ */
+static uint32_t bench_evt_mask_rate(void){
+	tHciTlSpiRxStats stats;
+	uint32_t tickstart;
+
+	HCI_TL_SPI_ResetRxStats();
+	tickstart = HAL_GetTick();
+	while(HAL_GetTick() - tickstart < BENCH_MASK_MS){
+		/* Notifications are only sent when a client enabled them */
+		set_notification_pending();
+		send_notification();
+		hci_user_evt_proc();
+	}
+	HCI_TL_SPI_GetRxStats(&stats);
+
+	return stats.rx_transfers * 1000U / BENCH_MASK_MS;
+}
+
+/*
+ * @brief Compare the SPI reads with every event enabled and with the
+ * 			masks computed from the subscriptions, while scanning and
+ * 			sending notifications
+ */
+void ble_bench_evt_mask(void){
+	evt_masks_t masks;
+	uint32_t all_rate, subscribed_rate;
+
+	hci_le_set_scan_parameters(0x00, 0x0010, 0x0010, PUBLIC_ADDR, 0x00);
+	hci_le_set_scan_enable(1, 0);
+
+	evt_mask_restore_defaults();
+	all_rate = bench_evt_mask_rate();
+
+	evt_mask_update();
+	subscribed_rate = bench_evt_mask_rate();
+
+	hci_le_set_scan_enable(0, 0);
+
+	evt_mask_get(&masks);
+	printf("[bench] event masks: %lu SPI reads/s with all events, %lu with the subscribed ones, "
+			"%lu avoided/s (gap 0x%04x gatt 0x%08lx, %lu mask commands)\r\n",
+			all_rate, subscribed_rate, all_rate > subscribed_rate ? all_rate - subscribed_rate : 0,
+			masks.gap, masks.gatt, evt_mask_commands());
+}
+
+/*
+ * @brief Run the main loop for BENCH_ADV_MS while advertising with no client
+ * 			and report the advertising commands sent, compared with the two
+ * 			commands per iteration sent before the advertising state machine
+ */
+void ble_bench_adv_idle(void){
+	adv_stats_t before, after;
+	uint32_t tickstart, loops = 0;
+
+	adv_start();
+	adv_get_stats(&before);
+	tickstart = HAL_GetTick();
+	while(HAL_GetTick() - tickstart < BENCH_ADV_MS){
+		MX_BlueNRG_MS_Process();
+		loops++;
+	}
+	adv_get_stats(&after);
+
+	printf("[bench] adv idle: %lu commands in %lu loops (%lu/s), previously %lu/s; %lu starts, %lu failures\r\n",
+			after.commands - before.commands, loops,
+			(after.commands - before.commands) * 1000U / BENCH_ADV_MS,
+			loops * 2U * 1000U / BENCH_ADV_MS,
+			after.starts - before.starts, after.failures - before.failures);
+}
+
+/*
+ * @brief Dispatch a connection or disconnection event of a simulated link,
+ * 			as if it had been received from the BlueNRG
+ * @param connect 1 for an LE connection complete, 0 for a disconnection
+ * @param handle Connection handle of the link
+ */
+static void bench_link_event(uint8_t connect, uint16_t handle){
+	uint8_t pkt[1 + HCI_EVENT_HDR_SIZE + 1 + EVT_LE_CONN_COMPLETE_SIZE];
+	hci_event_pckt *evt = (void *)(pkt + 1);
+	evt_le_meta_event *meta = (void *)evt->data;
+	evt_le_connection_complete *conn_evt = (void *)meta->data;
+	evt_disconn_complete *disconn_evt = (void *)evt->data;
+
+	memset(pkt, 0, sizeof(pkt));
+	pkt[0] = HCI_EVENT_PKT;
+	if(connect){
+		evt->evt = EVT_LE_META_EVENT;
+		evt->plen = 1 + EVT_LE_CONN_COMPLETE_SIZE;
+		meta->subevent = EVT_LE_CONN_COMPLETE;
+		conn_evt->handle = handle;
+		conn_evt->role = CONN_ROLE_SLAVE;
+	}
+	else{
+		evt->evt = EVT_DISCONN_COMPLETE;
+		evt->plen = EVT_DISCONN_COMPLETE_SIZE;
+		disconn_evt->handle = handle;
+		disconn_evt->reason = HCI_OE_USER_ENDED_CONNECTION;
+	}
+	evt_dispatch(pkt);
+}
+
+/*
+ * @brief Visitor of the fan-out benchmark
+ */
+static void bench_fanout_visit(conn_t *conn, void *ctx){
+	conn->notifications++;
+	(*(uint32_t *)ctx)++;
+}
+
+/*
+ * @brief Fill the connection table with simulated links and measure the
+ * 			fan-out of a notification to 1, 4 and 8 subscribers of the PB
+ * 			characteristic. The advertising is stopped during the benchmark
+ * 			and started again by the next MX_BlueNRG_MS_Process().
+ */
+void ble_bench_fanout(void){
+	static const uint8_t subscribers[] = {1, 4, 8};
+	uint32_t start, cycles, visited;
+	uint8_t i, n, links;
+
+	adv_stop();
+	for(links = 0; links < BLE_MAX_LINKS; links++)
+		bench_link_event(1, BENCH_FANOUT_HANDLE + links);
+
+	for(i = 0; i < sizeof(subscribers); i++){
+		if(subscribers[i] > links)
+			break;
+		for(n = 0; n < links; n++)
+			conn_set_cccd(BENCH_FANOUT_HANDLE + n, PB_CHAR_ID, n < subscribers[i] ? CONN_CCCD_NOTIFY : 0);
+
+		visited = 0;
+		start = BLUENRG_CYCLES();
+		conn_fanout(PB_CHAR_ID, CONN_CCCD_NOTIFY, bench_fanout_visit, &visited);
+		cycles = BLUENRG_CYCLES() - start;
+
+		printf("[bench] fanout: %u links, %lu subscribers visited in %lu cycles (%lu per subscriber)\r\n",
+				links, visited, cycles, visited ? cycles / visited : 0);
+	}
+
+	for(n = 0; n < links; n++)
+		bench_link_event(0, BENCH_FANOUT_HANDLE + n);
+}
+
+/*
+ * @brief Stream len byte values on the PB characteristic for BENCH_STREAM_MS,
+ * 			keeping its queue full, and report the rate accepted by the
+ * 			controller
+ */
+static void bench_notify_stream_len(notify_queue_t *q, uint16_t len){
+	notify_stats_t stats;
+	uint8_t value[NOTIFY_VALUE_MAX];
+	uint32_t tickstart, seq = 0;
+
+	notify_reset_stats();
+	tickstart = HAL_GetTick();
+	while(HAL_GetTick() - tickstart < BENCH_STREAM_MS){
+		while(notify_queue_space(q) > 0){
+			memset(value, (uint8_t)seq++, len);
+			if(notify_queue_push(q, value, len) < 0)
+				break;
+		}
+		MX_BlueNRG_MS_Process();
+	}
+	notify_get_stats(&stats);
+
+	printf("[bench] notify stream %u B: %lu notifications/s, %lu B/s; %lu parks, %lu resumes, %lu held, %lu errors\r\n",
+			len, stats.notifications * 1000U / BENCH_STREAM_MS, stats.bytes * 1000U / BENCH_STREAM_MS,
+			stats.parks, stats.resumes, stats.held, stats.errors);
+}
+
+/*
+ * @brief Compare the notification throughput with the values of the default
+ * 			ATT MTU (20 bytes) and with the values of the MTU negotiated with
+ * 			the client. Needs a client that enables the notifications within
+ * 			BENCH_STREAM_WAIT_MS.
+ */
+void ble_bench_notify_stream(void){
+	notify_queue_t *q = get_pb_notify_queue();
+	uint32_t tickstart;
+	uint16_t payload;
+
+	tickstart = HAL_GetTick();
+	while(!is_notification_enabled() && HAL_GetTick() - tickstart < BENCH_STREAM_WAIT_MS)
+		MX_BlueNRG_MS_Process();
+	if(!is_notification_enabled()){
+		printf("[bench] notify stream: skipped, no client enabled the notifications\r\n");
+		return;
+	}
+
+	payload = notify_queue_payload(q);
+	printf("[bench] notify stream: negotiated payload %u B\r\n", payload);
+	bench_notify_stream_len(q, CONN_ATT_DEFAULT_MTU - CONN_ATT_HDR_SIZE);
+	if(payload > CONN_ATT_DEFAULT_MTU - CONN_ATT_HDR_SIZE)
+		bench_notify_stream_len(q, payload);
+}
+
+/*
+ * @brief Print the connection parameters of the links
+ * @param phase Name of the phase printed in the report
+ */
+static void bench_print_conn_params(const char *phase){
+	conn_t *conn;
+	uint8_t i;
+
+	for(i = 0; i < BLE_MAX_LINKS; i++){
+		conn = conn_get(i);
+		if(conn == NULL)
+			continue;
+		printf("[bench] conn params %s: link 0x%04x interval %u x 1.25 ms, latency %u, timeout %u x 10 ms\r\n",
+				phase, conn->handle, conn->interval, conn->latency, conn->superv_timeout);
+	}
+}
+
+/*
+ * @brief Leave the subscribed links idle, then stream notifications, for
+ * 			BENCH_PARAMS_PHASE_MS each and report the connection parameters
+ * 			the master granted in each phase
+ */
+void ble_bench_conn_params(void){
+	notify_queue_t *q = get_pb_notify_queue();
+	conn_params_stats_t stats;
+	uint8_t value[NOTIFY_VALUE_MAX];
+	uint32_t tickstart;
+	uint16_t len;
+
+	if(!is_notification_enabled()){
+		printf("[bench] conn params: skipped, no client enabled the notifications\r\n");
+		return;
+	}
+
+	tickstart = HAL_GetTick();
+	while(HAL_GetTick() - tickstart < BENCH_PARAMS_PHASE_MS)
+		MX_BlueNRG_MS_Process();
+	bench_print_conn_params("idle");
+
+	memset(value, 0xA5, sizeof(value));
+	tickstart = HAL_GetTick();
+	while(HAL_GetTick() - tickstart < BENCH_PARAMS_PHASE_MS){
+		len = notify_queue_payload(q);
+		while(notify_queue_space(q) > 0 && notify_queue_push(q, value, len) == 0);
+		MX_BlueNRG_MS_Process();
+	}
+	bench_print_conn_params("busy");
+
+	conn_params_get_stats(&stats);
+	printf("[bench] conn params: %lu requests, %lu accepted, %lu rejected, %lu timeouts, %lu errors\r\n",
+			stats.requests, stats.accepted, stats.rejected, stats.timeouts, stats.errors);
+}
+
+/*
+ * @brief Compare the update of BENCH_RECORD_LEN byte records on the record
+ * 			characteristic with one blocking command per chunk and with the
+ * 			chunks pipelined by send_record()
+ */
+void ble_bench_long_value(void){
+	static uint8_t record[BENCH_RECORD_LEN];
+	uint16_t serv_handle, char_handle, offset;
+	uint8_t len;
+	uint32_t tickstart, serial_ms, pipe_ms;
+	tBleStatus ret = BLE_STATUS_SUCCESS;
+	notify_stats_t stats;
+	int i;
+
+	memset(record, 0x5A, sizeof(record));
+	get_record_handles(&serv_handle, &char_handle);
+
+	tickstart = HAL_GetTick();
+	for(i = 0; i < BENCH_RECORD_ROUNDS; i++){
+		for(offset = 0; offset < BENCH_RECORD_LEN; offset += len){
+			len = BENCH_RECORD_LEN - offset > NOTIFY_LONG_CHUNK_MAX ? NOTIFY_LONG_CHUNK_MAX : BENCH_RECORD_LEN - offset;
+			ret |= aci_gatt_update_char_value_ext_IDB05A1(serv_handle, char_handle,
+					offset + len == BENCH_RECORD_LEN ? NOTIFICATION : 0,
+					BENCH_RECORD_LEN, offset, len, record + offset);
+		}
+	}
+	serial_ms = HAL_GetTick() - tickstart;
+
+	notify_reset_stats();
+	tickstart = HAL_GetTick();
+	for(i = 0; i < BENCH_RECORD_ROUNDS; i++){
+		send_record(record, sizeof(record));
+		while(is_record_pending()){
+			notify_process();
+			hci_user_evt_proc();
+		}
+	}
+	pipe_ms = HAL_GetTick() - tickstart;
+	notify_get_stats(&stats);
+
+	printf("[bench] long value %u B: blocking %lu B/s (status 0x%02x), pipelined %lu B/s "
+			"(%lu chunks, %lu errors)\r\n",
+			BENCH_RECORD_LEN,
+			serial_ms ? BENCH_RECORD_LEN * BENCH_RECORD_ROUNDS * 1000U / serial_ms : 0, ret,
+			pipe_ms ? BENCH_RECORD_LEN * BENCH_RECORD_ROUNDS * 1000U / pipe_ms : 0,
+			stats.long_chunks, stats.long_errors);
+}
+
+/*
+ * @brief Measure the LED status updates through its shadow, with the value
+ * 			unchanged and with the value toggled on each update. A client read
+ * 			of the characteristic no longer costs any command: before the
+ * 			shadow, each one cost an update and an allow read.
+ */
+void ble_bench_shadow(void){
+	value_shadow_stats_t before, after;
+	uint32_t start, same_cycles, toggle_cycles;
+	uint8_t led;
+	int i;
+
+	value_shadow_get_stats(&before);
+	led = 0;
+	start = BLUENRG_CYCLES();
+	for(i = 0; i < BENCH_SHADOW_ROUNDS; i++)
+		change_led_state(1, &led);
+	same_cycles = BLUENRG_CYCLES() - start;
+
+	start = BLUENRG_CYCLES();
+	for(i = 0; i < BENCH_SHADOW_ROUNDS; i++){
+		led = i & 1;
+		change_led_state(1, &led);
+	}
+	toggle_cycles = BLUENRG_CYCLES() - start;
+	value_shadow_get_stats(&after);
+
+	led = 0;
+	change_led_state(1, &led);
+
+	printf("[bench] shadow: unchanged %lu cycles/update, toggled %lu us/update; "
+			"%lu writes, %lu skipped, %lu errors\r\n",
+			same_cycles / BENCH_SHADOW_ROUNDS, cycles_to_us(toggle_cycles / BENCH_SHADOW_ROUNDS),
+			after.writes - before.writes, after.skipped - before.skipped, after.errors - before.errors);
+}
+
+/*
+ * @brief Measure the lookup of every handle of the GATT database table, the
+ * 			cost of dispatching a write or a read request. It no longer
+ * 			depends on the position of the attribute in the database.
+ */
+void ble_bench_gatt_db(void){
+	const gatt_attr_t *attr;
+	uint32_t start, cycles, cycles_max = 0;
+	uint16_t first, count, handle, values = 0, cccds = 0;
+
+	gatt_db_get_range(&first, &count);
+	for(handle = first; handle < first + count; handle++){
+		start = BLUENRG_CYCLES();
+		attr = gatt_db_find(handle);
+		cycles = BLUENRG_CYCLES() - start;
+		if(cycles > cycles_max)
+			cycles_max = cycles;
+		if(attr->kind == GATT_DB_ATTR_VALUE)
+			values++;
+		else if(attr->kind == GATT_DB_ATTR_CCCD)
+			cccds++;
+	}
+
+	printf("[bench] gatt db: handles 0x%04x-0x%04x, %u values, %u CCCDs, lookup %lu cycles max\r\n",
+			first, first + count - 1, values, cccds, cycles_max);
+}
+
+/*
+ * @brief Report the milestones of the start-up, from the reset of the MCU
+ * 			to the first advertising. The controller used to get a fixed
+ * 			100 ms after its reset.
+ */
+void ble_bench_boot(void){
+	ble_boot_stats_t stats;
+
+	ble_boot_get_stats(&stats);
+	printf("[bench] boot: init %lu ms, controller ready %lu ms (reason %u%s), gatt built %lu ms (status 0x%02x), "
+			"first advertising %lu ms; config %u written, %u skipped\r\n",
+			stats.init_ms, stats.ready_ms, stats.reset_reason, stats.ready_timeout ? ", timeout" : "",
+			stats.gatt_ms, stats.gatt_status, stats.adv_ms, stats.config_writes, stats.config_skipped);
+}
+
+/*
+ * @brief Report the controller probed at start-up and its capabilities
+ */
+void ble_bench_ctrl(void){
+	const ble_ctrl_caps_t *caps = ble_ctrl_caps();
+	static const char *const names[] = {"unknown", "IDB04A1", "IDB05A1"};
+
+	printf("[bench] controller: %s hw 0x%02x fw 0x%04x, HCI %u rev 0x%04x, %u links, "
+			"%u ACL buffers of %u B, features %02x%02x, %u free link slots\r\n",
+			names[caps->variant], caps->hw_version, caps->fw_version, caps->hci_version, caps->hci_revision,
+			caps->max_links, caps->acl_pkts, caps->acl_pkt_len, caps->features[1], caps->features[0],
+			conn_free_slots());
+}
+
+/*
+ * @brief Report the profile applied at start-up, the IFR itself is not
+ * 			accessed since every access reboots the controller. The
+ * 			encoding is checked on the host, see tests/test_ifr.c.
+ */
+void ble_bench_ifr(void){
+	const ble_ifr_state_t *st = ble_ifr_state();
+
+	printf("[bench] ifr: profile %u, stack mode %u -> %u, %s%s%s, status %d in %lu ms\r\n",
+			st->profile, st->old_mode, st->new_mode, st->written ? "programmed" : "unchanged",
+			st->rolled_back ? ", rolled back" : "", st->rollback_failed ? " (rollback failed)" : "",
+			st->status, st->duration_ms);
+}
+
+/*
+ * @brief Time the CRC unit and the HMAC-SHA256 over 64 KB of the
+ * 			application, the checks of a 200 KB image take about three
+ * 			times as long, and report the last application update
+ * 			received over GATT
+ */
+void ble_bench_dfu(void){
+	static const uint8_t key[SHA256_DIGEST_SIZE] = {0};
+	uint8_t mac[SHA256_DIGEST_SIZE];
+	dfu_stats_t st;
+	uint32_t start, cycles, crc;
+
+	start = BLUENRG_CYCLES();
+	crc = dfu_crc((const uint32_t *)DFU_APP_ADDR, 0x10000 / 4);
+	cycles = BLUENRG_CYCLES() - start;
+	printf("[bench] dfu: CRC unit 64 KB in %lu us (crc %08lx)\r\n", cycles_to_us(cycles), crc);
+
+	start = BLUENRG_CYCLES();
+	hmac_sha256(key, sizeof(key), (const uint8_t *)DFU_APP_ADDR, 0x10000, mac);
+	cycles = BLUENRG_CYCLES() - start;
+	printf("[bench] dfu: HMAC-SHA256 64 KB in %lu us (mac %02x%02x%02x%02x...)\r\n", cycles_to_us(cycles),
+			mac[0], mac[1], mac[2], mac[3]);
+
+	dfu_get_stats(&st);
+	printf("[bench] dfu: state %u, status %u, %lu bytes in %lu writes, %lu ms (erase %lu ms, program %lu ms, "
+			"mac %lu ms), %lu buffers, %lu stalls, %lu notifications\r\n",
+			dfu_get_state(), st.status, st.bytes, st.chunks, st.total_ms, st.erase_ms, st.program_ms,
+			st.mac_ms, st.buffers, st.stalls, st.notifications);
+}
+
+/*
+ * @brief Report the receive flow control counters and the receive ring
+ *        high-water marks collected during the benchmarks
+ */
+void ble_bench_flow_stats(void){
+	tHciFlowStats stats;
+	tHciRxRingStats ring;
+
+	hci_get_flow_stats(&stats);
+	printf("[bench] flow: %lu stalls, %lu events spilled, %lu dropped, %lu controller overflows\r\n",
+			stats.rx_stalls, stats.evt_spilled, stats.evt_dropped, stats.ctrl_evt_lost);
+
+	hci_get_rx_ring_stats(&ring);
+	printf("[bench] rx ring: %u/%u bytes (max %u), %u events (max %u)\r\n",
+			ring.used, ring.size, ring.used_max, ring.records, ring.records_max);
+}
+
+/*
+ * @brief Run all the benchmarks
+ */
+void ble_bench_run(void){
+	/* The services are added and the advertising started from the main loop */
+	while(gatt_db_is_building() || adv_get_state() == ADV_STATE_PENDING)
+		MX_BlueNRG_MS_Process();
+
+	ble_bench_spi_rx();
+	ble_bench_spi_tx();
+	ble_bench_isr();
+	ble_bench_cmd_build();
+	ble_bench_cmd_pipeline();
+	ble_bench_rx_handoff();
+	ble_bench_evt_mask();
+	ble_bench_adv_idle();
+	ble_bench_fanout();
+	ble_bench_notify_stream();
+	ble_bench_conn_params();
+	ble_bench_long_value();
+	ble_bench_shadow();
+	ble_bench_gatt_db();
+	ble_bench_boot();
+	ble_bench_ctrl();
+	ble_bench_ifr();
+	ble_bench_dfu();
+	ble_bench_flow_stats();
+}
+
+#endif /* BLE_BENCH */
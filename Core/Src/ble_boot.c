@@ -0,0 +1,112 @@
+/*
+ * ble_boot.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  hci_init() resets the controller through its reset pin. The controller
+ *  then boots and sends EVT_BLUE_HAL_INITIALIZED once it accepts commands:
+ *  the start-up waits for this event instead of a fixed delay, and falls
+ *  back to BLE_BOOT_READY_TIMEOUT_MS if it does not come.
+ */
+
+#include "ble_boot.h"
+#include "main.h"
+#include "hci.h"
+#include "bluenrg_hal_aci.h"
+#include "event_dispatch.h"
+#include "advertising.h"
+
+#include <string.h>
+
+/* Largest configuration data compared, the ER and IR keys */
+#define BOOT_CONFIG_DATA_MAX      16
+
+static evt_subscription_t initialized_sub;
+static volatile uint8_t initialized;
+static ble_boot_stats_t stats;
+
+/*
+ * @brief The controller booted
+ */
+static void on_hal_initialized(void *pData){
+	evt_hal_initialized *evt = pData;
+
+	stats.reset_reason = evt->reason_code;
+	stats.resets++;
+	initialized = 1;
+}
+
+/*
+ * @brief Start recording the start-up, to be called before hci_init()
+ */
+void ble_boot_init(void){
+	memset(&stats, 0, sizeof(stats));
+	initialized = 0;
+	stats.init_ms = HAL_GetTick();
+	evt_dispatch_subscribe(&initialized_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_HAL_INITIALIZED, on_hal_initialized);
+}
+
+/*
+ * @brief Wait for the controller reset by hci_init() to be initialized. No
+ * 			command may be sent before: a command frees the events received.
+ * @retvalue 0 on success, -1 if the event did not come in time
+ */
+int ble_boot_wait_ready(void){
+	uint32_t tickstart = HAL_GetTick();
+
+	while(!initialized){
+		if((HAL_GetTick() - tickstart) >= BLE_BOOT_READY_TIMEOUT_MS){
+			stats.ready_timeout = 1;
+			stats.ready_ms = HAL_GetTick();
+			return -1;
+		}
+		hci_user_evt_proc();
+	}
+	stats.ready_ms = HAL_GetTick();
+	return 0;
+}
+
+/*
+ * @brief Write configuration data only if the controller does not already
+ * 			hold the value, e.g. from its factory configuration. Not for
+ * 			CONFIG_DATA_LL_WITHOUT_HOST and the mode, only written by the
+ * 			first command after the reset.
+ * @param offset CONFIG_DATA_*_OFFSET
+ * @param len Length of the data
+ * @param value Value
+ * @retvalue Status of the write, BLE_STATUS_SUCCESS when not needed
+ */
+tBleStatus ble_boot_config_data(uint8_t offset, uint8_t len, const uint8_t *value){
+	uint8_t data[BOOT_CONFIG_DATA_MAX];
+	uint8_t data_len = 0;
+
+	if(len <= sizeof(data) &&
+			aci_hal_read_config_data(offset, sizeof(data), &data_len, data) == BLE_STATUS_SUCCESS &&
+			data_len == len && memcmp(data, value, len) == 0){
+		stats.config_skipped++;
+		return BLE_STATUS_SUCCESS;
+	}
+
+	stats.config_writes++;
+	return aci_hal_write_config_data(offset, len, value);
+}
+
+/*
+ * @brief The GATT database is built
+ * @param status Status of the build
+ */
+void ble_boot_gatt_built(tBleStatus status){
+	stats.gatt_ms = HAL_GetTick();
+	stats.gatt_status = status;
+}
+
+/*
+ * @brief Get the milestones of the start-up
+ */
+void ble_boot_get_stats(ble_boot_stats_t *s){
+	adv_stats_t adv;
+
+	adv_get_stats(&adv);
+	*s = stats;
+	s->adv_ms = adv.first_start_tick;
+}
@@ -0,0 +1,170 @@
+/*
+ * ble_ctrl.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  The variant is told by the hardware version in the HCI revision, as
+ *  getBlueNRGVersion() decodes it: the BlueNRG-MS starts at cut 3.1. The
+ *  local version is read once, the rest of the firmware asks the cached
+ *  capabilities.
+ */
+
+#include "ble_ctrl.h"
+#include "hci.h"
+#include "hci_le.h"
+#include "bluenrg_gap.h"
+#include "bluenrg_gap_aci.h"
+#include "bluenrg_gatt_aci.h"
+#include "conn_table.h"
+#include "ble_ifr.h"
+
+#include <string.h>
+
+/* First hardware version of the BlueNRG-MS */
+#define BLE_CTRL_MS_HW_VERSION      0x31
+
+/* Links accepted as a peripheral: a BlueNRG peripheral has one master */
+#define BLE_CTRL_IDB04A1_LINKS      1
+#define BLE_CTRL_IDB05A1_LINKS      8
+
+static tBleStatus gap_init_idb04a1(uint8_t role, uint8_t privacy_enabled, uint8_t dev_name_len,
+		uint16_t *service_handle, uint16_t *dev_name_char_handle, uint16_t *appearance_char_handle){
+	uint8_t role_idb04a1;
+
+	/* Roles are bits for the IDB05A1, numbers for the IDB04A1 */
+	switch(role){
+		case GAP_PERIPHERAL_ROLE_IDB05A1:	role_idb04a1 = GAP_PERIPHERAL_ROLE_IDB04A1; break;
+		case GAP_BROADCASTER_ROLE_IDB05A1:	role_idb04a1 = GAP_BROADCASTER_ROLE_IDB04A1; break;
+		case GAP_CENTRAL_ROLE_IDB05A1:		role_idb04a1 = GAP_CENTRAL_ROLE_IDB04A1; break;
+		case GAP_OBSERVER_ROLE_IDB05A1:		role_idb04a1 = GAP_OBSERVER_ROLE_IDB04A1; break;
+		default:
+			return BLE_STATUS_INVALID_PARAMS;
+	}
+	return aci_gap_init_IDB04A1(role_idb04a1, service_handle, dev_name_char_handle, appearance_char_handle);
+}
+
+static tBleStatus set_direct_connectable_idb04a1(uint8_t own_addr_type, uint8_t directed_adv_type, uint8_t initiator_addr_type,
+		const uint8_t *initiator_addr, uint16_t adv_interv_min, uint16_t adv_interv_max){
+	return aci_gap_set_direct_connectable_IDB04A1(own_addr_type, initiator_addr_type, initiator_addr);
+}
+
+static tBleStatus set_non_connectable_idb04a1(uint8_t adv_type, uint8_t own_address_type){
+	return aci_gap_set_non_connectable_IDB04A1(adv_type);
+}
+
+static tBleStatus allow_rebond_idb04a1(uint16_t conn_handle){
+	return aci_gap_allow_rebond_IDB04A1();
+}
+
+static tBleStatus resolve_private_address_idb04a1(const tBDAddr private_address, tBDAddr actual_address){
+	return aci_gap_resolve_private_address_IDB04A1(private_address);
+}
+
+static void attr_modified_idb04a1(void *pData, ble_ctrl_attr_modified_t *evt){
+	evt_gatt_attr_modified_IDB04A1 *e = pData;
+
+	evt->conn_handle = e->conn_handle;
+	evt->attr_handle = e->attr_handle;
+	evt->offset = 0;
+	evt->len = e->data_length;
+	evt->data = e->att_data;
+}
+
+static void attr_modified_idb05a1(void *pData, ble_ctrl_attr_modified_t *evt){
+	evt_gatt_attr_modified_IDB05A1 *e = pData;
+
+	evt->conn_handle = e->conn_handle;
+	evt->attr_handle = e->attr_handle;
+	evt->offset = e->offset;
+	evt->len = e->data_length;
+	evt->data = e->att_data;
+}
+
+static const ble_ctrl_ops_t ops_idb04a1 = {
+	.gap_init = gap_init_idb04a1,
+	.set_direct_connectable = set_direct_connectable_idb04a1,
+	.set_non_connectable = set_non_connectable_idb04a1,
+	.allow_rebond = allow_rebond_idb04a1,
+	.resolve_private_address = resolve_private_address_idb04a1,
+	.attr_modified = attr_modified_idb04a1,
+};
+
+static const ble_ctrl_ops_t ops_idb05a1 = {
+	.gap_init = aci_gap_init_IDB05A1,
+	.set_direct_connectable = aci_gap_set_direct_connectable_IDB05A1,
+	.set_non_connectable = aci_gap_set_non_connectable_IDB05A1,
+	.allow_rebond = aci_gap_allow_rebond_IDB05A1,
+	.resolve_private_address = aci_gap_resolve_private_address_IDB05A1,
+	.attr_modified = attr_modified_idb05a1,
+};
+
+static ble_ctrl_caps_t caps;
+/* The board the firmware was written for until the probe tells otherwise */
+static const ble_ctrl_ops_t *ops = &ops_idb05a1;
+
+/*
+ * @brief Identify the controller, bind its function table and read its
+ * 			capabilities. To be called once the controller is initialized,
+ * 			before aci_gap_init().
+ * @retvalue Status of the version read. On failure the IDB05A1 functions
+ * 			stay bound and the variant is BLE_CTRL_UNKNOWN.
+ */
+tBleStatus ble_ctrl_probe(void){
+	tBleStatus ret;
+
+	memset(&caps, 0, sizeof(caps));
+
+	ret = hci_le_read_local_version(&caps.hci_version, &caps.hci_revision, &caps.lmp_pal_version,
+			&caps.manufacturer, &caps.lmp_pal_subversion);
+	if(ret != BLE_STATUS_SUCCESS)
+		return ret;
+
+	caps.hw_version = caps.hci_revision >> 8;
+	caps.fw_version = (caps.hci_revision & 0xFF) << 8;
+	caps.fw_version |= ((caps.lmp_pal_subversion >> 4) & 0xF) << 4;
+	caps.fw_version |= caps.lmp_pal_subversion & 0xF;
+
+	if(caps.hw_version >= BLE_CTRL_MS_HW_VERSION){
+		caps.variant = BLE_CTRL_IDB05A1;
+		/* The stack mode of the IFR, when read, sets the number of links */
+		caps.max_links = ble_ifr_links() ? ble_ifr_links() : BLE_CTRL_IDB05A1_LINKS;
+		ops = &ops_idb05a1;
+	}
+	else{
+		caps.variant = BLE_CTRL_IDB04A1;
+		caps.max_links = BLE_CTRL_IDB04A1_LINKS;
+		ops = &ops_idb04a1;
+	}
+
+	/* Optional: the defaults of the configuration stay in use on failure */
+	hci_le_read_buffer_size(&caps.acl_pkt_len, &caps.acl_pkts);
+	hci_le_read_local_supported_features(caps.features);
+
+	conn_set_limits(caps.max_links, caps.acl_pkts);
+	return BLE_STATUS_SUCCESS;
+}
+
+/*
+ * @brief Capabilities of the controller
+ */
+const ble_ctrl_caps_t *ble_ctrl_caps(void){
+	return &caps;
+}
+
+/*
+ * @brief Function table of the controller
+ */
+const ble_ctrl_ops_t *ble_ctrl_ops(void){
+	return ops;
+}
+
+/*
+ * @brief Check whether the controller supports an LE feature
+ * @param bit BLE_CTRL_FEAT_*
+ * @retvalue 1 if supported, else 0
+ */
+uint8_t ble_ctrl_has_feature(uint8_t bit){
+	if(bit >= 64)
+		return 0;
+	return (caps.features[bit >> 3] >> (bit & 7)) & 1;
+}
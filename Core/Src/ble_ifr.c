@@ -0,0 +1,182 @@
+/*
+ * ble_ifr.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  ble_ifr_apply() reads the IFR, refuses to touch it if its configuration
+ *  block does not validate, and programs it only when the profile changes
+ *  it. The new IFR is read back and the stack must answer after the reboot,
+ *  otherwise the IFR read at the start is programmed back. Every access
+ *  reboots the controller, so this runs before the GAP and GATT set-up.
+ */
+
+#include "ble_ifr.h"
+#include "main.h"
+#include "hci_const.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/* First hardware version of the BlueNRG-MS, the IFR layout is its own */
+#define IFR_MS_HW_VERSION      0x31
+
+/* Configuration block of the IFR, parsed by parse_IFR_data_config() */
+#define IFR_CONFIG_BLOCK       offsetof(IFR_config_TypeDef, stack_mode)
+
+/* Stack mode of each profile, 0 for none */
+static const uint8_t profile_stack_mode[BLE_IFR_PROFILE_COUNT] = {
+	[BLE_IFR_PROFILE_NONE] = 0,
+	[BLE_IFR_PROFILE_MAX_THROUGHPUT] = 2,
+	[BLE_IFR_PROFILE_MAX_LINKS] = 3,
+	[BLE_IFR_PROFILE_LOW_POWER] = 1,
+};
+
+static ble_ifr_state_t state;
+
+/*
+ * @brief Master sleep clock accuracy class of a sleep clock
+ * @param ppm Accuracy of the sleep clock
+ * @retvalue Class, 0 (251 to 500 ppm) to 7 (0 to 20 ppm)
+ */
+uint8_t ble_ifr_sca_class(uint16_t ppm){
+	static const uint16_t upper[8] = {500, 250, 150, 100, 75, 50, 30, 20};
+	uint8_t sca = 0;
+
+	while(sca < 7 && ppm <= upper[sca + 1])
+		sca++;
+	return sca;
+}
+
+/*
+ * @brief Change the configuration read from the IFR into the one of a
+ * 			profile. The fields the profile does not set are kept.
+ * @param profile BLE_IFR_PROFILE_*
+ * @param config Configuration parsed by parse_IFR_data_config()
+ */
+void ble_ifr_profile_config(uint8_t profile, IFR_config2_TypeDef *config){
+	if(profile >= BLE_IFR_PROFILE_COUNT || profile == BLE_IFR_PROFILE_NONE)
+		return;
+
+	config->stack_mode = profile_stack_mode[profile];
+	if(profile == BLE_IFR_PROFILE_LOW_POWER){
+		/* The peer widens its receive window by the accuracy announced */
+		config->slave_sca_ppm = BLE_IFR_SLEEP_CLOCK_PPM;
+		config->master_sca = ble_ifr_sca_class(BLE_IFR_SLEEP_CLOCK_PPM);
+	}
+}
+
+/*
+ * @brief Links of a stack mode
+ */
+static uint8_t stack_mode_links(uint8_t mode){
+	switch(mode){
+		case 1:
+		case 2:
+			return 1;
+		case 3:
+			return 8;
+		case 4:
+			return 4;
+	}
+	return 0;
+}
+
+/*
+ * @brief Links of the stack mode running, 0 if the IFR was not read
+ */
+uint8_t ble_ifr_links(void){
+	return stack_mode_links(state.new_mode);
+}
+
+/*
+ * @brief Result of the last ble_ifr_apply()
+ */
+const ble_ifr_state_t *ble_ifr_state(void){
+	return &state;
+}
+
+/*
+ * @brief Check the IFR programmed and that the stack runs after the reboot
+ * @param image IFR programmed
+ * @retvalue BLE_UTIL_SUCCESS or the failure
+ */
+static int check_programmed(const IFR_config_TypeDef *image){
+	uint8_t hw_version;
+	uint16_t fw_version;
+	int ret;
+
+	ret = verify_IFR(image);
+	if(ret != BLE_UTIL_SUCCESS)
+		return ret;
+	if(getBlueNRGVersion(&hw_version, &fw_version) != BLE_STATUS_SUCCESS)
+		return BLE_UTIL_ACI_ERROR;
+	return BLE_UTIL_SUCCESS;
+}
+
+/*
+ * @brief Record the end of ble_ifr_apply()
+ */
+static int apply_done(int status, uint32_t tickstart){
+	state.status = status;
+	state.duration_ms = HAL_GetTick() - tickstart;
+	return status;
+}
+
+/*
+ * @brief Program the IFR of a profile, when it differs from the IFR of
+ * 			the controller. The controller reboots: to be called at
+ * 			start-up, after ble_boot_wait_ready() and before any set-up.
+ * @param profile BLE_IFR_PROFILE_*
+ * @retvalue BLE_UTIL_SUCCESS or BLE_UTIL_* error, see ble_ifr_state()
+ */
+int ble_ifr_apply(uint8_t profile){
+	IFR_config_TypeDef current, image;
+	IFR_config2_TypeDef config;
+	uint32_t tickstart = HAL_GetTick();
+	uint8_t hw_version;
+	uint16_t fw_version;
+	int ret;
+
+	memset(&state, 0, sizeof(state));
+	state.profile = profile;
+
+	if(profile >= BLE_IFR_PROFILE_COUNT || profile == BLE_IFR_PROFILE_NONE)
+		return apply_done(BLE_UTIL_PARSE_ERROR, tickstart);
+	if(getBlueNRGVersion(&hw_version, &fw_version) != BLE_STATUS_SUCCESS)
+		return apply_done(BLE_UTIL_ACI_ERROR, tickstart);
+	if(hw_version < IFR_MS_HW_VERSION)
+		return apply_done(BLE_UTIL_UNSUPPORTED_VERSION, tickstart);
+
+	ret = read_IFR((uint8_t *)&current);
+	if(ret != BLE_UTIL_SUCCESS)
+		return apply_done(ret, tickstart);
+
+	// An IFR that does not validate is not ours to rewrite
+	parse_IFR_data_config((uint8_t *)&current + IFR_CONFIG_BLOCK, &config);
+	if(IFR_validate(&config) != BLE_UTIL_SUCCESS)
+		return apply_done(BLE_UTIL_PARSE_ERROR, tickstart);
+	state.old_mode = config.stack_mode;
+	state.new_mode = config.stack_mode;
+
+	ble_ifr_profile_config(profile, &config);
+	if(IFR_validate(&config) != BLE_UTIL_SUCCESS)
+		return apply_done(BLE_UTIL_PARSE_ERROR, tickstart);
+	image = current;
+	change_IFR_data_config(&config, (uint8_t *)&image + IFR_CONFIG_BLOCK);
+	if(memcmp(&image, &current, sizeof(image)) == 0)
+		return apply_done(BLE_UTIL_SUCCESS, tickstart);
+
+	state.written = 1;
+	ret = program_IFR(&image);
+	if(ret == BLE_UTIL_SUCCESS)
+		ret = check_programmed(&image);
+	if(ret == BLE_UTIL_SUCCESS){
+		state.new_mode = config.stack_mode;
+		return apply_done(ret, tickstart);
+	}
+
+	state.rolled_back = 1;
+	if(program_IFR(&current) != BLE_UTIL_SUCCESS || check_programmed(&current) != BLE_UTIL_SUCCESS)
+		state.rollback_failed = 1;
+	return apply_done(ret, tickstart);
+}
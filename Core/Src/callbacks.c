@@ -10,103 +10,90 @@
 #include "app_ble.h"
 #include "bluenrg_gap_aci.h"
 #include "bluenrg_gatt_aci.h"
+#include "conn_table.h"
+#include "gatt_db.h"
 
 #include<stdbool.h>
 #include<stdlib.h>
 
-static volatile uint8_t CONNECTED = FALSE;
-static volatile uint8_t NOTIFICATION_ENABLED = FALSE;
-
 void cb_on_gap_connection_complete(uint8_t *, uint16_t);
-void cb_on_gap_disconnection_complete(void);
-void cb_on_read_request(uint16_t);
-void cb_on_attribute_modified(uint16_t, uint16_t, uint8_t []);
+void cb_on_gap_disconnection_complete(uint16_t);
+void cb_on_read_request(uint16_t, uint16_t);
+void cb_on_attribute_modified(uint16_t, uint16_t, uint16_t, uint8_t []);
 
 uint8_t is_connected(void);
 
 
 /*
  * @ brief return the status of connection
- * @retvalue True if connected, else False
+ * @retvalue True if at least one client is connected, else False
  */
 uint8_t is_connected(void){
-	return CONNECTED;
+	return conn_count() > 0;
 }
 
 
 /*
  * @ brief return the status of notifications
+ * @retvalue True if at least one client enabled them, else False
  */
 uint8_t is_notification_enabled(void){
-	return NOTIFICATION_ENABLED;
+	return conn_subscribers(PB_CHAR_ID, CONN_CCCD_NOTIFY | CONN_CCCD_INDICATE) != 0;
 }
 
 /*
- * @brief Call back called on successful connection complete
+ * @brief Call back called on successful connection complete,
+ * 			the link is already in the connection table. Start
+ * 			the MTU exchange, the connection table records the
+ * 			negotiated MTU
  * @param peer_addr An array that contains peer address
  * @param handle connection handle
  */
 void cb_on_gap_connection_complete(uint8_t peer_addr[], uint16_t handle){
-	CONNECTED = TRUE;
-	set_connection_handle(handle);
+	aci_gatt_exchange_configuration(handle);
 	reset_connectable_status();
 }
 
 
 /*
- * @brief Call back called on successful disconnection
- * 			reset the active connection flags to make
- * 			BLE device to broadcast discovery packets
- * 			again
+ * @brief Call back called on successful disconnection,
+ * 			the link is already removed from the connection
+ * 			table. Make BLE device to broadcast discovery
+ * 			packets again
+ * @param handle connection handle of the closed link
  */
-void cb_on_gap_disconnection_complete(void){
-	CONNECTED = FALSE;
-	set_connection_handle(0);
+void cb_on_gap_disconnection_complete(uint16_t handle){
 	set_connectable_status();
 }
 
 
 /*
  * @brief 当设备请求读取特征值时调用的回调函数。
- *        该函数处理读取类型的特征值请求。
+ *        该函数处理以读许可注册的特征值请求；LED 状态特征由 control
+ *        直接应答（值由 value_shadow 保持最新），不再经过这里。
+ * @param conn_handle 发起请求的连接句柄。
  * @param handle 特征句柄，用于标识具体的特征。
  */
-void cb_on_read_request(uint16_t handle){
-	// 检查是否是 LED 状态读取特征的句柄
-	if(is_led_status_read_charac(handle))
-		service_read_request(); // 调用服务层函数处理读取请求
-
-	// 获取当前连接句柄
-	uint16_t connection_handle = get_connection_handle();
-
-	// 如果设备已连接且连接句柄有效
-	if(CONNECTED && connection_handle!=0){
-		aci_gatt_allow_read(connection_handle); // 允许客户端读取特征值
+void cb_on_read_request(uint16_t conn_handle, uint16_t handle){
+	// 如果请求来自连接表中的链路
+	if(conn_find(conn_handle) != NULL){
+		gatt_db_read_request(conn_handle, handle); // 由服务表中该特征的读处理函数更新值
+		aci_gatt_allow_read(conn_handle); // 允许该客户端读取特征值
 	}
 }
 
 /*
  * @brief 这是一个回调函数，当连接的设备修改属性时调用。
  *        例如，启用通知、从连接的设备写入数据等。
- * @param handle 特征句柄，用于与特定特征进行比较。
+ * @param conn_handle 修改属性的连接句柄。
+ * @param handle 特征句柄，按句柄直接索引服务表的分发数组。
  * @param len 到达无线电的数据长度。
  * @param data 到达的数据。
  * @retvalue 无返回值。
  */
-void cb_on_attribute_modified(uint16_t handle, uint16_t len, uint8_t data[]){
-	// 检查是否是通知特征的句柄
-	if(is_pb_notification_attribute(handle)){
-		if(data[0] == 0x01) // 如果数据为 0x01，启用通知
-			NOTIFICATION_ENABLED = TRUE;
-		else // 如果数据为其他值，禁用通知
-			NOTIFICATION_ENABLED = FALSE;
-
-	}
-
-	// 检查是否是 LED 控制特征的句柄
-	if(is_led_control_attribute(handle)){
-		change_led_state(len, data); // 根据接收到的数据更改 LED 状态
-	}
+void cb_on_attribute_modified(uint16_t conn_handle, uint16_t handle, uint16_t len, uint8_t data[]){
+	// CCCD 记录到该链路的订阅（bit0 通知，bit1 指示），特征值交给其写处理函数（如 LED 控制）
+	gatt_db_attribute_modified(conn_handle, handle, len, data);
 }
 
 /*
@@ -0,0 +1,192 @@
+/*
+ * conn_params.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Every CONN_PARAMS_PERIOD_MS the traffic of each link is evaluated: a
+ *  link is busy while values it subscribed to are queued or while it
+ *  receives CONN_PARAMS_BUSY_RATE notifications per second, idle after
+ *  CONN_PARAMS_IDLE_MS without traffic. A connection parameter update
+ *  request is sent when the parameters wanted differ from the ones the
+ *  master accepted, one request at a time per link and at most one every
+ *  CONN_PARAMS_MIN_GAP_MS. Each rejection doubles that delay, up to
+ *  CONN_PARAMS_MAX_BACKOFF_MS.
+ *
+ *  The L2CAP request is a slave procedure: the links where the device is
+ *  master are left alone.
+ */
+
+#include "conn_params.h"
+#include "conn_table.h"
+#include "notify_queue.h"
+#include "event_dispatch.h"
+#include "main.h"
+#include "hci_const.h"
+#include "bluenrg_aci_const.h"
+#include "bluenrg_l2cap_aci.h"
+#include "bluenrg_conf.h"
+
+#include <string.h>
+
+/* Code of an L2CAP Connection Parameter Update Response, else Command Reject */
+#define L2CAP_CONN_PARAM_UPDATE_RESP_CODE    0x13
+
+typedef struct {
+	uint16_t interv_min;
+	uint16_t interv_max;
+	uint16_t latency;
+	uint16_t timeout_multiplier;
+} conn_params_profile_t;
+
+static const conn_params_profile_t profiles[] = {
+	[CONN_PARAMS_FAST] = {L2CAP_INTERV_MIN, L2CAP_INTERV_MAX, 0, L2CAP_TIMEOUT_MULTIPLIER},
+	[CONN_PARAMS_IDLE] = {CONN_IDLE_INTERV_MIN, CONN_IDLE_INTERV_MAX, CONN_IDLE_LATENCY, L2CAP_TIMEOUT_MULTIPLIER},
+};
+
+static conn_params_stats_t stats;
+static uint32_t eval_tick;
+
+/*
+ * @brief End of the request in progress of a link
+ * @param conn Link
+ * @param accepted 1 if the master accepted the parameters, else 0
+ */
+static void request_done(conn_t *conn, uint8_t accepted){
+	conn_policy_t *p = &conn->policy;
+
+	if(accepted){
+		p->profile = p->requested;
+		p->backoff_ms = CONN_PARAMS_MIN_GAP_MS;
+	}
+	else if(p->backoff_ms < CONN_PARAMS_MAX_BACKOFF_MS / 2)
+		p->backoff_ms *= 2;
+	else
+		p->backoff_ms = CONN_PARAMS_MAX_BACKOFF_MS;
+	p->requested = CONN_PARAMS_NONE;
+}
+
+/*
+ * @brief Answer of the master to a connection parameter update request
+ */
+static void on_conn_upd_resp(void *pData){
+	evt_l2cap_conn_upd_resp *evt = pData;
+	conn_t *conn = conn_find(evt->conn_handle);
+
+	if(conn == NULL || conn->policy.requested == CONN_PARAMS_NONE)
+		return;
+
+	if(evt->code == L2CAP_CONN_PARAM_UPDATE_RESP_CODE && evt->result == 0){
+		stats.accepted++;
+		request_done(conn, 1);
+	}
+	else{
+		stats.rejected++;
+		request_done(conn, 0);
+	}
+}
+
+/*
+ * @brief The master did not answer a request within 30 s
+ */
+static void on_l2cap_procedure_timeout(void *pData){
+	evt_l2cap_procedure_timeout *evt = pData;
+	conn_t *conn = conn_find(evt->conn_handle);
+
+	if(conn == NULL || conn->policy.requested == CONN_PARAMS_NONE)
+		return;
+
+	stats.timeouts++;
+	request_done(conn, 0);
+}
+
+/*
+ * @brief Subscribe to the answers of the master
+ */
+void conn_params_init(void){
+	static evt_subscription_t resp_sub, timeout_sub;
+
+	memset(&stats, 0, sizeof(stats));
+	eval_tick = HAL_GetTick();
+
+	evt_dispatch_subscribe(&resp_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_L2CAP_CONN_UPD_RESP, on_conn_upd_resp);
+	evt_dispatch_subscribe(&timeout_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_L2CAP_PROCEDURE_TIMEOUT, on_l2cap_procedure_timeout);
+}
+
+/*
+ * @brief Check whether a link is transferring data: values queued on the
+ * 			characteristics it subscribed to, or notified to it at a high rate
+ * @param conn Link
+ * @param elapsed Time (ms) since the last evaluation
+ */
+static uint8_t is_busy(conn_t *conn, uint32_t elapsed){
+	uint32_t rate = (conn->notifications - conn->policy.notifications) * 1000U / elapsed;
+
+	if(notify_queued_bytes_of(conn->notify | conn->indicate) > 0)
+		return 1;
+	return rate >= CONN_PARAMS_BUSY_RATE;
+}
+
+/*
+ * @brief Evaluate the traffic of the links and request the parameters
+ * 			that fit it, called from the main loop
+ */
+void conn_params_process(void){
+	uint32_t now = HAL_GetTick();
+	uint32_t elapsed = now - eval_tick;
+	conn_policy_t *p;
+	conn_t *conn;
+	uint8_t i, want;
+	tBleStatus ret;
+
+	if(elapsed < CONN_PARAMS_PERIOD_MS)
+		return;
+	eval_tick = now;
+
+	for(i = 0; i < BLE_MAX_LINKS; i++){
+		conn = conn_get(i);
+		if(conn == NULL || conn->role != CONN_ROLE_SLAVE)
+			continue;
+		p = &conn->policy;
+
+		/* New link: let the master finish its own procedures first */
+		if(p->backoff_ms == 0){
+			p->backoff_ms = CONN_PARAMS_MIN_GAP_MS;
+			p->request_tick = now;
+			p->active_tick = now;
+			p->notifications = conn->notifications;
+			continue;
+		}
+
+		if(is_busy(conn, elapsed)){
+			p->active_tick = now;
+			want = CONN_PARAMS_FAST;
+		}
+		else if(now - p->active_tick >= CONN_PARAMS_IDLE_MS)
+			want = CONN_PARAMS_IDLE;
+		else
+			want = p->profile;
+		p->notifications = conn->notifications;
+
+		if(want == p->profile || want == CONN_PARAMS_NONE || p->requested != CONN_PARAMS_NONE ||
+				now - p->request_tick < p->backoff_ms)
+			continue;
+
+		ret = aci_l2cap_connection_parameter_update_request(conn->handle,
+				profiles[want].interv_min, profiles[want].interv_max,
+				profiles[want].latency, profiles[want].timeout_multiplier);
+		p->request_tick = now;
+		if(ret == BLE_STATUS_SUCCESS){
+			p->requested = want;
+			stats.requests++;
+		}
+		else
+			stats.errors++;
+	}
+}
+
+/*
+ * @brief Copy the counters of the requests
+ */
+void conn_params_get_stats(conn_params_stats_t *out){
+	*out = stats;
+}
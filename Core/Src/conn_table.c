@@ -0,0 +1,452 @@
+/*
+ * conn_table.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  The table subscribes to the connection and disconnection events before
+ *  the application handlers, so it is up to date when they run. A handle
+ *  is stored in the slot of its low bits, or in the next free slot on a
+ *  collision: the BlueNRG-MS allocates consecutive handles, so a lookup
+ *  is a single compare in practice.
+ *
+ *  The subscriptions are kept both ways: the characteristics of a link
+ *  (conn_t.notify/indicate) and the links of a characteristic (one
+ *  conn_mask_t per characteristic and type), so that a fan-out only walks
+ *  the subscribed links and a disconnection only the subscribed
+ *  characteristics.
+ *
+ *  A link holds the values of its characteristics (conn_blocked()) while
+ *  it has no TX credit left or an indication waits for its confirmation.
+ *  The credits are returned by the Number Of Completed Packets event of
+ *  the link, and all at once when the controller reports its TX pool
+ *  available again. They are a soft limit: a link that got none back for
+ *  BLE_LINK_CREDIT_TIMEOUT_MS, or whose completed packets events were
+ *  lost, gets them all back, and the park of notify_queue.c on
+ *  BLE_STATUS_INSUFFICIENT_RESOURCES still holds a full controller.
+ */
+
+#include "conn_table.h"
+#include "event_dispatch.h"
+#include "hci_const.h"
+#include "bluenrg_aci_const.h"
+#include "bluenrg_gatt_aci.h"
+#include "bluenrg_hal_aci.h"
+#include "main.h"
+
+#include <string.h>
+
+#if (BLE_MAX_LINKS & (BLE_MAX_LINKS - 1)) != 0
+#error "BLE_MAX_LINKS must be a power of two"
+#endif
+#if BLE_MAX_LINKS > 8
+#error "conn_mask_t holds 8 links"
+#endif
+#if BLE_MAX_SUBSCRIBED_CHARS > 32
+#error "conn_t.notify/indicate hold 32 characteristics"
+#endif
+
+static conn_t links[BLE_MAX_LINKS];
+static uint8_t links_in_use;
+static uint8_t max_links = BLE_MAX_LINKS;
+static uint8_t link_tx_credits = BLE_LINK_TX_CREDITS;
+static conn_mask_t notify_links[BLE_MAX_SUBSCRIBED_CHARS];
+static conn_mask_t indicate_links[BLE_MAX_SUBSCRIBED_CHARS];
+
+/*
+ * @brief Slot where the lookup of a handle starts
+ */
+static uint8_t home_slot(uint16_t handle){
+	return handle & (BLE_MAX_LINKS - 1);
+}
+
+/*
+ * @brief Index of the lowest bit set
+ */
+static uint8_t lowest_bit(uint32_t bits){
+	return __builtin_ctz(bits);
+}
+
+/*
+ * @brief Remove a link from the subscribers of the characteristics it
+ * 			subscribed to
+ */
+static void unsubscribe_all(conn_t *conn){
+	conn_mask_t slot_bit = 1U << (conn - links);
+	uint32_t chars;
+	uint8_t id;
+
+	for(chars = conn->notify; chars != 0; chars &= chars - 1){
+		id = lowest_bit(chars);
+		notify_links[id] &= ~slot_bit;
+	}
+	for(chars = conn->indicate; chars != 0; chars &= chars - 1){
+		id = lowest_bit(chars);
+		indicate_links[id] &= ~slot_bit;
+	}
+	conn->notify = 0;
+	conn->indicate = 0;
+}
+
+/*
+ * @brief LE connection complete: add the link
+ */
+static void on_le_connection_complete(void *pData){
+	evt_le_connection_complete *evt = pData;
+	uint8_t i, slot;
+	conn_t *conn;
+
+	if(evt->status != 0 || conn_find(evt->handle) != NULL)
+		return;
+
+	for(i = 0; i < BLE_MAX_LINKS; i++){
+		slot = (home_slot(evt->handle) + i) & (BLE_MAX_LINKS - 1);
+		conn = &links[slot];
+		if(conn->in_use)
+			continue;
+
+		memset(conn, 0, sizeof(*conn));
+		conn->in_use = 1;
+		conn->handle = evt->handle;
+		conn->role = evt->role;
+		conn->peer_addr_type = evt->peer_bdaddr_type;
+		memcpy(conn->peer_addr, evt->peer_bdaddr, sizeof(conn->peer_addr));
+		conn->mtu = CONN_ATT_DEFAULT_MTU;
+		conn->interval = evt->interval;
+		conn->latency = evt->latency;
+		conn->superv_timeout = evt->supervision_timeout;
+		conn->tx_credits = link_tx_credits;
+		links_in_use++;
+		return;
+	}
+}
+
+/*
+ * @brief LE connection update complete: record the new parameters
+ */
+static void on_le_connection_update_complete(void *pData){
+	evt_le_connection_update_complete *evt = pData;
+	conn_t *conn;
+
+	if(evt->status != 0)
+		return;
+
+	conn = conn_find(evt->handle);
+	if(conn != NULL){
+		conn->interval = evt->interval;
+		conn->latency = evt->latency;
+		conn->superv_timeout = evt->supervision_timeout;
+	}
+}
+
+/*
+ * @brief Disconnection complete: remove the link
+ */
+static void on_disconnection_complete(void *pData){
+	evt_disconn_complete *evt = pData;
+	conn_t *conn;
+
+	if(evt->status != 0)
+		return;
+
+	conn = conn_find(evt->handle);
+	if(conn != NULL){
+		unsubscribe_all(conn);
+		conn->in_use = 0;
+		links_in_use--;
+	}
+}
+
+/*
+ * @brief Encryption change: record whether the link is encrypted
+ */
+static void on_encrypt_change(void *pData){
+	evt_encrypt_change *evt = pData;
+	conn_t *conn = conn_find(evt->handle);
+
+	if(conn != NULL && evt->status == 0)
+		conn->encrypted = evt->encrypt != 0;
+}
+
+/*
+ * @brief Number of completed packets: give the credits back to the links
+ */
+static void on_num_comp_pkts(void *pData){
+	evt_num_comp_pkts *evt = pData;
+	evt_num_comp_pkts_param *param = (void *)((uint8_t *)pData + EVT_NUM_COMP_PKTS_SIZE);
+	uint16_t credits;
+	conn_t *conn;
+	uint8_t i;
+
+	for(i = 0; i < evt->num_hndl; i++, param++){
+		conn = conn_find(param->hndl);
+		if(conn == NULL)
+			continue;
+		credits = conn->tx_credits + param->num_comp_pkts;
+		conn->tx_credits = credits < link_tx_credits ? credits : link_tx_credits;
+		conn->credit_tick = HAL_GetTick();
+	}
+}
+
+/*
+ * @brief Give all the credits back to every link
+ */
+static void refill_credits(void){
+	uint8_t i;
+
+	for(i = 0; i < BLE_MAX_LINKS; i++){
+		if(links[i].in_use){
+			links[i].tx_credits = link_tx_credits;
+			links[i].credit_tick = HAL_GetTick();
+		}
+	}
+}
+
+/*
+ * @brief The controller TX pool has room again: the packets of every link
+ * 			left the controller, give all the credits back
+ */
+static void on_tx_pool_available(void *pData){
+	refill_credits();
+}
+
+/*
+ * @brief The controller dropped events: the credits of lost completed
+ * 			packets events would never come back
+ */
+static void on_events_lost(void *pData){
+	evt_hal_events_lost_IDB05A1 *evt = pData;
+
+	if(evt->lost_events[EVT_NUM_COMP_PKTS_BIT / 8] & (1U << (EVT_NUM_COMP_PKTS_BIT % 8)))
+		refill_credits();
+}
+
+/*
+ * @brief Server confirmation: the peer acknowledged the indication
+ */
+static void on_server_confirmation(void *pData){
+	evt_gatt_server_confirmation *evt = pData;
+	conn_t *conn = conn_find(evt->conn_handle);
+
+	if(conn != NULL)
+		conn->indication_pending = 0;
+}
+
+/*
+ * @brief MTU exchange completed, whichever side started it
+ */
+static void on_exchange_mtu_resp(void *pData){
+	evt_att_exchange_mtu_resp *evt = pData;
+	conn_t *conn = conn_find(evt->conn_handle);
+	uint16_t mtu = evt->server_rx_mtu;
+
+	if(conn == NULL)
+		return;
+	if(mtu > BLE_ATT_MTU_MAX)
+		mtu = BLE_ATT_MTU_MAX;
+	if(mtu < CONN_ATT_DEFAULT_MTU)
+		mtu = CONN_ATT_DEFAULT_MTU;
+	conn->mtu = mtu;
+}
+
+/*
+ * @brief Empty the table and subscribe to the connection events. Must be
+ * 			called before the application subscribes to the same events.
+ */
+void conn_table_init(void){
+	static evt_subscription_t conn_sub, update_sub, disconn_sub, confirm_sub, mtu_sub, comp_sub, pool_sub, encrypt_sub, lost_sub;
+
+	memset(links, 0, sizeof(links));
+	memset(notify_links, 0, sizeof(notify_links));
+	memset(indicate_links, 0, sizeof(indicate_links));
+	links_in_use = 0;
+
+	evt_dispatch_subscribe(&conn_sub, EVT_DISPATCH_LE, EVT_LE_CONN_COMPLETE, on_le_connection_complete);
+	evt_dispatch_subscribe(&update_sub, EVT_DISPATCH_LE, EVT_LE_CONN_UPDATE_COMPLETE, on_le_connection_update_complete);
+	evt_dispatch_subscribe(&disconn_sub, EVT_DISPATCH_HCI, EVT_DISCONN_COMPLETE, on_disconnection_complete);
+	evt_dispatch_subscribe(&confirm_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_GATT_SERVER_CONFIRMATION_EVENT, on_server_confirmation);
+	evt_dispatch_subscribe(&mtu_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_ATT_EXCHANGE_MTU_RESP, on_exchange_mtu_resp);
+	evt_dispatch_subscribe(&comp_sub, EVT_DISPATCH_HCI, EVT_NUM_COMP_PKTS, on_num_comp_pkts);
+	evt_dispatch_subscribe(&encrypt_sub, EVT_DISPATCH_HCI, EVT_ENCRYPT_CHANGE, on_encrypt_change);
+	evt_dispatch_subscribe(&lost_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_HAL_EVENTS_LOST_IDB05A1, on_events_lost);
+	evt_dispatch_subscribe(&pool_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_GATT_TX_POOL_AVAILABLE, on_tx_pool_available);
+}
+
+/*
+ * @brief Find a link by connection handle
+ * @param handle Connection handle
+ * @retvalue The link, NULL if the handle is not connected
+ */
+conn_t *conn_find(uint16_t handle){
+	uint8_t i, slot;
+
+	for(i = 0; i < BLE_MAX_LINKS; i++){
+		slot = (home_slot(handle) + i) & (BLE_MAX_LINKS - 1);
+		if(links[slot].in_use && links[slot].handle == handle)
+			return &links[slot];
+	}
+	return NULL;
+}
+
+/*
+ * @brief Get a slot of the table, to iterate over the links
+ * @param index Slot, 0 to BLE_MAX_LINKS - 1
+ * @retvalue The link, NULL if the slot is free
+ */
+conn_t *conn_get(uint8_t index){
+	if(index >= BLE_MAX_LINKS || !links[index].in_use)
+		return NULL;
+	return &links[index];
+}
+
+/*
+ * @brief Number of links in progress
+ */
+uint8_t conn_count(void){
+	return links_in_use;
+}
+
+/*
+ * @brief Number of links that can still be accepted
+ */
+uint8_t conn_free_slots(void){
+	return links_in_use < max_links ? max_links - links_in_use : 0;
+}
+
+/*
+ * @brief Limit the links to what the controller supports
+ * @param links Links the controller accepts, BLE_MAX_LINKS at most
+ * @param acl_pkts ACL buffers of the controller, shared by all the links
+ */
+void conn_set_limits(uint8_t links, uint8_t acl_pkts){
+	max_links = (links != 0 && links < BLE_MAX_LINKS) ? links : BLE_MAX_LINKS;
+	/* Each link gets its share of the buffers, at least one */
+	if(acl_pkts != 0)
+		link_tx_credits = acl_pkts >= max_links ? acl_pkts / max_links : 1;
+}
+
+/*
+ * @brief Record the Client Characteristic Configuration written by a link
+ * @param handle Connection handle
+ * @param char_id Characteristic, 0 to BLE_MAX_SUBSCRIBED_CHARS - 1
+ * @param cccd Value written: CONN_CCCD_NOTIFY and/or CONN_CCCD_INDICATE
+ */
+void conn_set_cccd(uint16_t handle, uint8_t char_id, uint16_t cccd){
+	conn_t *conn = conn_find(handle);
+	conn_mask_t slot_bit;
+
+	if(conn == NULL || char_id >= BLE_MAX_SUBSCRIBED_CHARS)
+		return;
+
+	slot_bit = 1U << (conn - links);
+	if(cccd & CONN_CCCD_NOTIFY){
+		conn->notify |= 1UL << char_id;
+		notify_links[char_id] |= slot_bit;
+	}
+	else{
+		conn->notify &= ~(1UL << char_id);
+		notify_links[char_id] &= ~slot_bit;
+	}
+	if(cccd & CONN_CCCD_INDICATE){
+		conn->indicate |= 1UL << char_id;
+		indicate_links[char_id] |= slot_bit;
+	}
+	else{
+		conn->indicate &= ~(1UL << char_id);
+		indicate_links[char_id] &= ~slot_bit;
+	}
+}
+
+/*
+ * @brief Links subscribed to a characteristic
+ * @param char_id Characteristic
+ * @param type CONN_CCCD_NOTIFY and/or CONN_CCCD_INDICATE
+ * @retvalue One bit per slot of the table, see conn_get()
+ */
+conn_mask_t conn_subscribers(uint8_t char_id, uint16_t type){
+	conn_mask_t mask = 0;
+
+	if(char_id >= BLE_MAX_SUBSCRIBED_CHARS)
+		return 0;
+	if(type & CONN_CCCD_NOTIFY)
+		mask |= notify_links[char_id];
+	if(type & CONN_CCCD_INDICATE)
+		mask |= indicate_links[char_id];
+	return mask;
+}
+
+/*
+ * @brief Call a function for each link subscribed to a characteristic.
+ * 			Only the subscribed links are visited.
+ * @param char_id Characteristic
+ * @param type CONN_CCCD_NOTIFY or CONN_CCCD_INDICATE
+ * @param visit Function called for each subscriber
+ * @param ctx Context passed to the function
+ * @retvalue Number of links visited
+ */
+uint8_t conn_fanout(uint8_t char_id, uint16_t type, conn_visit_t visit, void *ctx){
+	conn_mask_t mask = conn_subscribers(char_id, type);
+	uint8_t count = 0;
+
+	for(; mask != 0; mask &= mask - 1){
+		visit(&links[lowest_bit(mask)], ctx);
+		count++;
+	}
+	return count;
+}
+
+/*
+ * @brief Take a TX credit of a link for a value sent to it
+ */
+void conn_take_credit(conn_t *conn){
+	if(conn->tx_credits > 0)
+		conn->tx_credits--;
+	conn->credit_tick = HAL_GetTick();
+}
+
+/*
+ * @brief Subscribers of a characteristic that cannot take a new value yet:
+ * 			no TX credit left, or an indication not confirmed. A link left
+ * 			without credits for BLE_LINK_CREDIT_TIMEOUT_MS gets them back.
+ * @param char_id Characteristic
+ * @retvalue One bit per slot of the table, 0 if the value can be sent
+ */
+conn_mask_t conn_blocked(uint8_t char_id){
+	conn_mask_t mask = conn_subscribers(char_id, CONN_CCCD_NOTIFY | CONN_CCCD_INDICATE);
+	conn_mask_t indicate = conn_subscribers(char_id, CONN_CCCD_INDICATE);
+	conn_mask_t blocked = 0;
+	conn_mask_t bit;
+	conn_t *conn;
+
+	for(; mask != 0; mask &= mask - 1){
+		bit = mask & -mask;
+		conn = &links[lowest_bit(mask)];
+		if(conn->tx_credits == 0 && HAL_GetTick() - conn->credit_tick >= BLE_LINK_CREDIT_TIMEOUT_MS){
+			conn->tx_credits = link_tx_credits;
+			conn->credit_tick = HAL_GetTick();
+		}
+		if(conn->tx_credits == 0 || ((indicate & bit) && conn->indication_pending))
+			blocked |= bit;
+	}
+	return blocked;
+}
+
+/*
+ * @brief Largest value that reaches every subscriber of a characteristic
+ * 			whole: the controller truncates a value to the MTU of each link
+ * @param char_id Characteristic
+ * @param type CONN_CCCD_NOTIFY and/or CONN_CCCD_INDICATE
+ * @retvalue Smallest payload of the subscribed links, the payload of the
+ * 			default MTU when no link subscribed
+ */
+uint16_t conn_min_payload(uint8_t char_id, uint16_t type){
+	conn_mask_t mask = conn_subscribers(char_id, type);
+	uint16_t mtu = 0;
+	conn_t *conn;
+
+	for(; mask != 0; mask &= mask - 1){
+		conn = &links[lowest_bit(mask)];
+		if(mtu == 0 || conn->mtu < mtu)
+			mtu = conn->mtu;
+	}
+	return (mtu != 0 ? mtu : CONN_ATT_DEFAULT_MTU) - CONN_ATT_HDR_SIZE;
+}
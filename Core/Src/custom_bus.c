@@ -39,6 +39,10 @@ __weak HAL_StatusTypeDef MX_SPI1_Init(SPI_HandleTypeDef* hspi);
   */
 
 SPI_HandleTypeDef hspi1;						
+#if (USE_BUS_SPI1_DMA == 1U)
+DMA_HandleTypeDef hdma_spi1_rx;
+DMA_HandleTypeDef hdma_spi1_tx;
+#endif /* USE_BUS_SPI1_DMA */
 /**
   * @}
   */
@@ -198,6 +202,28 @@ int32_t BSP_SPI1_SendRecv(uint8_t *pTxData, uint8_t *pRxData, uint16_t Length)
   return ret;
 }
 
+#if (USE_BUS_SPI1_DMA == 1U)
+/**
+  * @brief  Start a full duplex DMA transfer on the SPI BUS.
+  *         The end of the transfer is reported through HAL_SPI_TxRxCpltCallback()
+  *         or HAL_SPI_ErrorCallback().
+  * @param  pTxData: Pointer to data buffer to send
+  * @param  pRxData: Pointer to data buffer to receive
+  * @param  Length: Length of data in byte
+  * @retval BSP status
+  */
+int32_t BSP_SPI1_SendRecv_DMA(uint8_t *pTxData, uint8_t *pRxData, uint16_t Length)
+{
+  int32_t ret = BSP_ERROR_NONE;
+  
+  if(HAL_SPI_TransmitReceive_DMA(&hspi1, pTxData, pRxData, Length) != HAL_OK)
+  {
+      ret = BSP_ERROR_BUS_DMA_FAILURE;
+  }
+  return ret;
+}
+#endif /* USE_BUS_SPI1_DMA */
+
 #if (USE_HAL_SPI_REGISTER_CALLBACKS == 1U)  
 /**
   * @brief Register Default BSP SPI1 Bus Msp Callbacks
@@ -315,6 +341,51 @@ static void SPI1_MspInit(SPI_HandleTypeDef* spiHandle)
     GPIO_InitStruct.Alternate = GPIO_AF5_SPI1;
     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
+#if (USE_BUS_SPI1_DMA == 1U)
+    /* SPI1 DMA Init */
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    /* SPI1_RX Init */
+    hdma_spi1_rx.Instance = BUS_SPI1_DMA_RX_INSTANCE;
+    hdma_spi1_rx.Init.Channel = BUS_SPI1_DMA_RX_CHANNEL;
+    hdma_spi1_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_spi1_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi1_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_spi1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_spi1_rx.Init.Mode = DMA_NORMAL;
+    hdma_spi1_rx.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_spi1_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&hdma_spi1_rx) == HAL_OK)
+    {
+      __HAL_LINKDMA(spiHandle, hdmarx, hdma_spi1_rx);
+    }
+
+    /* SPI1_TX Init */
+    hdma_spi1_tx.Instance = BUS_SPI1_DMA_TX_INSTANCE;
+    hdma_spi1_tx.Init.Channel = BUS_SPI1_DMA_TX_CHANNEL;
+    hdma_spi1_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_spi1_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi1_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_spi1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_spi1_tx.Init.Mode = DMA_NORMAL;
+    hdma_spi1_tx.Init.Priority = DMA_PRIORITY_MEDIUM;
+    hdma_spi1_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&hdma_spi1_tx) == HAL_OK)
+    {
+      __HAL_LINKDMA(spiHandle, hdmatx, hdma_spi1_tx);
+    }
+
+    /* DMA and SPI error interrupts */
+    HAL_NVIC_SetPriority(BUS_SPI1_DMA_RX_IRQn, BUS_SPI1_DMA_IT_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(BUS_SPI1_DMA_RX_IRQn);
+    HAL_NVIC_SetPriority(BUS_SPI1_DMA_TX_IRQn, BUS_SPI1_DMA_IT_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(BUS_SPI1_DMA_TX_IRQn);
+    HAL_NVIC_SetPriority(SPI1_IRQn, BUS_SPI1_DMA_IT_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(SPI1_IRQn);
+#endif /* USE_BUS_SPI1_DMA */
+
   /* USER CODE BEGIN SPI1_MspInit 1 */
 
   /* USER CODE END SPI1_MspInit 1 */
@@ -337,6 +408,15 @@ static void SPI1_MspDeInit(SPI_HandleTypeDef* spiHandle)
 
     HAL_GPIO_DeInit(GPIOB, GPIO_PIN_3);
 
+#if (USE_BUS_SPI1_DMA == 1U)
+    /* SPI1 DMA DeInit */
+    HAL_DMA_DeInit(spiHandle->hdmarx);
+    HAL_DMA_DeInit(spiHandle->hdmatx);
+    HAL_NVIC_DisableIRQ(BUS_SPI1_DMA_RX_IRQn);
+    HAL_NVIC_DisableIRQ(BUS_SPI1_DMA_TX_IRQn);
+    HAL_NVIC_DisableIRQ(SPI1_IRQn);
+#endif /* USE_BUS_SPI1_DMA */
+
   /* USER CODE BEGIN SPI1_MspDeInit 1 */
 
   /* USER CODE END SPI1_MspDeInit 1 */
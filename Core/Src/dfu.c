@@ -0,0 +1,491 @@
+/*
+ * dfu.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  The writes of the client are appended to one of two RAM buffers of
+ *  DFU_BUF_SIZE bytes. A full buffer is programmed to the slot from the
+ *  main loop (dfu_process()) while the next writes fill the other one; a
+ *  buffer filled while the other still waits programs that one at once.
+ *  The client is
+ *  acknowledged with one notification every DFU_ACK_BYTES programmed,
+ *  not per write.
+ *
+ *  Only a bonded peer on an encrypted link may start, abort or apply an
+ *  update, and only an image whose HMAC-SHA256 with BLE_DFU_KEY matches
+ *  the one announced by START gets the header that installs it: the CRC
+ *  proves the image arrived whole, the MAC who built it.
+ *
+ *  The flash has a single bank: the CPU waits while a sector is erased,
+ *  so the whole slot needed is erased at the start, before streaming.
+ *  The copy of dfu_boot() runs from sector 0, which it never erases. The
+ *  header stays pending until the copy is complete, so a reset during the
+ *  copy starts it again from the slot, which is left untouched.
+ */
+
+#include "dfu.h"
+#include "main.h"
+#include "conn_table.h"
+#include "hci_const.h"
+#include "bluenrg_gap_aci.h"
+
+#include <string.h>
+
+#if BLE_DFU_ENABLE
+#if !defined(BLE_DFU_KEY) || !defined(BLE_DFU_PASSKEY)
+#error "BLE_DFU_ENABLE needs the BLE_DFU_PASSKEY and BLE_DFU_KEY of the product, see bluenrg_conf.h"
+#endif
+static const uint8_t dfu_key[SHA256_DIGEST_SIZE] = BLE_DFU_KEY;
+#endif
+
+#define DFU_SLOT_HEADER       ((volatile const dfu_header_t *)DFU_SLOT_ADDR)
+#define DFU_SLOT_IMAGE        (DFU_SLOT_ADDR + sizeof(dfu_header_t))
+
+/* RAM of the STM32F401RE, for the check of the initial stack pointer */
+#define DFU_RAM_START         0x20000000UL
+#define DFU_RAM_END           0x20018000UL
+
+static struct {
+	uint8_t state;					/* DFU_IDLE, DFU_RECEIVING or DFU_COMPLETE */
+	uint16_t conn_handle;			/* Link of the client of the update */
+	uint32_t size;					/* Size announced */
+	uint32_t crc;					/* CRC announced */
+	uint8_t mac[SHA256_DIGEST_SIZE];	/* HMAC-SHA256 announced */
+	uint32_t received;				/* Bytes received */
+	uint32_t programmed;			/* Bytes programmed in the slot */
+	uint32_t next_ack;				/* Bytes programmed at the next progress notification */
+	uint8_t fill;					/* Buffer being filled */
+	uint16_t fill_len;				/* Bytes in the buffer being filled */
+	uint8_t full[2];				/* Buffer waiting to be programmed */
+	uint16_t full_len[2];
+	uint32_t buf[2][DFU_BUF_SIZE / 4];
+} dfu;
+
+static notify_queue_t *queue;
+static dfu_stats_t stats;
+
+/*
+ * @brief Notify the client of the update
+ * @param evt DFU_EVT_*
+ * @param status DFU_OK or DFU_ERR_*
+ */
+static void dfu_notify(uint8_t evt, uint8_t status){
+	uint8_t value[DFU_EVT_LEN];
+
+	value[0] = evt;
+	value[1] = status;
+	value[2] = dfu.programmed;
+	value[3] = dfu.programmed >> 8;
+	value[4] = dfu.programmed >> 16;
+	value[5] = dfu.programmed >> 24;
+	if(queue != NULL && notify_queue_push(queue, value, sizeof(value)) == 0)
+		stats.notifications++;
+}
+
+/*
+ * @brief CRC of words with the CRC unit
+ * @param data Words, 4-byte aligned
+ * @param words Number of words
+ * @retvalue CRC-32 (0x04C11DB7, initial value 0xFFFFFFFF)
+ */
+uint32_t dfu_crc(const uint32_t *data, uint32_t words){
+	__HAL_RCC_CRC_CLK_ENABLE();
+	CRC->CR = CRC_CR_RESET;
+	while(words--)
+		CRC->DR = *data++;
+	return CRC->DR;
+}
+
+/*
+ * @brief Erase the sectors of the slot that hold the header and an image
+ * @param size Size of the image
+ * @retvalue 0 on success, -1 on failure
+ */
+static int dfu_erase_slot(uint32_t size){
+	FLASH_EraseInitTypeDef erase = {0};
+	uint32_t sector_error;
+	HAL_StatusTypeDef status;
+
+	erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+	erase.Sector = DFU_SLOT_SECTOR;
+	erase.NbSectors = (sizeof(dfu_header_t) + size + DFU_SECTOR_SIZE - 1) / DFU_SECTOR_SIZE;
+	erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+	HAL_FLASH_Unlock();
+	status = HAL_FLASHEx_Erase(&erase, &sector_error);
+	HAL_FLASH_Lock();
+	return (status == HAL_OK) ? 0 : -1;
+}
+
+/*
+ * @brief Program words to the flash
+ * @param address Address, 4-byte aligned
+ * @param words Words to program
+ * @param count Number of words
+ * @retvalue 0 on success, -1 on failure
+ */
+static int dfu_program(uint32_t address, const uint32_t *words, uint32_t count){
+	HAL_StatusTypeDef status = HAL_OK;
+
+	HAL_FLASH_Unlock();
+	while(count-- && status == HAL_OK){
+		status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, *words++);
+		address += 4;
+	}
+	HAL_FLASH_Lock();
+	return (status == HAL_OK) ? 0 : -1;
+}
+
+/*
+ * @brief End of the update
+ * @param status DFU_OK or the error
+ */
+static void dfu_finish(uint8_t status){
+	stats.status = status;
+	stats.total_ms = HAL_GetTick() - stats.start_tick;
+	dfu.state = (status == DFU_OK) ? DFU_COMPLETE : DFU_IDLE;
+	dfu_notify(DFU_EVT_DONE, status);
+}
+
+/*
+ * @brief Check the HMAC-SHA256 of the image programmed in the slot
+ * @retvalue 1 if it is the one announced, 0 otherwise or without BLE_DFU_KEY
+ */
+static uint8_t dfu_mac_ok(void){
+#if BLE_DFU_ENABLE
+	uint8_t mac[SHA256_DIGEST_SIZE];
+	uint8_t diff = 0, i;
+	uint32_t tick = HAL_GetTick();
+
+	hmac_sha256(dfu_key, sizeof(dfu_key), (const uint8_t *)DFU_SLOT_IMAGE, dfu.size, mac);
+	stats.mac_ms = HAL_GetTick() - tick;
+	/* Every byte is compared: the time does not tell how many match */
+	for(i = 0; i < SHA256_DIGEST_SIZE; i++)
+		diff |= mac[i] ^ dfu.mac[i];
+	return diff == 0;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * @brief Check the image programmed in the slot, then write the header
+ * 			that lets dfu_boot() install it
+ */
+static void dfu_check(void){
+	const uint32_t *image = (const uint32_t *)DFU_SLOT_IMAGE;
+	uint32_t header[4];
+
+	if(dfu_crc(image, (dfu.size + 3) / 4) != dfu.crc){
+		dfu_finish(DFU_ERR_CRC);
+		return;
+	}
+	/* Vector table: initial stack pointer in RAM, reset handler in the application */
+	if(image[0] < DFU_RAM_START || image[0] > DFU_RAM_END ||
+			image[1] < DFU_APP_ADDR || image[1] >= DFU_APP_ADDR + dfu.size){
+		dfu_finish(DFU_ERR_IMAGE);
+		return;
+	}
+	if(!dfu_mac_ok()){
+		dfu_finish(DFU_ERR_MAC);
+		return;
+	}
+
+	/* The state word stays erased: DFU_STATE_PENDING */
+	header[0] = DFU_MAGIC;
+	header[1] = dfu.size;
+	header[2] = dfu.crc;
+	if(dfu_program(DFU_SLOT_ADDR, header, 3) < 0){
+		dfu_finish(DFU_ERR_FLASH);
+		return;
+	}
+	dfu_finish(DFU_OK);
+}
+
+/*
+ * @brief Program the full buffer, the one not being filled
+ * @retvalue 1 if a buffer was programmed, else 0
+ */
+static uint8_t dfu_program_buffer(void){
+	uint8_t b = dfu.fill ^ 1;
+	uint32_t tick, words;
+
+	if(!dfu.full[b])
+		return 0;
+
+	/* The last buffer is padded with erased bytes to whole words */
+	words = (dfu.full_len[b] + 3) / 4;
+	memset((uint8_t *)dfu.buf[b] + dfu.full_len[b], 0xFF, words * 4 - dfu.full_len[b]);
+
+	tick = HAL_GetTick();
+	if(dfu_program(DFU_SLOT_IMAGE + dfu.programmed, dfu.buf[b], words) < 0){
+		dfu.full[b] = 0;
+		dfu_finish(DFU_ERR_FLASH);
+		return 1;
+	}
+	stats.program_ms += HAL_GetTick() - tick;
+	stats.buffers++;
+	dfu.programmed += dfu.full_len[b];
+	dfu.full[b] = 0;
+
+	if(dfu.programmed == dfu.size){
+		dfu_check();
+	}
+	else if(dfu.programmed >= dfu.next_ack){
+		dfu.next_ack = dfu.programmed + DFU_ACK_BYTES;
+		dfu_notify(DFU_EVT_PROGRESS, DFU_OK);
+	}
+	return 1;
+}
+
+/*
+ * @brief Hand the buffer being filled to dfu_process() and fill the other
+ * 			one, which must be free
+ */
+static void dfu_swap_buffers(void){
+	dfu.full[dfu.fill] = 1;
+	dfu.full_len[dfu.fill] = dfu.fill_len;
+	dfu.fill ^= 1;
+	dfu.fill_len = 0;
+}
+
+/*
+ * @brief Start an update: erase the slot. Blocks while the sectors are
+ * 			erased, the events wait in the controller.
+ */
+static void dfu_start(uint16_t conn_handle, uint32_t size, uint32_t crc, const uint8_t mac[SHA256_DIGEST_SIZE]){
+	memset(&stats, 0, sizeof(stats));
+	stats.start_tick = HAL_GetTick();
+	dfu.state = DFU_IDLE;
+	dfu.received = 0;
+	dfu.programmed = 0;
+	dfu.next_ack = DFU_ACK_BYTES;
+	dfu.fill = 0;
+	dfu.fill_len = 0;
+	dfu.full[0] = dfu.full[1] = 0;
+
+	if(size == 0 || size > DFU_IMAGE_MAX){
+		stats.status = DFU_ERR_PARAM;
+		dfu_notify(DFU_EVT_READY, DFU_ERR_PARAM);
+		return;
+	}
+	if(dfu_erase_slot(size) < 0){
+		stats.status = DFU_ERR_FLASH;
+		dfu_notify(DFU_EVT_READY, DFU_ERR_FLASH);
+		return;
+	}
+	stats.erase_ms = HAL_GetTick() - stats.start_tick;
+
+	dfu.conn_handle = conn_handle;
+	dfu.size = size;
+	dfu.crc = crc;
+	memcpy(dfu.mac, mac, SHA256_DIGEST_SIZE);
+	dfu.state = DFU_RECEIVING;
+	dfu_notify(DFU_EVT_READY, DFU_OK);
+}
+
+/*
+ * @brief Attach the notification queue of the control point, an update in
+ * 			progress is dropped
+ * @param q Queue registered on the control point characteristic
+ */
+void dfu_init(notify_queue_t *q){
+	queue = q;
+	if(dfu.state == DFU_RECEIVING)
+		dfu.state = DFU_IDLE;
+}
+
+/*
+ * @brief Check that the peer of a link may drive an update: the link is
+ * 			encrypted and the peer bonded. The permissions of the
+ * 			characteristics already require an authenticated link.
+ */
+static uint8_t dfu_link_trusted(uint16_t conn_handle){
+	conn_t *conn = conn_find(conn_handle);
+
+	if(conn == NULL || !conn->encrypted)
+		return 0;
+	return aci_gap_is_device_bonded(conn->peer_addr_type, conn->peer_addr) == BLE_STATUS_SUCCESS;
+}
+
+/*
+ * @brief Write handler of the control point characteristic
+ */
+void dfu_control_write(uint16_t conn_handle, uint16_t len, uint8_t data[]){
+	if(len < 1)
+		return;
+
+	if(!dfu_link_trusted(conn_handle)){
+		dfu_notify(data[0] == DFU_OP_START ? DFU_EVT_READY : DFU_EVT_DONE, DFU_ERR_AUTH);
+		return;
+	}
+
+	switch(data[0]){
+		case DFU_OP_START:
+			/* A prepared write would only bring the first fragment */
+			if(conn_find(conn_handle)->mtu < DFU_START_MTU){
+				dfu_notify(DFU_EVT_READY, DFU_ERR_MTU);
+				return;
+			}
+			if(len < DFU_START_LEN){
+				dfu_notify(DFU_EVT_READY, DFU_ERR_PARAM);
+				return;
+			}
+			dfu_start(conn_handle,
+					data[1] | data[2] << 8 | data[3] << 16 | (uint32_t)data[4] << 24,
+					data[5] | data[6] << 8 | data[7] << 16 | (uint32_t)data[8] << 24,
+					&data[9]);
+			break;
+		case DFU_OP_ABORT:
+			if(dfu.state == DFU_RECEIVING)
+				dfu_finish(DFU_ERR_STATE);
+			break;
+		case DFU_OP_APPLY:
+			if(dfu.state != DFU_COMPLETE){
+				dfu_notify(DFU_EVT_DONE, DFU_ERR_STATE);
+				return;
+			}
+			NVIC_SystemReset();
+			break;
+	}
+}
+
+/*
+ * @brief Write handler of the data characteristic: the next bytes of the image
+ */
+void dfu_data_write(uint16_t conn_handle, uint16_t len, uint8_t data[]){
+	uint16_t n;
+
+	if(dfu.state != DFU_RECEIVING || conn_handle != dfu.conn_handle)
+		return;
+	if(dfu.received + len > dfu.size){
+		dfu_finish(DFU_ERR_OVERFLOW);
+		return;
+	}
+	stats.chunks++;
+	stats.bytes += len;
+	dfu.received += len;
+
+	while(len > 0 && dfu.state == DFU_RECEIVING){
+		n = DFU_BUF_SIZE - dfu.fill_len;
+		if(n > len)
+			n = len;
+		memcpy((uint8_t *)dfu.buf[dfu.fill] + dfu.fill_len, data, n);
+		dfu.fill_len += n;
+		data += n;
+		len -= n;
+		if(dfu.fill_len == DFU_BUF_SIZE || (len == 0 && dfu.received == dfu.size)){
+			/* The other buffer is still waiting: program it now */
+			if(dfu.full[dfu.fill ^ 1]){
+				stats.stalls++;
+				dfu_program_buffer();
+			}
+			dfu_swap_buffers();
+		}
+	}
+}
+
+/*
+ * @brief Program the buffer filled, from the main loop
+ */
+void dfu_process(void){
+	if(dfu.state == DFU_RECEIVING)
+		dfu_program_buffer();
+}
+
+uint8_t dfu_get_state(void){
+	return dfu.state;
+}
+
+void dfu_get_stats(dfu_stats_t *s){
+	*s = stats;
+}
+
+/*
+ * Boot stage: the reset vector of sector 0 runs dfu_boot(), before the
+ * startup code of the application. It and what it calls stay in the .boot
+ * section: the application may be half written. Nothing is initialized,
+ * no .data or .bss, the core runs on the HSI and the interrupts are off.
+ */
+extern uint32_t _estack;
+
+__attribute__((section(".boot_vector"), used)) static const void * const dfu_boot_vector[2] = {
+	&_estack,
+	(const void *)dfu_boot,
+};
+
+/*
+ * @brief Copy the slot over the application, sectors 1 to 5. The state of
+ * 			the header is only cleared once the whole image is copied.
+ * @param size Size of the image
+ */
+__attribute__((section(".boot"), noinline)) static void dfu_install(uint32_t size){
+	volatile uint32_t *dst = (volatile uint32_t *)DFU_APP_ADDR;
+	const uint32_t *src = (const uint32_t *)DFU_SLOT_IMAGE;
+	uint32_t words = (size + 3) / 4;
+	uint32_t sector, sector_end, i;
+
+	FLASH->KEYR = FLASH_KEY1;
+	FLASH->KEYR = FLASH_KEY2;
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_SOP | FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR;
+
+	/* Sectors 1 to 3: 16 KB, 4: 64 KB, 5: 128 KB */
+	for(sector = DFU_APP_SECTOR; ; sector++){
+		while(FLASH->SR & FLASH_SR_BSY);
+		FLASH->CR = FLASH_PSIZE_WORD | (sector << FLASH_CR_SNB_Pos) | FLASH_CR_SER;
+		FLASH->CR |= FLASH_CR_STRT;
+		while(FLASH->SR & FLASH_SR_BSY);
+		sector_end = (sector < 4) ? FLASH_BASE + (sector + 1) * 0x4000UL :
+				(sector == 4) ? FLASH_BASE + 0x20000UL : FLASH_BASE + 0x40000UL;
+		if(sector_end >= DFU_APP_ADDR + size || sector == 5)
+			break;
+	}
+
+	FLASH->CR = FLASH_PSIZE_WORD | FLASH_CR_PG;
+	for(i = 0; i < words; i++){
+		dst[i] = src[i];
+		while(FLASH->SR & FLASH_SR_BSY);
+	}
+	/* Installed: not copied again at the next reset */
+	*(volatile uint32_t *)&DFU_SLOT_HEADER->state = DFU_STATE_INSTALLED;
+	while(FLASH->SR & FLASH_SR_BSY);
+	FLASH->CR = FLASH_CR_LOCK;
+}
+
+/*
+ * @brief Reset handler of the boot stage: install the image of the slot if
+ * 			one is complete and not installed yet, then start the application
+ */
+__attribute__((section(".boot"), noreturn)) void dfu_boot(void){
+	volatile const dfu_header_t *header = DFU_SLOT_HEADER;
+	const uint32_t *image = (const uint32_t *)DFU_SLOT_IMAGE;
+	const volatile uint32_t *app = (const volatile uint32_t *)DFU_APP_ADDR;
+	uint32_t size = header->size;
+	uint32_t words, sp, pc;
+
+	__disable_irq();
+	if(header->magic == DFU_MAGIC && header->state == DFU_STATE_PENDING &&
+			size != 0 && size <= DFU_IMAGE_MAX){
+		/* The CRC of dfu_crc(), which is in the application: the
+		 * application is only erased for an image that is still intact */
+		RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+		(void)RCC->AHB1ENR;
+		CRC->CR = CRC_CR_RESET;
+		for(words = (size + 3) / 4; words > 0; words--)
+			CRC->DR = *image++;
+		if(CRC->DR == header->crc)
+			dfu_install(size);
+		RCC->AHB1ENR &= ~RCC_AHB1ENR_CRCEN;
+	}
+
+	/* No application: wait for a debugger */
+	sp = app[0];
+	pc = app[1];
+	if(sp < DFU_RAM_START || sp > DFU_RAM_END)
+		for(;;);
+
+	SCB->VTOR = DFU_APP_ADDR;
+	__enable_irq();
+	__asm volatile("msr msp, %0\n\tbx %1" : : "r" (sp), "r" (pc));
+	for(;;);
+}
@@ -0,0 +1,174 @@
+/*
+ * event_dispatch.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Registered as the UserEvtRx callback of the HCI layer (hci_init()).
+ *  Each event is looked up in the table of its kind, then delivered to
+ *  the handlers subscribed to its code.
+ */
+
+#include "event_dispatch.h"
+#include "hci_const.h"
+#include "bluenrg_aci_const.h"
+
+#include <stddef.h>
+
+static evt_subscription_t *hci_table[EVT_DISPATCH_HCI_CODES];
+static evt_subscription_t *le_table[EVT_DISPATCH_LE_CODES];
+static evt_subscription_t *vendor_table[EVT_DISPATCH_VENDOR_GROUPS][EVT_DISPATCH_VENDOR_CODES];
+
+static uint32_t generation;
+static uint32_t unhandled;
+
+/*
+ * @brief Find the table entry of a code
+ * @param kind EVT_DISPATCH_HCI, EVT_DISPATCH_LE or EVT_DISPATCH_VENDOR
+ * @param code Event code of that kind
+ * @retvalue Pointer to the head of the handlers of the code, NULL if the
+ * 			code does not fit in the tables
+ */
+static evt_subscription_t **table_entry(uint8_t kind, uint16_t code){
+	switch(kind){
+		case EVT_DISPATCH_HCI:
+			/* LE meta and vendor events are dispatched on their own codes */
+			if(code >= EVT_DISPATCH_HCI_CODES || code == EVT_LE_META_EVENT)
+				return NULL;
+			return &hci_table[code];
+		case EVT_DISPATCH_LE:
+			if(code >= EVT_DISPATCH_LE_CODES)
+				return NULL;
+			return &le_table[code];
+		case EVT_DISPATCH_VENDOR:
+			if((code >> 10) >= EVT_DISPATCH_VENDOR_GROUPS || (code & 0x3FF) >= EVT_DISPATCH_VENDOR_CODES)
+				return NULL;
+			return &vendor_table[code >> 10][code & 0x3FF];
+	}
+	return NULL;
+}
+
+/*
+ * @brief Subscribe a handler to an event. Several handlers may subscribe to
+ * 			the same code, they are called in subscription order.
+ * @param sub Subscription, must stay valid until evt_dispatch_unsubscribe()
+ * @param kind EVT_DISPATCH_HCI, EVT_DISPATCH_LE or EVT_DISPATCH_VENDOR
+ * @param code Event code of that kind
+ * @param handler Handler of the event
+ * @retvalue 0 on success, -1 if the code is not supported
+ */
+int evt_dispatch_subscribe(evt_subscription_t *sub, uint8_t kind, uint16_t code, evt_handler_t handler){
+	evt_subscription_t **entry = table_entry(kind, code);
+
+	if(entry == NULL || handler == NULL)
+		return -1;
+
+	sub->handler = handler;
+	sub->calls = 0;
+	sub->kind = kind;
+	sub->code = code;
+	sub->next = NULL;
+
+	while(*entry != NULL)
+		entry = &(*entry)->next;
+	*entry = sub;
+
+	generation++;
+	return 0;
+}
+
+/*
+ * @brief Remove a handler subscribed with evt_dispatch_subscribe()
+ * @param sub Subscription
+ */
+void evt_dispatch_unsubscribe(evt_subscription_t *sub){
+	evt_subscription_t **entry = table_entry(sub->kind, sub->code);
+
+	if(entry == NULL)
+		return;
+
+	while(*entry != NULL){
+		if(*entry == sub){
+			*entry = sub->next;
+			sub->next = NULL;
+			generation++;
+			return;
+		}
+		entry = &(*entry)->next;
+	}
+}
+
+/*
+ * @brief Check whether an event has at least one handler
+ * @param kind EVT_DISPATCH_HCI, EVT_DISPATCH_LE or EVT_DISPATCH_VENDOR
+ * @param code Event code of that kind
+ * @retvalue 1 if subscribed, else 0
+ */
+uint8_t evt_dispatch_is_subscribed(uint8_t kind, uint16_t code){
+	evt_subscription_t **entry = table_entry(kind, code);
+
+	return (entry != NULL && *entry != NULL);
+}
+
+/*
+ * @brief Counter incremented on every subscription change, to detect
+ * 			that the events listened to have changed
+ */
+uint32_t evt_dispatch_generation(void){
+	return generation;
+}
+
+/*
+ * @brief Number of events received with no handler subscribed
+ */
+uint32_t evt_dispatch_unhandled(void){
+	return unhandled;
+}
+
+/*
+ * @brief Call the handlers of an event
+ * @param sub First handler, may be NULL
+ * @param data Parameters of the event
+ */
+static void deliver(evt_subscription_t *sub, void *data){
+	if(sub == NULL){
+		unhandled++;
+		return;
+	}
+	for(; sub != NULL; sub = sub->next){
+		sub->calls++;
+		sub->handler(data);
+	}
+}
+
+/*
+ * @brief UserEvtRx callback of the HCI layer: dispatch an event received
+ * 			from the BlueNRG to its handlers
+ * @param pData HCI packet, starting with the packet type
+ */
+void evt_dispatch(void *pData){
+	hci_uart_pckt *hci_pkt = pData;
+	hci_event_pckt *hci_evt_pkt = (void *)hci_pkt->data;
+	evt_le_meta_event *meta_evt;
+	evt_blue_aci *vendor_evt;
+	evt_subscription_t **entry;
+
+	if(hci_pkt->type != HCI_EVENT_PKT)
+		return;
+
+	switch(hci_evt_pkt->evt){
+		case EVT_LE_META_EVENT:
+			meta_evt = (void *)hci_evt_pkt->data;
+			entry = table_entry(EVT_DISPATCH_LE, meta_evt->subevent);
+			deliver(entry ? *entry : NULL, meta_evt->data);
+			break;
+		case EVT_VENDOR:
+			vendor_evt = (void *)hci_evt_pkt->data;
+			entry = table_entry(EVT_DISPATCH_VENDOR, vendor_evt->ecode);
+			deliver(entry ? *entry : NULL, vendor_evt->data);
+			break;
+		default:
+			entry = table_entry(EVT_DISPATCH_HCI, hci_evt_pkt->evt);
+			deliver(entry ? *entry : NULL, hci_evt_pkt->data);
+			break;
+	}
+}
@@ -0,0 +1,201 @@
+/*
+ * event_mask.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  The masks are computed from the subscriptions of event_dispatch.c and
+ *  sent again from the main loop whenever the subscriptions change. Only
+ *  the masks that differ from the ones programmed are sent.
+ */
+
+#include "event_mask.h"
+#include "event_dispatch.h"
+#include "hci_const.h"
+#include "hci_le.h"
+#include "bluenrg_gap_aci.h"
+#include "bluenrg_gatt_aci.h"
+#include "bluenrg_l2cap_aci.h"
+
+#include <string.h>
+
+/* Vendor event code and its bit in a GAP or GATT mask */
+typedef struct {
+	uint16_t ecode;
+	uint32_t bit;
+} vendor_mask_bit_t;
+
+static const vendor_mask_bit_t gap_mask_bits[] = {
+	{EVT_BLUE_GAP_LIMITED_DISCOVERABLE,			GAP_LIMITED_DISCOVERABLE_EVT_MASK},
+	{EVT_BLUE_GAP_PAIRING_CMPLT,				GAP_PAIRING_CMPLT_EVT_MASK},
+	{EVT_BLUE_GAP_PASS_KEY_REQUEST,				GAP_PASS_KEY_REQUEST_EVT_MASK},
+	{EVT_BLUE_GAP_AUTHORIZATION_REQUEST,		GAP_AUTHORIZATION_REQUEST_EVT_MASK},
+	{EVT_BLUE_GAP_SLAVE_SECURITY_INITIATED,		GAP_SLAVE_SECURITY_INITIATED_EVT_MASK},
+	{EVT_BLUE_GAP_BOND_LOST,					GAP_BOND_LOST_EVT_MASK},
+	{EVT_BLUE_GAP_PROCEDURE_COMPLETE,			GAP_PROCEDURE_COMPLETE_EVT_MASK},
+	{EVT_BLUE_GAP_ADDR_NOT_RESOLVED_IDB05A1,	GAP_ADDR_NOT_RESOLVED_EVT_MASK},
+	{EVT_BLUE_L2CAP_CONN_UPD_RESP,				L2CAP_CONN_UPD_RESP_EVT_MASK},
+	{EVT_BLUE_L2CAP_PROCEDURE_TIMEOUT,			L2CAP_PROCEDURE_TIMEOUT_EVT_MASK},
+};
+
+static const vendor_mask_bit_t gatt_mask_bits[] = {
+	{EVT_BLUE_GATT_ATTRIBUTE_MODIFIED,			GATT_ATTRIBUTE_MODIFIED_EVT_MASK},
+	{EVT_BLUE_GATT_PROCEDURE_TIMEOUT,			GATT_PROCEDURE_TIMEOUT_EVT_MASK},
+	{EVT_BLUE_ATT_EXCHANGE_MTU_RESP,			ATT_EXCHANGE_MTU_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_FIND_INFORMATION_RESP,		ATT_FIND_INFORMATION_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_FIND_BY_TYPE_VAL_RESP,		ATT_FIND_BY_TYPE_VAL_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_READ_BY_TYPE_RESP,			ATT_READ_BY_TYPE_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_READ_RESP,					ATT_READ_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_READ_BLOB_RESP,				ATT_READ_BLOB_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_READ_MULTIPLE_RESP,			ATT_READ_MULTIPLE_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_READ_BY_GROUP_TYPE_RESP,		ATT_READ_BY_GROUP_TYPE_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_PREPARE_WRITE_RESP,			ATT_PREPARE_WRITE_RESP_EVT_MASK},
+	{EVT_BLUE_ATT_EXEC_WRITE_RESP,				ATT_EXEC_WRITE_RESP_EVT_MASK},
+	{EVT_BLUE_GATT_INDICATION,					GATT_INDICATION_EVT_MASK},
+	{EVT_BLUE_GATT_NOTIFICATION,				GATT_NOTIFICATION_EVT_MASK},
+	{EVT_BLUE_GATT_ERROR_RESP,					GATT_ERROR_RESP_EVT_MASK},
+	{EVT_BLUE_GATT_PROCEDURE_COMPLETE,			GATT_PROCEDURE_COMPLETE_EVT_MASK},
+	{EVT_BLUE_GATT_DISC_READ_CHAR_BY_UUID_RESP,	GATT_DISC_READ_CHAR_BY_UUID_RESP_EVT_MASK},
+	{EVT_BLUE_GATT_TX_POOL_AVAILABLE,			GATT_TX_POOL_AVAILABLE_EVT_MASK},
+};
+
+/* Masks of the controller after a reset: every event enabled */
+static const evt_masks_t default_masks = {
+	.hci = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0x00, 0x00},
+	.le = {0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+	.gap = 0xFFFF,
+	.gatt = 0xFFFFFFFF,
+};
+
+static evt_masks_t programmed;
+static uint32_t programmed_generation;
+static uint8_t programmed_valid;
+static uint32_t commands;
+
+/*
+ * @brief Set the bit of an HCI event code or of an LE subevent code
+ */
+static void set_code_bit(uint8_t mask[8], uint8_t code){
+	mask[(code - 1) / 8] |= 1U << ((code - 1) % 8);
+}
+
+/*
+ * @brief Compute the minimal masks for the events subscribed. The events
+ * 			the HCI layer relies on stay enabled: command complete/status
+ * 			cannot be masked, the hardware error aborts hci_send_req().
+ * @param masks Filled with the masks
+ */
+void evt_mask_compute(evt_masks_t *masks){
+	uint16_t code;
+	uint8_t i;
+
+	memset(masks, 0, sizeof(*masks));
+
+	for(code = 1; code < EVT_DISPATCH_HCI_CODES; code++){
+		if(evt_dispatch_is_subscribed(EVT_DISPATCH_HCI, code))
+			set_code_bit(masks->hci, code);
+	}
+	set_code_bit(masks->hci, EVT_HARDWARE_ERROR);
+
+	for(code = 1; code < EVT_DISPATCH_LE_CODES; code++){
+		if(evt_dispatch_is_subscribed(EVT_DISPATCH_LE, code)){
+			set_code_bit(masks->le, code);
+			set_code_bit(masks->hci, EVT_LE_META_EVENT);
+		}
+	}
+
+	for(i = 0; i < sizeof(gap_mask_bits) / sizeof(gap_mask_bits[0]); i++){
+		if(evt_dispatch_is_subscribed(EVT_DISPATCH_VENDOR, gap_mask_bits[i].ecode))
+			masks->gap |= gap_mask_bits[i].bit;
+	}
+
+	for(i = 0; i < sizeof(gatt_mask_bits) / sizeof(gatt_mask_bits[0]); i++){
+		if(evt_dispatch_is_subscribed(EVT_DISPATCH_VENDOR, gatt_mask_bits[i].ecode))
+			masks->gatt |= gatt_mask_bits[i].bit;
+	}
+}
+
+/*
+ * @brief Send the masks that differ from the ones programmed
+ * @param masks Masks to program
+ * @retvalue 0 if all the masks are programmed, else the error of the first failed command
+ */
+static int program(const evt_masks_t *masks){
+	int ret;
+
+	if(memcmp(masks->hci, programmed.hci, sizeof(masks->hci)) != 0){
+		commands++;
+		if((ret = hci_set_event_mask(masks->hci)) != BLE_STATUS_SUCCESS)
+			return ret;
+		memcpy(programmed.hci, masks->hci, sizeof(masks->hci));
+	}
+	if(memcmp(masks->le, programmed.le, sizeof(masks->le)) != 0){
+		commands++;
+		if((ret = hci_le_set_event_mask(masks->le)) != BLE_STATUS_SUCCESS)
+			return ret;
+		memcpy(programmed.le, masks->le, sizeof(masks->le));
+	}
+	if(masks->gap != programmed.gap){
+		commands++;
+		if((ret = aci_gap_set_event_mask(masks->gap)) != BLE_STATUS_SUCCESS)
+			return ret;
+		programmed.gap = masks->gap;
+	}
+	if(masks->gatt != programmed.gatt){
+		commands++;
+		if((ret = aci_gatt_set_event_mask(masks->gatt)) != BLE_STATUS_SUCCESS)
+			return ret;
+		programmed.gatt = masks->gatt;
+	}
+	return 0;
+}
+
+/*
+ * @brief Forget the masks programmed, to be called after hci_reset():
+ * 			the controller is back to its default masks
+ */
+void evt_mask_reset(void){
+	programmed = default_masks;
+	programmed_valid = 0;
+}
+
+/*
+ * @brief Program the minimal masks if the subscriptions changed since the
+ * 			last call. Called from the main loop, not from an event handler
+ * 			that is subscribing.
+ */
+void evt_mask_update(void){
+	evt_masks_t masks;
+	uint32_t generation = evt_dispatch_generation();
+
+	if(programmed_valid && generation == programmed_generation)
+		return;
+
+	evt_mask_compute(&masks);
+	if(program(&masks) == 0){
+		programmed_generation = generation;
+		programmed_valid = 1;
+	}
+}
+
+/*
+ * @brief Enable every event again, e.g. to compare the traffic with the
+ * 			minimal masks. The next evt_mask_update() programs them again.
+ */
+void evt_mask_restore_defaults(void){
+	program(&default_masks);
+	programmed_valid = 0;
+}
+
+/*
+ * @brief Get the masks programmed in the controller
+ */
+void evt_mask_get(evt_masks_t *masks){
+	*masks = programmed;
+}
+
+/*
+ * @brief Number of mask commands sent to the controller
+ */
+uint32_t evt_mask_commands(void){
+	return commands;
+}
@@ -0,0 +1,436 @@
+/*
+ * gatt_db.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  The controller lays out a characteristic as its declaration at the
+ *  handle returned by aci_gatt_add_char(), the value right after it and,
+ *  for a notified or indicated characteristic, the CCCD after the value.
+ *  The descriptors of the table come next, each at the handle returned by
+ *  aci_gatt_add_char_desc(). The services are added one after the other,
+ *  so their handles form one dense range starting at the first service.
+ *
+ *  Once the handle of a service is known, the handles of its attributes
+ *  follow from the table: its characteristics and descriptors are queued
+ *  back to back through the command pipeline (hci_send_cmd_async()), each
+ *  with the handle computed for it, and the returned handles are checked
+ *  against the computed ones.
+ *
+ *  Main loop only: the completions are called from hci_user_evt_proc().
+ */
+
+#include "gatt_db.h"
+#include "hci_tl.h"
+#include "hci_const.h"
+#include "bluenrg_gatt_aci.h"
+#include "bluenrg_gatt_server.h"
+#include "conn_table.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/* Minimum encryption key size of the attributes */
+#define GATT_DB_ENC_KEY_SIZE      16
+
+static gatt_attr_t attrs[GATT_DB_MAX_ATTRS];
+static uint16_t first_handle;
+static uint16_t attr_count;
+
+/* Build in progress, see gatt_db_build() */
+static struct {
+	const gatt_service_def_t *services;	/* NULL when no build is in progress */
+	uint8_t count;
+	uint8_t serv;					/* Cursor of the next command to queue */
+	uint8_t chr;
+	uint8_t desc;
+	uint8_t serv_added;				/* Service of the cursor queued */
+	uint8_t serv_pending;			/* Its handle not known yet */
+	uint8_t char_added;				/* Characteristic of the cursor queued */
+	uint8_t outstanding;			/* Commands queued and not completed */
+	uint16_t next_handle;			/* Handle of the next attribute of the service */
+	tBleStatus status;
+	gatt_db_done_t done;
+} build;
+
+static void build_pump(void);
+
+/*
+ * @brief Check whether the controller adds a CCCD to a characteristic
+ */
+static uint8_t has_cccd(const gatt_char_def_t *chr){
+	return (chr->properties & (CHAR_PROP_NOTIFY | CHAR_PROP_INDICATE)) != 0;
+}
+
+/*
+ * @brief Number of attribute records of a service: its declaration, the
+ * 			declaration and value of each characteristic, their CCCD and
+ * 			their descriptors
+ * @param serv Service
+ * @retvalue Value of max_attr_records for aci_gatt_add_serv()
+ */
+uint8_t gatt_db_attr_records(const gatt_service_def_t *serv){
+	uint8_t i, records = 1;
+
+	for(i = 0; i < serv->char_count; i++)
+		records += 2 + has_cccd(&serv->chars[i]) + serv->chars[i].desc_count;
+	return records;
+}
+
+/*
+ * @brief Map a handle added to the controller in the dispatch array
+ * @retvalue 0 on success, -1 if the handle does not fit in the array
+ */
+static int map_handle(uint16_t handle, uint8_t kind, const gatt_char_def_t *chr){
+	uint16_t index;
+
+	if(handle < first_handle)
+		return -1;
+	index = handle - first_handle;
+	if(index >= GATT_DB_MAX_ATTRS)
+		return -1;
+
+	attrs[index].chr = chr;
+	attrs[index].kind = kind;
+	if(index >= attr_count)
+		attr_count = index + 1;
+	return 0;
+}
+
+/*
+ * @brief Serialize the UUID of a command
+ * @retvalue Number of bytes written
+ */
+static uint8_t put_uuid(uint8_t *buf, uint8_t uuid_type, const uint8_t *uuid){
+	uint8_t uuid_len = (uuid_type == UUID_TYPE_16) ? 2 : 16;
+
+	buf[0] = uuid_type;
+	memcpy(buf + 1, uuid, uuid_len);
+	return 1 + uuid_len;
+}
+
+/*
+ * @brief Serialize a handle of a command
+ */
+static uint8_t put_handle(uint8_t *buf, uint16_t handle){
+	buf[0] = handle & 0xFF;
+	buf[1] = handle >> 8;
+	return 2;
+}
+
+/*
+ * @brief End of the build: the last command completed or failed
+ */
+static void build_finish(void){
+	gatt_db_done_t done = build.done;
+
+	build.done = NULL;
+	build.services = NULL;
+	if(done != NULL)
+		done(build.status);
+}
+
+/*
+ * @brief Account the completion of a command of the build
+ */
+static void build_complete(uint8_t status){
+	build.outstanding--;
+	if(status != BLE_STATUS_SUCCESS && build.status == BLE_STATUS_SUCCESS)
+		build.status = status;
+
+	if(build.outstanding == 0 && (build.status != BLE_STATUS_SUCCESS || build.serv == build.count))
+		build_finish();
+	else
+		build_pump();
+}
+
+/*
+ * @brief Handle returned by a command of the build, 0 if the command failed
+ */
+static uint16_t returned_handle(uint8_t status, const uint8_t *rparam, uint16_t rlen){
+	if(status != BLE_STATUS_SUCCESS || rlen < 3)
+		return 0;
+	return rparam[1] | (rparam[2] << 8);
+}
+
+/*
+ * @brief Completion of aci_gatt_add_serv(): the handles of the service
+ * 			are known, its characteristics can be queued
+ */
+static void on_serv_added(uint16_t opcode, uint8_t status, const uint8_t *rparam, uint16_t rlen, void *ctx){
+	const gatt_service_def_t *serv = ctx;
+	uint16_t handle = returned_handle(status, rparam, rlen);
+
+	if(handle != 0){
+		*serv->handle = handle;
+		if(first_handle == 0)
+			first_handle = handle;
+		if(map_handle(handle, GATT_DB_ATTR_NONE, NULL) < 0)
+			status = BLE_STATUS_INSUFFICIENT_RESOURCES;
+		build.next_handle = handle + 1;
+	}
+	build.serv_pending = 0;
+	build_complete(status);
+}
+
+/*
+ * @brief Completion of aci_gatt_add_char() or aci_gatt_add_char_desc():
+ * 			the controller must have used the handle computed for it
+ */
+static void on_attr_added(uint16_t opcode, uint8_t status, const uint8_t *rparam, uint16_t rlen, void *ctx){
+	uint16_t *handle = ctx;
+
+	if(status == BLE_STATUS_SUCCESS && returned_handle(status, rparam, rlen) != *handle)
+		status = BLE_STATUS_FAILED;
+	build_complete(status);
+}
+
+/*
+ * @brief Queue a command of the build
+ * @retvalue 0 on success, -1 if the command pipeline is full
+ */
+static int build_send(uint16_t ocf, uint8_t *cp, uint8_t len, tHciCmdCallback cb, void *ctx){
+	/* Counted first: a command that cannot be sent completes at once */
+	build.outstanding++;
+	if(hci_send_cmd_async(OGF_VENDOR_CMD, ocf, len, cp, cb, ctx) < 0){
+		build.outstanding--;
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * @brief Queue the next service of the table
+ */
+static int build_serv(const gatt_service_def_t *serv){
+	uint8_t cp[HCI_MAX_CMD_PARAM_SIZE];
+	uint8_t len;
+
+	len = put_uuid(cp, serv->uuid_type, serv->uuid);
+	cp[len++] = PRIMARY_SERVICE;
+	cp[len++] = gatt_db_attr_records(serv);
+	return build_send(OCF_GATT_ADD_SERV, cp, len, on_serv_added, (void *)serv);
+}
+
+/*
+ * @brief Queue a characteristic, with the handles it will be given
+ */
+static int build_char(const gatt_char_def_t *chr){
+	uint8_t cp[HCI_MAX_CMD_PARAM_SIZE];
+	uint8_t len;
+
+	len = put_handle(cp, *build.services[build.serv].handle);
+	len += put_uuid(cp + len, chr->uuid_type, chr->uuid);
+	cp[len++] = chr->value_max;
+	cp[len++] = chr->properties;
+	cp[len++] = chr->permissions;
+	cp[len++] = chr->evt_mask;
+	cp[len++] = GATT_DB_ENC_KEY_SIZE;
+	cp[len++] = chr->is_variable;
+
+	*chr->handle = build.next_handle;
+	if(build_send(OCF_GATT_ADD_CHAR, cp, len, on_attr_added, chr->handle) < 0)
+		return -1;
+
+	if(map_handle(*chr->handle, GATT_DB_ATTR_NONE, chr) < 0 ||
+			map_handle(*chr->handle + 1, GATT_DB_ATTR_VALUE, chr) < 0 ||
+			(has_cccd(chr) && map_handle(*chr->handle + 2, GATT_DB_ATTR_CCCD, chr) < 0))
+		build.status = BLE_STATUS_INSUFFICIENT_RESOURCES;
+	build.next_handle += 2 + has_cccd(chr);
+	return 0;
+}
+
+/*
+ * @brief Queue a descriptor of the last characteristic queued
+ */
+static int build_desc(const gatt_char_def_t *chr, const gatt_desc_def_t *desc){
+	uint8_t cp[HCI_MAX_CMD_PARAM_SIZE];
+	uint8_t len;
+
+	if(desc->value_len + (desc->uuid_type == UUID_TYPE_16 ? 2 : 16) + 12 > HCI_MAX_CMD_PARAM_SIZE){
+		build.status = BLE_STATUS_INVALID_PARAMS;
+		return 0;
+	}
+
+	len = put_handle(cp, *build.services[build.serv].handle);
+	len += put_handle(cp + len, *chr->handle);
+	len += put_uuid(cp + len, desc->uuid_type, desc->uuid);
+	cp[len++] = desc->value_max;
+	cp[len++] = desc->value_len;
+	memcpy(cp + len, desc->value, desc->value_len);
+	len += desc->value_len;
+	cp[len++] = desc->permissions;
+	cp[len++] = desc->access;
+	cp[len++] = desc->evt_mask;
+	cp[len++] = GATT_DB_ENC_KEY_SIZE;
+	cp[len++] = desc->value_len != desc->value_max;
+
+	*desc->handle = build.next_handle;
+	if(build_send(OCF_GATT_ADD_CHAR_DESC, cp, len, on_attr_added, desc->handle) < 0)
+		return -1;
+
+	if(map_handle(*desc->handle, GATT_DB_ATTR_DESC, chr) < 0)
+		build.status = BLE_STATUS_INSUFFICIENT_RESOURCES;
+	build.next_handle++;
+	return 0;
+}
+
+/*
+ * @brief Queue the commands of the build while the command pipeline accepts
+ * 			them. The characteristics and descriptors of a service are
+ * 			queued back to back once the handle of the service is known.
+ */
+static void build_pump(void){
+	const gatt_service_def_t *serv;
+	const gatt_char_def_t *chr;
+
+	/* The cursor is read again after each command: a command that cannot
+	 * be sent completes at once and may end the build */
+	while(build.services != NULL && build.status == BLE_STATUS_SUCCESS &&
+			!build.serv_pending && build.serv < build.count){
+		serv = &build.services[build.serv];
+
+		if(!build.serv_added){
+			if(build_serv(serv) < 0)
+				return;
+			build.serv_added = 1;
+			build.serv_pending = 1;
+			continue;
+		}
+
+		if(build.chr == serv->char_count){
+			/* Next service, its records follow the ones reserved for this one */
+			build.serv++;
+			build.chr = 0;
+			build.desc = 0;
+			build.serv_added = 0;
+			if(build.serv == build.count && build.outstanding == 0)
+				build_finish();
+			continue;
+		}
+
+		chr = &serv->chars[build.chr];
+		if(build.desc == 0 && !build.char_added){
+			if(chr->properties & (CHAR_PROP_BROADCAST | CHAR_PROP_EXT)){
+				/* Their descriptors would move the CCCD */
+				build.status = BLE_STATUS_INVALID_PARAMS;
+				break;
+			}
+			if(build_char(chr) < 0)
+				return;
+			build.char_added = 1;
+		}
+		else if(build.desc < chr->desc_count){
+			if(build_desc(chr, &chr->descs[build.desc]) < 0)
+				return;
+			build.desc++;
+		}
+		if(build.desc == chr->desc_count){
+			build.chr++;
+			build.desc = 0;
+			build.char_added = 0;
+		}
+	}
+
+	if(build.services != NULL && build.status != BLE_STATUS_SUCCESS && build.outstanding == 0)
+		build_finish();
+}
+
+/*
+ * @brief Add the services of a table to the controller, after aci_gatt_init()
+ * 			and aci_gap_init(), and build the dispatch array of their handles.
+ * 			Returns at once: the commands are pipelined and completed from
+ * 			hci_user_evt_proc(). The handles are written through the handle
+ * 			pointers of the table.
+ * @param services Table of the services, must stay valid (usually const)
+ * @param count Number of services
+ * @param done Callback at the end of the build with the status of the first
+ * 			command that failed, BLE_STATUS_INSUFFICIENT_RESOURCES if the
+ * 			handles do not fit in GATT_DB_MAX_ATTRS. May be NULL.
+ * @retvalue 0 on success, -1 if a build is in progress
+ */
+int gatt_db_build(const gatt_service_def_t *services, uint8_t count, gatt_db_done_t done){
+	if(build.services != NULL)
+		return -1;
+
+	memset(attrs, 0, sizeof(attrs));
+	first_handle = 0;
+	attr_count = 0;
+
+	memset(&build, 0, sizeof(build));
+	build.services = services;
+	build.count = count;
+	build.done = done;
+	build.status = BLE_STATUS_SUCCESS;
+
+	build_pump();
+	return 0;
+}
+
+/*
+ * @brief Check whether a build is in progress
+ */
+uint8_t gatt_db_is_building(void){
+	return build.services != NULL;
+}
+
+/*
+ * @brief Find the attribute behind a handle
+ * @param handle Attribute handle
+ * @retvalue Entry of the handle, NULL if not added by gatt_db_build()
+ */
+const gatt_attr_t *gatt_db_find(uint16_t handle){
+	uint16_t index = handle - first_handle;
+
+	if(handle < first_handle || index >= attr_count)
+		return NULL;
+	return &attrs[index];
+}
+
+/*
+ * @brief Dispatch an attribute written by a client: a value to the write
+ * 			handler of its characteristic, a CCCD to the connection table
+ * @param conn_handle Connection of the client
+ * @param handle Attribute handle
+ * @param len Length of the data
+ * @param data Data written
+ */
+void gatt_db_attribute_modified(uint16_t conn_handle, uint16_t handle, uint16_t len, uint8_t data[]){
+	const gatt_attr_t *attr = gatt_db_find(handle);
+
+	if(attr == NULL || len == 0)
+		return;
+
+	switch(attr->kind){
+		case GATT_DB_ATTR_VALUE:
+			if(attr->chr->on_write != NULL)
+				attr->chr->on_write(conn_handle, len, data);
+			break;
+		case GATT_DB_ATTR_CCCD:
+			/* bit0 notifications, bit1 indications */
+			conn_set_cccd(conn_handle, attr->chr->char_id, len > 1 ? data[0] | (data[1] << 8) : data[0]);
+			break;
+	}
+}
+
+/*
+ * @brief Dispatch a read request to the read handler of the characteristic,
+ * 			the caller allows the read afterwards
+ * @param conn_handle Connection of the client
+ * @param handle Attribute handle
+ */
+void gatt_db_read_request(uint16_t conn_handle, uint16_t handle){
+	const gatt_attr_t *attr = gatt_db_find(handle);
+
+	if(attr != NULL && attr->kind == GATT_DB_ATTR_VALUE && attr->chr->on_read != NULL)
+		attr->chr->on_read(conn_handle);
+}
+
+/*
+ * @brief Range of the handles added by gatt_db_build()
+ * @param first Handle of the first service
+ * @param count Number of handles
+ */
+void gatt_db_get_range(uint16_t *first, uint16_t *count){
+	*first = first_handle;
+	*count = attr_count;
+}
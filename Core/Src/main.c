@@ -2,6 +2,7 @@
 #include "usart.h"
 #include "gpio.h"
 #include "app_ble.h"
+#include "ble_bench.h"
 
 void SystemClock_Config(void);
 
@@ -22,6 +23,9 @@ int main(void)
   MX_USART2_UART_Init();
   // 初始化蓝牙
   MX_BlueNRG_MS_Init();
+#if (BLE_BENCH == 1)
+  ble_bench_run();
+#endif
 
 
   while (1)
@@ -0,0 +1,395 @@
+/*
+ * notify_queue.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  notify_process() sends the queued values, one per queue in turn, until
+ *  the queues are empty or the controller answers
+ *  BLE_STATUS_INSUFFICIENT_RESOURCES. The queues then stay parked, with no
+ *  command sent, until EVT_BLUE_GATT_TX_POOL_AVAILABLE (or a disconnection,
+ *  which frees the buffers of the link). A full queue refuses the push, so
+ *  the producer knows to slow down instead of losing values. A queue is
+ *  also held while one of its subscribers has no TX credit left or has not
+ *  confirmed the last indication (conn_blocked()); the other queues go on.
+ *
+ *  Long values go through the asynchronous command pipeline
+ *  (hci_send_cmd_async()): the chunks of the update at the head of the
+ *  list are queued back to back without waiting for their completion.
+ *  The controller runs them in order, so the last chunk, the only one
+ *  that asks for a notification, completes the value. If it finds the TX
+ *  pool full, it is sent again once the pool is available.
+ *
+ *  Main loop only: the queues are pushed and drained from the main loop,
+ *  and the events are dispatched from hci_user_evt_proc().
+ */
+
+#include "notify_queue.h"
+#include "conn_table.h"
+#include "event_dispatch.h"
+#include "hci_const.h"
+#include "bluenrg_aci_const.h"
+#include "bluenrg_gatt_aci.h"
+
+#include <string.h>
+
+static notify_queue_t *queues;
+static notify_long_t *long_head, *long_tail;
+static uint8_t parked;
+static uint32_t queued_bytes;			/* Bytes queued and long value bytes not completed */
+static notify_stats_t stats;
+
+/*
+ * @brief Account a notification sent to a subscribed link
+ */
+static void on_notified(conn_t *conn, void *ctx){
+	conn->notifications++;
+	conn_take_credit(conn);
+}
+
+/*
+ * @brief Account an indication sent to a subscribed link, pending
+ * 			until the peer confirms it
+ */
+static void on_indicated(conn_t *conn, void *ctx){
+	conn->indications++;
+	conn->indication_pending = 1;
+	conn_take_credit(conn);
+}
+
+/*
+ * @brief The controller freed TX buffers: resume the queues
+ */
+static void on_tx_pool_available(void *pData){
+	if(parked){
+		parked = 0;
+		stats.resumes++;
+	}
+}
+
+/*
+ * @brief A link closed and its TX buffers are freed: resume the queues
+ */
+static void on_disconnection_complete(void *pData){
+	parked = 0;
+}
+
+/*
+ * @brief Empty the list of queues and subscribe to the TX pool events
+ */
+void notify_init(void){
+	static evt_subscription_t pool_sub, disconn_sub;
+
+	queues = NULL;
+	long_head = NULL;
+	long_tail = NULL;
+	parked = 0;
+	queued_bytes = 0;
+	memset(&stats, 0, sizeof(stats));
+
+	evt_dispatch_subscribe(&pool_sub, EVT_DISPATCH_VENDOR, EVT_BLUE_GATT_TX_POOL_AVAILABLE, on_tx_pool_available);
+	evt_dispatch_subscribe(&disconn_sub, EVT_DISPATCH_HCI, EVT_DISCONN_COMPLETE, on_disconnection_complete);
+}
+
+/*
+ * @brief Register the queue of a characteristic
+ * @param q Queue, must stay valid
+ * @param serv_handle Handle of the service
+ * @param char_handle Handle of the characteristic
+ * @param char_id Characteristic id of the subscriptions
+ */
+void notify_queue_register(notify_queue_t *q, uint16_t serv_handle, uint16_t char_handle, uint8_t char_id){
+	q->serv_handle = serv_handle;
+	q->char_handle = char_handle;
+	q->char_id = char_id;
+	q->head = 0;
+	q->count = 0;
+	q->next = queues;
+	queues = q;
+}
+
+/*
+ * @brief Queue a value to notify
+ * @param q Queue of the characteristic
+ * @param value Value
+ * @param len Length of the value, notify_queue_payload() at most
+ * @retvalue 0 on success, -1 if the queue is full or the value longer than
+ * 			a subscriber receives
+ */
+int notify_queue_push(notify_queue_t *q, const uint8_t *value, uint8_t len){
+	uint8_t slot;
+
+	if(q->count == NOTIFY_QUEUE_DEPTH || len > notify_queue_payload(q)){
+		stats.rejected++;
+		return -1;
+	}
+
+	slot = (q->head + q->count) % NOTIFY_QUEUE_DEPTH;
+	memcpy(q->value[slot], value, len);
+	q->len[slot] = len;
+	q->count++;
+	queued_bytes += len;
+	return 0;
+}
+
+/*
+ * @brief Number of values that can still be pushed
+ */
+uint8_t notify_queue_space(const notify_queue_t *q){
+	return NOTIFY_QUEUE_DEPTH - q->count;
+}
+
+/*
+ * @brief Largest value the subscribers of the queue receive whole, from
+ * 			the MTU negotiated on their links: the producers size their
+ * 			values with it, notify_queue_push() refuses longer ones
+ */
+uint16_t notify_queue_payload(const notify_queue_t *q){
+	uint16_t payload = conn_min_payload(q->char_id, CONN_CCCD_NOTIFY | CONN_CCCD_INDICATE);
+
+	return payload < NOTIFY_VALUE_MAX ? payload : NOTIFY_VALUE_MAX;
+}
+
+/*
+ * @brief Remove the oldest value of a queue
+ */
+static void pop(notify_queue_t *q){
+	queued_bytes -= q->len[q->head];
+	q->head = (q->head + 1) % NOTIFY_QUEUE_DEPTH;
+	q->count--;
+}
+
+/*
+ * @brief Length of the chunk of a long value starting at an offset
+ */
+static uint8_t chunk_len(const notify_long_t *xfer, uint16_t offset){
+	uint16_t left = xfer->len - offset;
+
+	return left > NOTIFY_LONG_CHUNK_MAX ? NOTIFY_LONG_CHUNK_MAX : left;
+}
+
+static void long_pump(void);
+
+/*
+ * @brief Remove the long value update at the head of the list and call
+ * 			its callback
+ */
+static void long_finish(notify_long_t *xfer){
+	long_head = xfer->next;
+	if(long_head == NULL)
+		long_tail = NULL;
+	xfer->busy = 0;
+	queued_bytes -= xfer->len - xfer->acked;
+
+	if(xfer->status == BLE_STATUS_SUCCESS){
+		stats.long_values++;
+		stats.long_bytes += xfer->len;
+	}
+	else
+		stats.long_errors++;
+
+	if(xfer->done != NULL)
+		xfer->done(xfer, xfer->status);
+}
+
+/*
+ * @brief Completion of a chunk, called from hci_user_evt_proc()
+ */
+static void on_chunk_complete(uint16_t opcode, uint8_t status, const uint8_t *rparam, uint16_t rlen, void *ctx){
+	notify_long_t *xfer = ctx;
+	uint8_t len = chunk_len(xfer, xfer->acked);
+
+	if(status == BLE_STATUS_INSUFFICIENT_RESOURCES && xfer->acked + len == xfer->len){
+		/* Last chunk: send it again when the TX pool is available */
+		xfer->sent = xfer->acked;
+		parked = 1;
+		stats.parks++;
+		return;
+	}
+
+	xfer->acked += len;
+	queued_bytes -= len;
+	stats.long_chunks++;
+	if(status != BLE_STATUS_SUCCESS && xfer->status == BLE_STATUS_SUCCESS)
+		xfer->status = status;
+
+	/* After a failure, wait for the chunks already sent before reporting it */
+	if(xfer->acked == xfer->len || (xfer->status != BLE_STATUS_SUCCESS && xfer->acked == xfer->sent)){
+		long_finish(xfer);
+		long_pump();
+	}
+}
+
+/*
+ * @brief Queue the chunks of the long value update at the head of the list
+ * 			while the command pipeline accepts them
+ */
+static void long_pump(void){
+	notify_long_t *xfer;
+	uint8_t cp[GATT_UPD_CHAR_VAL_EXT_CP_SIZE + NOTIFY_LONG_CHUNK_MAX];
+	gatt_upd_char_val_ext_cp *upd = (void *)cp;
+	uint8_t len, last;
+
+	/* The head is read again after each chunk: a chunk that cannot be
+	 * sent completes at once and may end the update */
+	while((xfer = long_head) != NULL && xfer->status == BLE_STATUS_SUCCESS && xfer->sent < xfer->len){
+		len = chunk_len(xfer, xfer->sent);
+		last = (xfer->sent + len == xfer->len);
+		if(last && parked)
+			return;
+
+		upd->service_handle = htobs(xfer->serv_handle);
+		upd->char_handle = htobs(xfer->char_handle);
+		upd->update_type = last ? xfer->update_type : 0;
+		upd->char_length = htobs(xfer->len);
+		upd->value_offset = htobs(xfer->sent);
+		upd->value_length = len;
+		memcpy(upd->value, xfer->value + xfer->sent, len);
+
+		xfer->sent += len;
+		if(hci_send_cmd_async(OGF_VENDOR_CMD, OCF_GATT_UPD_CHAR_VAL_EXT, GATT_UPD_CHAR_VAL_EXT_CP_SIZE + len,
+				cp, on_chunk_complete, xfer) < 0){
+			xfer->sent -= len;
+			return;
+		}
+	}
+}
+
+/*
+ * @brief Update a long characteristic value, after the updates already
+ * 			waiting. Returns at once, the chunks are sent from the main loop.
+ * @param xfer Update, owned by the caller until its callback
+ * @param serv_handle Handle of the service
+ * @param char_handle Handle of the characteristic
+ * @param update_type NOTIFICATION and/or INDICATION sent with the last chunk,
+ * 			0 to only update the value
+ * @param value Value, must stay valid until the callback
+ * @param len Length of the value, NOTIFY_LONG_VALUE_MAX at most
+ * @param done Callback at the end of the update, may be NULL
+ * @retvalue 0 on success, -1 if the update is in progress or the length invalid
+ */
+int notify_long_update(notify_long_t *xfer, uint16_t serv_handle, uint16_t char_handle, uint8_t update_type,
+		const uint8_t *value, uint16_t len, notify_long_cb_t done){
+	if(xfer->busy || len == 0 || len > NOTIFY_LONG_VALUE_MAX)
+		return -1;
+
+	xfer->serv_handle = serv_handle;
+	xfer->char_handle = char_handle;
+	xfer->update_type = update_type;
+	xfer->busy = 1;
+	xfer->value = value;
+	xfer->len = len;
+	xfer->sent = 0;
+	xfer->acked = 0;
+	xfer->status = BLE_STATUS_SUCCESS;
+	xfer->done = done;
+	xfer->next = NULL;
+
+	if(long_tail != NULL)
+		long_tail->next = xfer;
+	else
+		long_head = xfer;
+	long_tail = xfer;
+	queued_bytes += len;
+
+	long_pump();
+	return 0;
+}
+
+/*
+ * @brief Send the queued values until the controller TX pool is full,
+ * 			called from the main loop. No command is sent while parked.
+ */
+void notify_process(void){
+	notify_queue_t *q;
+	uint8_t sent;
+	tBleStatus ret;
+
+	long_pump();
+
+	do{
+		sent = 0;
+		for(q = queues; q != NULL && !parked; q = q->next){
+			if(q->count == 0)
+				continue;
+
+			if(conn_subscribers(q->char_id, CONN_CCCD_NOTIFY | CONN_CCCD_INDICATE) == 0){
+				stats.dropped += q->count;
+				while(q->count > 0)
+					pop(q);
+				continue;
+			}
+			if(conn_blocked(q->char_id) != 0){
+				stats.held++;
+				continue;
+			}
+
+			ret = aci_gatt_update_char_value(q->serv_handle, q->char_handle, 0,
+					q->len[q->head], q->value[q->head]);
+			if(ret == BLE_STATUS_INSUFFICIENT_RESOURCES){
+				parked = 1;
+				stats.parks++;
+				break;
+			}
+
+			if(ret == BLE_STATUS_SUCCESS){
+				stats.notifications++;
+				stats.bytes += q->len[q->head];
+				conn_fanout(q->char_id, CONN_CCCD_NOTIFY, on_notified, NULL);
+				conn_fanout(q->char_id, CONN_CCCD_INDICATE, on_indicated, NULL);
+			}
+			else
+				stats.errors++;
+			pop(q);
+			sent = 1;
+		}
+	} while(sent && !parked);
+}
+
+/*
+ * @brief Bytes waiting to be sent: values queued and the part of the long
+ * 			values not completed by the controller
+ */
+uint32_t notify_queued_bytes(void){
+	return queued_bytes;
+}
+
+/*
+ * @brief Bytes queued on some characteristics, long values not included
+ * @param chars Characteristics, one bit per char_id (conn_t.notify/indicate)
+ */
+uint32_t notify_queued_bytes_of(uint32_t chars){
+	notify_queue_t *q;
+	uint32_t bytes = 0;
+	uint8_t i, slot;
+
+	for(q = queues; q != NULL; q = q->next){
+		if(q->char_id >= 32 || !(chars & (1UL << q->char_id)))
+			continue;
+		for(i = 0; i < q->count; i++){
+			slot = (q->head + i) % NOTIFY_QUEUE_DEPTH;
+			bytes += q->len[slot];
+		}
+	}
+	return bytes;
+}
+
+/*
+ * @brief Check whether the queues wait for the controller TX pool
+ */
+uint8_t notify_is_parked(void){
+	return parked;
+}
+
+/*
+ * @brief Copy the counters of the queues
+ */
+void notify_get_stats(notify_stats_t *out){
+	*out = stats;
+}
+
+/*
+ * @brief Clear the counters of the queues
+ */
+void notify_reset_stats(void){
+	memset(&stats, 0, sizeof(stats));
+}
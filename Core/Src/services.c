@@ -17,120 +17,212 @@
 #include "services.h"
 #include "callbacks.h"
 #include "main.h"
-
-charactFormat charFormat;
+#include "notify_queue.h"
+#include "conn_table.h"
+#include "value_shadow.h"
+#include "gatt_db.h"
+#include "dfu.h"
 
 const uint8_t service_uuid_pb[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xdf, 0xf2, 0x73, 0xd9};
 const uint8_t service_uuid[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xe0, 0xf2, 0x73, 0xd9};
 const uint8_t char_uuid_pb[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xe1, 0xf2, 0x73, 0xd9};
 const uint8_t char_uuid_led[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xe2, 0xf2, 0x73, 0xd9};
 const uint8_t char_uuid_led_status[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xe3, 0xf2, 0x73, 0xd9};
+const uint8_t char_uuid_record[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xe4, 0xf2, 0x73, 0xd9};
+const uint8_t service_uuid_dfu[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xe5, 0xf2, 0x73, 0xd9};
+const uint8_t char_uuid_dfu_control[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xe6, 0xf2, 0x73, 0xd9};
+const uint8_t char_uuid_dfu_data[16] = {0x66, 0x9a, 0x0c, 0x20, 0x00, 0x08, 0x96, 0x9e, 0xe2, 0x11, 0x9e, 0xb1, 0xe7, 0xf2, 0x73, 0xd9};
 const uint8_t char_desc_uuid[2] = {0x12, 0x34};
 
+static const charactFormat charFormat = {
+	.format = FORMAT_SINT16,
+	.exp = -1,
+	.unit = UNIT_UNITLESS,
+	.name_space = 0,
+	.desc = 0,
+};
+
 static uint16_t nucleoServHandle, pbServHandle, pbCharHandle, ledCharHandle;
-static uint16_t ledStatusCharHandle, myCharDescHandle, connectionHandle;
+static uint16_t ledStatusCharHandle, myCharDescHandle, recordCharHandle;
+#if BLE_DFU_ENABLE
+static uint16_t dfuServHandle, dfuControlCharHandle, dfuDataCharHandle;
+#endif
 
 volatile static uint8_t LED_STATUS = 0;
 volatile static uint8_t NOTIFICATION_PENDING = FALSE;
+static notify_queue_t pbQueue;
+#if BLE_DFU_ENABLE
+static notify_queue_t dfuQueue;
+#endif
+static notify_long_t recordXfer;
+static value_shadow_t ledStatusShadow;
+static gatt_db_done_t servicesAdded;
+
+static void on_led_control_write(uint16_t conn_handle, uint16_t len, uint8_t data[]);
+
+static const gatt_desc_def_t ledControlDescs[] = {
+	//presentation format of the LED control value
+	{
+		.uuid = char_desc_uuid,
+		.uuid_type = UUID_TYPE_16,
+		.value_max = sizeof(charFormat),
+		.value_len = sizeof(charFormat),
+		.value = &charFormat,
+		.permissions = ATTR_PERMISSION_NONE,
+		.access = ATTR_ACCESS_READ_ONLY,
+		.evt_mask = 0,
+		.handle = &myCharDescHandle,
+	},
+};
+
+static const gatt_char_def_t nucleoChars[] = {
+	//characteristic to read led status, read by the controller from the value
+	//kept up to date by change_led_state()
+	{
+		.uuid = char_uuid_led_status,
+		.uuid_type = UUID_TYPE_128,
+		.value_max = 2,
+		.properties = CHAR_PROP_READ,
+		.permissions = ATTR_PERMISSION_NONE,
+		.evt_mask = 0,
+		.is_variable = 1,
+		.handle = &ledStatusCharHandle,
+	},
+	//characteristic that toggles LED on write from client, only the first byte is used
+	{
+		.uuid = char_uuid_led,
+		.uuid_type = UUID_TYPE_128,
+		.value_max = 2,
+		.properties = CHAR_PROP_WRITE | CHAR_PROP_WRITE_WITHOUT_RESP,
+		.permissions = ATTR_PERMISSION_NONE,
+		.evt_mask = GATT_NOTIFY_ATTRIBUTE_WRITE,
+		.is_variable = 1,
+		.on_write = on_led_control_write,
+		.descs = ledControlDescs,
+		.desc_count = GATT_DB_COUNT(ledControlDescs),
+		.handle = &ledCharHandle,
+	},
+};
+
+static const gatt_char_def_t pbChars[] = {
+	//characteristic that send notification on PB press
+	{
+		.uuid = char_uuid_pb,
+		.uuid_type = UUID_TYPE_128,
+		.value_max = NOTIFY_VALUE_MAX,
+		.properties = CHAR_PROP_NOTIFY,
+		.permissions = ATTR_PERMISSION_NONE,
+		.evt_mask = 0,
+		.is_variable = 1,
+		.char_id = PB_CHAR_ID,
+		.handle = &pbCharHandle,
+	},
+	//characteristic that notifies the records, written in chunks
+	{
+		.uuid = char_uuid_record,
+		.uuid_type = UUID_TYPE_128,
+		.value_max = RECORD_VALUE_MAX,
+		.properties = CHAR_PROP_NOTIFY | CHAR_PROP_READ,
+		.permissions = ATTR_PERMISSION_NONE,
+		.evt_mask = 0,
+		.is_variable = 1,
+		.char_id = RECORD_CHAR_ID,
+		.handle = &recordCharHandle,
+	},
+};
+
+#if BLE_DFU_ENABLE
+//the update reflashes the board: only an authenticated, encrypted link writes
+static const gatt_char_def_t dfuChars[] = {
+	//control point of the application update: operations written by
+	//the client, progress notified back
+	{
+		.uuid = char_uuid_dfu_control,
+		.uuid_type = UUID_TYPE_128,
+		.value_max = DFU_START_LEN,
+		.properties = CHAR_PROP_WRITE | CHAR_PROP_NOTIFY,
+		.permissions = ATTR_PERMISSION_AUTHEN_WRITE | ATTR_PERMISSION_ENCRY_WRITE,
+		.evt_mask = GATT_NOTIFY_ATTRIBUTE_WRITE,
+		.is_variable = 1,
+		.char_id = DFU_CHAR_ID,
+		.on_write = dfu_control_write,
+		.handle = &dfuControlCharHandle,
+	},
+	//image of the application, streamed without responses at the MTU
+	{
+		.uuid = char_uuid_dfu_data,
+		.uuid_type = UUID_TYPE_128,
+		.value_max = BLE_ATT_MTU_MAX - CONN_ATT_HDR_SIZE,
+		.properties = CHAR_PROP_WRITE_WITHOUT_RESP,
+		.permissions = ATTR_PERMISSION_AUTHEN_WRITE | ATTR_PERMISSION_ENCRY_WRITE,
+		.evt_mask = GATT_NOTIFY_ATTRIBUTE_WRITE,
+		.is_variable = 1,
+		.on_write = dfu_data_write,
+		.handle = &dfuDataCharHandle,
+	},
+};
+#endif
+
+static const gatt_service_def_t services[] = {
+	//service of the LED
+	{
+		.uuid = service_uuid,
+		.uuid_type = UUID_TYPE_128,
+		.chars = nucleoChars,
+		.char_count = GATT_DB_COUNT(nucleoChars),
+		.handle = &nucleoServHandle,
+	},
+	//service that handles the push button interrupt, notifies the
+	//state of LED on PB press
+	{
+		.uuid = service_uuid_pb,
+		.uuid_type = UUID_TYPE_128,
+		.chars = pbChars,
+		.char_count = GATT_DB_COUNT(pbChars),
+		.handle = &pbServHandle,
+	},
+#if BLE_DFU_ENABLE
+	//service of the update of the application over the air
+	{
+		.uuid = service_uuid_dfu,
+		.uuid_type = UUID_TYPE_128,
+		.chars = dfuChars,
+		.char_count = GATT_DB_COUNT(dfuChars),
+		.handle = &dfuServHandle,
+	},
+#endif
+};
 
 /*
- * @brief defines a service with the char and corresponding descriptors
- * @retvalue status of success
- */
-tBleStatus addNucleoService(void){
-	tBleStatus ret;
-
-	aci_gatt_add_serv(UUID_TYPE_128,
-			service_uuid,
-			PRIMARY_SERVICE,
-			0x07,
-			&nucleoServHandle);
-
-	//characteristic to read led status
-	aci_gatt_add_char(nucleoServHandle,
-			UUID_TYPE_128,
-			char_uuid_led_status,
-			2,
-			CHAR_PROP_READ,
-			ATTR_PERMISSION_NONE,
-			GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP,
-			16,
-			1,
-			&ledStatusCharHandle);
-
-	//characteristic that toggles LED on write from client
-	ret = aci_gatt_add_char(nucleoServHandle,
-			UUID_TYPE_128,
-			char_uuid_led,
-			20,
-			CHAR_PROP_WRITE | CHAR_PROP_WRITE_WITHOUT_RESP,
-			ATTR_PERMISSION_NONE,
-			GATT_NOTIFY_ATTRIBUTE_WRITE,
-			16,
-			0,
-			&ledCharHandle);
-
-
-	charFormat.format = FORMAT_SINT16;
-	charFormat.exp = -1;
-	charFormat.unit = UNIT_UNITLESS;
-	charFormat.name_space = 0;
-	charFormat.desc = 0;
-
-	ret = aci_gatt_add_char_desc(nucleoServHandle,
-			ledCharHandle,
-			UUID_TYPE_16,
-			(uint8_t *)&char_desc_uuid,
-			7,
-			7,
-			(void *)&charFormat,
-			ATTR_PERMISSION_NONE,
-			ATTR_ACCESS_READ_ONLY,
-			0,
-			16,
-			FALSE,
-			&myCharDescHandle);
-	return ret;
-
-
-}
-
-/*
- * @brief The service that handles the push button interrupt
- * `		Notifies the state of LED on PB press
+ * @brief End of the build of the services: attach the shadow
+ * 			and the queue of their characteristics
  */
-tBleStatus addPbService(void){
-	tBleStatus ret;
-	ret = aci_gatt_add_serv(UUID_TYPE_128,
-			service_uuid_pb,
-			PRIMARY_SERVICE,
-			0x07,
-			&pbServHandle);
-
-	//characteristic that send notification on PB press
-	ret = aci_gatt_add_char(pbServHandle,
-			UUID_TYPE_128,
-			char_uuid_pb,
-			20,
-			CHAR_PROP_NOTIFY,
-			ATTR_PERMISSION_NONE,
-			0,
-			16,
-			1,
-			&pbCharHandle);
-
-	return ret;
+static void on_services_added(tBleStatus status){
+	if(status == BLE_STATUS_SUCCESS){
+		value_shadow_init(&ledStatusShadow, nucleoServHandle, ledStatusCharHandle);
+		update_led_status_value();
+
+		notify_queue_register(&pbQueue, pbServHandle, pbCharHandle, PB_CHAR_ID);
+#if BLE_DFU_ENABLE
+		notify_queue_register(&dfuQueue, dfuServHandle, dfuControlCharHandle, DFU_CHAR_ID);
+		dfu_init(&dfuQueue);
+#endif
+	}
+	if(servicesAdded != NULL)
+		servicesAdded(status);
 }
 
-
 /*
- *  @brief set/reset connection handle on successful completion
- *  		of either the events. Will be called from call_backs.c
- *  @param handle Handle to the connection on successful connection
- *  				0 on successful disconnection
+ * @brief Add the services of the table to the controller. Returns
+ * 			at once, the commands are completed from the main loop.
+ * @param done Callback once the services are added, may be NULL
+ * @retvalue 0 on success, -1 if the services are being added
  */
-void set_connection_handle(uint16_t handle){
-	connectionHandle = handle;
+int addServices(gatt_db_done_t done){
+	if(gatt_db_is_building())
+		return -1;
+	servicesAdded = done;
+	return gatt_db_build(services, GATT_DB_COUNT(services), on_services_added);
 }
 
 
@@ -145,77 +237,80 @@ void set_notification_pending(void){
 
 
 /*
- *  @brief return connection handle cached on successful
- *  		connection setup
- *  @retvalue connection handle
+ * @brief Update the LED status characteristic with the current
+ * 			LED status, written only if it changed
+ * @retvalue status of the update
  */
-uint16_t get_connection_handle(void){
-	return connectionHandle;
-}
+tBleStatus update_led_status_value(void){
+	uint8_t led_status = LED_STATUS;
 
+	return value_shadow_set(&ledStatusShadow, &led_status, 1);
+}
 
 /*
- * @brief Checks if the attribute change is corresponding to notification
- * 			characteristic
- * @param handle Handle corresponding to PB notification
- * @retvalue returns bool corresponding to comparison
+ *  @brief Queue the notification of a push button press, sent
+ *  		by notify_process() when the controller accepts it
  */
-bool is_pb_notification_attribute(uint16_t handle){
-	return (handle == (pbCharHandle+2));
-}
+void send_notification(void){
+	uint8_t led_status;
 
+	if(is_notification_enabled() && NOTIFICATION_PENDING){
+		led_status = LED_STATUS;
+		notify_queue_push(&pbQueue, &led_status, 1);
+		NOTIFICATION_PENDING = FALSE;
+	}
+}
 
 /*
- * @brief Checks if the attribute change is corresponding to write
- * 			characteristic
- * @param handle Handle corresponding to write property
- * @retvalue returns bool corresponding to comparison
+ * @brief Update the record characteristic and notify it to the
+ * 			subscribed clients. The record is sent in chunks from
+ * 			the main loop and must stay unchanged until
+ * 			is_record_pending() returns false. A notification
+ * 			carries the first MTU - 3 bytes of the record, the
+ * 			client reads the rest with long reads.
+ * @param record Record
+ * @param len Length of the record, RECORD_VALUE_MAX at most
+ * @retvalue 0 on success, -1 if a record is still being sent
  */
-bool is_led_control_attribute(uint16_t handle){
-	return (handle == (ledCharHandle+1));
+int send_record(const uint8_t *record, uint16_t len){
+	if(len > RECORD_VALUE_MAX)
+		return -1;
+	return notify_long_update(&recordXfer, pbServHandle, recordCharHandle, NOTIFICATION,
+			record, len, NULL);
 }
 
-
 /*
- * @brief Checks if the characteristic is corresponding to LED
- * 			status read property
- * @param handle Handle corresponding to the property
- * @retvalue returns bool corresponding to comparison
+ * @brief Check whether the last record is still being sent
  */
-bool is_led_status_read_charac(uint16_t handle){
-	return (handle == (ledStatusCharHandle+1));
+bool is_record_pending(void){
+	return recordXfer.busy;
 }
 
 /*
- * @brief Update the current LED status on request from the
- * 			appropriate characteristic and service
- * 	@param serv_handle Service handle
- * 	@param charc_handle Corresponding characteristic handle
+ * @brief Handles of the record characteristic
  */
-void update_current_led_status(uint16_t serv_handle, uint16_t charc_handle){
-	if(is_connected())
-		aci_gatt_update_char_value(serv_handle, charc_handle, 0, 1, (uint8_t *)&LED_STATUS);
+void get_record_handles(uint16_t *serv_handle, uint16_t *char_handle){
+	*serv_handle = pbServHandle;
+	*char_handle = recordCharHandle;
 }
 
 /*
- *  @brief Send out notification on push button press
+ * @brief Queue of the PB notification characteristic, for the
+ * 			producers that stream values to it
  */
-void send_notification(void){
-	if(is_notification_enabled() && NOTIFICATION_PENDING){
-		update_current_led_status(pbServHandle, pbCharHandle);
-		NOTIFICATION_PENDING = FALSE;
-	}
+notify_queue_t *get_pb_notify_queue(void){
+	return &pbQueue;
 }
 
 /*
- * @brief Updates current LED status on request from client
- *
+ * @brief Write handler of the LED control characteristic
  */
-void service_read_request(void){
-	update_current_led_status(nucleoServHandle, ledStatusCharHandle);
+static void on_led_control_write(uint16_t conn_handle, uint16_t len, uint8_t data[]){
+	if(len == 0)
+		return;
+	change_led_state(len, data);
 }
 
-
 /*
  * @brief Change the LED status as set by the client
  * @param len Len of the data received from client
@@ -225,6 +320,7 @@ void service_read_request(void){
 void change_led_state(uint16_t len, uint8_t data[]){
 	LED_STATUS = data[0];
 	HAL_GPIO_WritePin(GreenLED_GPIO_Port, GreenLED_Pin, LED_STATUS);
+	update_led_status_value();
 }
 
 
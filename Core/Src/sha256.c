@@ -0,0 +1,161 @@
+/*
+ * sha256.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Plain C, no access to the hardware: also built on the host by
+ *  tests/test_hmac.c.
+ */
+
+#include "sha256.h"
+
+#include <string.h>
+
+#define ROTR(x, n)      (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const uint32_t k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/*
+ * @brief Hash one block into the state
+ */
+static void compress(uint32_t state[8], const uint8_t block[SHA256_BLOCK_SIZE]){
+	uint32_t w[64];
+	uint32_t a, b, c, d, e, f, g, h, t1, t2;
+	uint8_t i;
+
+	for(i = 0; i < 16; i++)
+		w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+				(uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+	for(i = 16; i < 64; i++)
+		w[i] = (ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10)) + w[i - 7] +
+				(ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3)) + w[i - 16];
+
+	a = state[0]; b = state[1]; c = state[2]; d = state[3];
+	e = state[4]; f = state[5]; g = state[6]; h = state[7];
+	for(i = 0; i < 64; i++){
+		t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+		t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/*
+ * @brief Start a hash
+ */
+void sha256_init(sha256_t *ctx){
+	static const uint32_t h0[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+	};
+
+	memcpy(ctx->state, h0, sizeof(h0));
+	ctx->bytes = 0;
+	ctx->fill = 0;
+}
+
+/*
+ * @brief Hash the next bytes of the message
+ */
+void sha256_update(sha256_t *ctx, const uint8_t *data, uint32_t len){
+	uint32_t n;
+
+	ctx->bytes += len;
+	while(len > 0){
+		/* Whole blocks are hashed in place, not copied */
+		if(ctx->fill == 0 && len >= SHA256_BLOCK_SIZE){
+			compress(ctx->state, data);
+			data += SHA256_BLOCK_SIZE;
+			len -= SHA256_BLOCK_SIZE;
+			continue;
+		}
+		n = SHA256_BLOCK_SIZE - ctx->fill;
+		if(n > len)
+			n = len;
+		memcpy(ctx->block + ctx->fill, data, n);
+		ctx->fill += n;
+		data += n;
+		len -= n;
+		if(ctx->fill == SHA256_BLOCK_SIZE){
+			compress(ctx->state, ctx->block);
+			ctx->fill = 0;
+		}
+	}
+}
+
+/*
+ * @brief Pad the message and read the digest, the context must be started again
+ */
+void sha256_final(sha256_t *ctx, uint8_t digest[SHA256_DIGEST_SIZE]){
+	uint64_t bits = ctx->bytes * 8;
+	uint8_t i;
+
+	ctx->block[ctx->fill++] = 0x80;
+	if(ctx->fill > SHA256_BLOCK_SIZE - 8){
+		memset(ctx->block + ctx->fill, 0, SHA256_BLOCK_SIZE - ctx->fill);
+		compress(ctx->state, ctx->block);
+		ctx->fill = 0;
+	}
+	memset(ctx->block + ctx->fill, 0, SHA256_BLOCK_SIZE - 8 - ctx->fill);
+	for(i = 0; i < 8; i++)
+		ctx->block[SHA256_BLOCK_SIZE - 1 - i] = bits >> (8 * i);
+	compress(ctx->state, ctx->block);
+
+	for(i = 0; i < 8; i++){
+		digest[4 * i] = ctx->state[i] >> 24;
+		digest[4 * i + 1] = ctx->state[i] >> 16;
+		digest[4 * i + 2] = ctx->state[i] >> 8;
+		digest[4 * i + 3] = ctx->state[i];
+	}
+}
+
+/*
+ * @brief HMAC-SHA256 of a message
+ * @param key Key, hashed first if longer than a block
+ * @param key_len Length of the key
+ * @param data Message
+ * @param len Length of the message
+ * @param mac Filled with the MAC
+ */
+void hmac_sha256(const uint8_t *key, uint32_t key_len, const uint8_t *data, uint32_t len,
+		uint8_t mac[SHA256_DIGEST_SIZE]){
+	uint8_t pad[SHA256_BLOCK_SIZE];
+	uint8_t inner[SHA256_DIGEST_SIZE];
+	sha256_t ctx;
+	uint8_t i;
+
+	memset(pad, 0, sizeof(pad));
+	if(key_len > SHA256_BLOCK_SIZE){
+		sha256_init(&ctx);
+		sha256_update(&ctx, key, key_len);
+		sha256_final(&ctx, pad);
+	}
+	else
+		memcpy(pad, key, key_len);
+
+	for(i = 0; i < SHA256_BLOCK_SIZE; i++)
+		pad[i] ^= 0x36;
+	sha256_init(&ctx);
+	sha256_update(&ctx, pad, SHA256_BLOCK_SIZE);
+	sha256_update(&ctx, data, len);
+	sha256_final(&ctx, inner);
+
+	for(i = 0; i < SHA256_BLOCK_SIZE; i++)
+		pad[i] ^= 0x36 ^ 0x5c;
+	sha256_init(&ctx);
+	sha256_update(&ctx, pad, SHA256_BLOCK_SIZE);
+	sha256_update(&ctx, inner, SHA256_DIGEST_SIZE);
+	sha256_final(&ctx, mac);
+
+	memset(pad, 0, sizeof(pad));
+}
@@ -79,7 +79,7 @@ void DebugMon_Handler(void)
   */
 void PendSV_Handler(void)
 {
- //
+  hci_tl_lowlevel_bottom_half();
 }
 
 /**
@@ -88,6 +88,7 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
   HAL_IncTick();
+  hci_tl_lowlevel_tick();
 }
 
 /******************************************************************************/
@@ -105,6 +106,32 @@ void EXTI0_IRQHandler(void)
   HAL_EXTI_IRQHandler(&H_EXTI_0);
 }
 
+#if (USE_BUS_SPI1_DMA == 1U)
+/**
+  * @brief This function handles SPI1 global interrupt.
+  */
+void SPI1_IRQHandler(void)
+{
+  HAL_SPI_IRQHandler(&hspi1);
+}
+
+/**
+  * @brief This function handles DMA2 stream0 global interrupt (SPI1_RX).
+  */
+void DMA2_Stream0_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_spi1_rx);
+}
+
+/**
+  * @brief This function handles DMA2 stream3 global interrupt (SPI1_TX).
+  */
+void DMA2_Stream3_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_spi1_tx);
+}
+#endif /* USE_BUS_SPI1_DMA */
+
 /**
   * @brief This function handles EXTI line[15:10] interrupts.
   */
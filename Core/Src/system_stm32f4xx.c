@@ -106,7 +106,8 @@
 /*!< Uncomment the following line if you need to relocate your vector Table in
      Internal SRAM. */
 /* #define VECT_TAB_SRAM */
-#define VECT_TAB_OFFSET  0x00 /*!< Vector Table base offset field. 
+#define VECT_TAB_OFFSET  0x4000 /*!< Vector Table base offset field, the application
+                                   follows the boot stage of sector 0 (dfu.h).
                                    This value must be a multiple of 0x200. */
 /******************************************************************************/
 
@@ -0,0 +1,74 @@
+/*
+ * value_shadow.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  A characteristic kept up to date through its shadow is registered
+ *  without GATT_NOTIFY_READ_REQ_AND_WAIT_FOR_APPL_RESP: the controller
+ *  answers the reads of the clients from its own copy, with no event to
+ *  the host and no aci_gatt_allow_read(). The application sets the value
+ *  whenever it changes; the controller is only written when the value
+ *  differs from the one it holds.
+ */
+
+#include "value_shadow.h"
+#include "bluenrg_gatt_aci.h"
+
+#include <string.h>
+
+static value_shadow_stats_t stats;
+
+/*
+ * @brief Attach a shadow to a characteristic, the first value_shadow_set()
+ * 			always writes the controller
+ * @param shadow Shadow
+ * @param serv_handle Handle of the service
+ * @param char_handle Handle of the characteristic
+ */
+void value_shadow_init(value_shadow_t *shadow, uint16_t serv_handle, uint16_t char_handle){
+	shadow->serv_handle = serv_handle;
+	shadow->char_handle = char_handle;
+	shadow->len = 0;
+	shadow->valid = 0;
+}
+
+/*
+ * @brief Set the value of a characteristic, written to the controller only
+ * 			if it differs from the value it holds
+ * @param shadow Shadow of the characteristic
+ * @param value Value
+ * @param len Length of the value, VALUE_SHADOW_MAX at most
+ * @retvalue Status of the write, BLE_STATUS_SUCCESS when not needed
+ */
+tBleStatus value_shadow_set(value_shadow_t *shadow, const uint8_t *value, uint8_t len){
+	tBleStatus ret;
+
+	if(len > VALUE_SHADOW_MAX)
+		return BLE_STATUS_INVALID_PARAMS;
+
+	if(shadow->valid && shadow->len == len && memcmp(shadow->value, value, len) == 0){
+		stats.skipped++;
+		return BLE_STATUS_SUCCESS;
+	}
+
+	ret = aci_gatt_update_char_value(shadow->serv_handle, shadow->char_handle, 0, len, value);
+	if(ret != BLE_STATUS_SUCCESS){
+		/* Unknown content in the controller: write again on the next set */
+		shadow->valid = 0;
+		stats.errors++;
+		return ret;
+	}
+
+	memcpy(shadow->value, value, len);
+	shadow->len = len;
+	shadow->valid = 1;
+	stats.writes++;
+	return ret;
+}
+
+/*
+ * @brief Copy the counters of the shadows
+ */
+void value_shadow_get_stats(value_shadow_stats_t *out){
+	*out = stats;
+}
@@ -598,6 +598,28 @@ tBleStatus aci_gap_get_security_level(uint8_t* mitm_protection, uint8_t* bonding
   return resp.status;
 }
 
+tBleStatus aci_gap_set_event_mask(uint16_t event_mask)
+{
+  struct hci_request rq;
+  gap_set_evt_mask_cp cp;
+  uint8_t status;
+  
+  cp.evt_mask = htobs(event_mask);
+  
+  BLUENRG_memset(&rq, 0, sizeof(rq));
+  rq.ogf = OGF_VENDOR_CMD;
+  rq.ocf = OCF_GAP_SET_EVT_MASK;
+  rq.cparam = &cp;
+  rq.clen = GAP_SET_EVT_MASK_CP_SIZE;
+  rq.rparam = &status;
+  rq.rlen = 1;
+  
+  if (hci_send_req(&rq, FALSE) < 0)
+    return BLE_STATUS_TIMEOUT;
+
+  return status;
+}
+
 tBleStatus aci_gap_configure_whitelist(void)
 {
   struct hci_request rq;
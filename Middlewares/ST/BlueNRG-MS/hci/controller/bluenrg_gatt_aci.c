@@ -46,19 +46,25 @@ tBleStatus aci_gatt_add_serv(uint8_t service_uuid_type, const uint8_t* service_u
 {
   struct hci_request rq;
   gatt_add_serv_rp resp;    
-  uint8_t buffer[19];
+  uint8_t *buffer;
   uint8_t uuid_len;
   uint8_t indx = 0;
     
-  buffer[indx] = service_uuid_type;
-  indx++;
-    
   if(service_uuid_type == UUID_TYPE_16){
     uuid_len = 2;
   }
   else {
     uuid_len = 16;
   }        
+  
+  /* Serialized in place in the transport TX frame */
+  buffer = hci_cmd_reserve(3 + uuid_len);
+  if (buffer == NULL)
+    return BLE_STATUS_TIMEOUT;
+    
+  buffer[indx] = service_uuid_type;
+  indx++;
+    
   BLUENRG_memcpy(buffer + indx, service_uuid, uuid_len);
   indx +=  uuid_len;
     
@@ -160,10 +166,22 @@ tBleStatus aci_gatt_add_char(uint16_t serviceHandle,
 {
   struct hci_request rq;
   gatt_add_serv_rp resp;
-  uint8_t buffer[25];
+  uint8_t *buffer;
   uint8_t uuid_len;
   uint8_t indx = 0;
     
+  if(charUuidType == UUID_TYPE_16){
+    uuid_len = 2;
+  }
+  else {
+    uuid_len = 16;
+  }        
+  
+  /* Serialized in place in the transport TX frame */
+  buffer = hci_cmd_reserve(9 + uuid_len);
+  if (buffer == NULL)
+    return BLE_STATUS_TIMEOUT;
+    
   serviceHandle = htobs(serviceHandle);
   BLUENRG_memcpy(buffer + indx, &serviceHandle, 2);
   indx += 2;
@@ -171,12 +189,6 @@ tBleStatus aci_gatt_add_char(uint16_t serviceHandle,
   buffer[indx] = charUuidType;
   indx++;
     
-  if(charUuidType == UUID_TYPE_16){
-    uuid_len = 2;
-  }
-  else {
-    uuid_len = 16;
-  }        
   BLUENRG_memcpy(buffer + indx, charUuid, uuid_len);
   indx +=  uuid_len;
     
@@ -236,10 +248,25 @@ tBleStatus aci_gatt_add_char_desc(uint16_t serviceHandle,
 {
   struct hci_request rq;
   gatt_add_char_desc_rp resp;
-  uint8_t buffer[HCI_MAX_PAYLOAD_SIZE];
+  uint8_t *buffer;
   uint8_t uuid_len;
   uint8_t indx = 0;
     
+  if(descUuidType == UUID_TYPE_16){
+    uuid_len = 2;
+  }
+  else {
+    uuid_len = 16;
+  }        
+  
+  if ((uuid_len+descValueLen+12) > HCI_MAX_CMD_PARAM_SIZE)
+    return BLE_STATUS_INVALID_PARAMS;
+  
+  /* Serialized in place in the transport TX frame */
+  buffer = hci_cmd_reserve(uuid_len + descValueLen + 12);
+  if (buffer == NULL)
+    return BLE_STATUS_TIMEOUT;
+    
   serviceHandle = htobs(serviceHandle);
   BLUENRG_memcpy(buffer + indx, &serviceHandle, 2);
   indx += 2;
@@ -251,12 +278,6 @@ tBleStatus aci_gatt_add_char_desc(uint16_t serviceHandle,
   buffer[indx] = descUuidType;
   indx++;
     
-  if(descUuidType == UUID_TYPE_16){
-    uuid_len = 2;
-  }
-  else {
-    uuid_len = 16;
-  }        
   BLUENRG_memcpy(buffer + indx, uuid, uuid_len);
   indx +=  uuid_len;
     
@@ -266,9 +287,6 @@ tBleStatus aci_gatt_add_char_desc(uint16_t serviceHandle,
   buffer[indx] = descValueLen;
   indx++;
 
-  if ((descValueLen+indx+5) > HCI_MAX_PAYLOAD_SIZE)
-    return BLE_STATUS_INVALID_PARAMS;
-  
   BLUENRG_memcpy(buffer + indx, descValue, descValueLen);
   indx += descValueLen;
     
@@ -318,11 +336,16 @@ tBleStatus aci_gatt_update_char_value(uint16_t servHandle,
 {
   struct hci_request rq;
   uint8_t status;
-  uint8_t buffer[HCI_MAX_PAYLOAD_SIZE];
+  uint8_t *buffer;
   uint8_t indx = 0;
     
-  if ((charValueLen+6) > HCI_MAX_PAYLOAD_SIZE)
+  if ((charValueLen+6) > HCI_MAX_CMD_PARAM_SIZE)
     return BLE_STATUS_INVALID_PARAMS;
+  
+  /* Serialized in place in the transport TX frame */
+  buffer = hci_cmd_reserve(charValueLen + 6);
+  if (buffer == NULL)
+    return BLE_STATUS_TIMEOUT;
 
   servHandle = htobs(servHandle);
   BLUENRG_memcpy(buffer + indx, &servHandle, 2);
@@ -1407,9 +1430,11 @@ tBleStatus aci_gatt_read_handle_value(uint16_t attr_handle, uint16_t data_len, u
 {
   struct hci_request rq;
   gatt_read_handle_val_cp cp;
-  gatt_read_handle_val_rp rp;
+  tHciRespView rsp;
+  tBleStatus status;
+  uint16_t len;
  
-  if(data_len > sizeof(rp.value))
+  if(data_len > HCI_MAX_PAYLOAD_SIZE-GATT_READ_HANDLE_VALUE_RP_SIZE)
     return BLE_STATUS_INVALID_PARAMS;
 
   cp.attr_handle = htobs(attr_handle);
@@ -1419,29 +1444,37 @@ tBleStatus aci_gatt_read_handle_value(uint16_t attr_handle, uint16_t data_len, u
   rq.ocf = OCF_GATT_READ_HANDLE_VALUE;
   rq.cparam = &cp;
   rq.clen = sizeof(cp);
-  rq.rparam = &rp;
-  rq.rlen = sizeof(rp);
 
-  if (hci_send_req(&rq, FALSE) < 0)
+  /* The value is copied once, from the event packet to the caller buffer */
+  if (hci_send_req_borrow(&rq, &rsp) < 0)
     return BLE_STATUS_TIMEOUT;
   
-  if(rp.status)
-    return rp.status;
-
-  *data_len_out_p = btohs(rp.value_len);
-
-  BLUENRG_memcpy(data, rp.value, MIN(data_len, *data_len_out_p));
+  status = rsp.len ? rsp.data[0] : BLE_STATUS_FAILED;
+  if(status == 0 && rsp.len < GATT_READ_HANDLE_VALUE_RP_SIZE)
+    status = BLE_STATUS_FAILED;
+  
+  if(status == 0)
+  {
+    *data_len_out_p = (uint16_t)(rsp.data[1] | (rsp.data[2] << 8));
+    len = MIN(data_len, *data_len_out_p);
+    len = MIN(len, rsp.len - GATT_READ_HANDLE_VALUE_RP_SIZE);
+    BLUENRG_memcpy(data, rsp.data + GATT_READ_HANDLE_VALUE_RP_SIZE, len);
+  }
+  
+  hci_release_resp(&rsp);
 
-  return 0;
+  return status;
 }
 
 tBleStatus aci_gatt_read_handle_value_offset_IDB05A1(uint16_t attr_handle, uint8_t offset, uint16_t data_len, uint16_t *data_len_out_p, uint8_t *data)
 {
   struct hci_request rq;
   gatt_read_handle_val_offset_cp cp;
-  gatt_read_handle_val_offset_rp rp;
+  tHciRespView rsp;
+  tBleStatus status;
+  uint16_t len;
   
-  if(data_len > sizeof(rp.value))
+  if(data_len > HCI_MAX_PAYLOAD_SIZE-GATT_READ_HANDLE_VALUE_OFFSET_RP_SIZE)
     return BLE_STATUS_INVALID_PARAMS;
 
   cp.attr_handle = htobs(attr_handle);
@@ -1452,20 +1485,25 @@ tBleStatus aci_gatt_read_handle_value_offset_IDB05A1(uint16_t attr_handle, uint8
   rq.ocf = OCF_GATT_READ_HANDLE_VALUE_OFFSET;
   rq.cparam = &cp;
   rq.clen = sizeof(cp);
-  rq.rparam = &rp;
-  rq.rlen = sizeof(rp);
 
-  if (hci_send_req(&rq, FALSE) < 0)
+  if (hci_send_req_borrow(&rq, &rsp) < 0)
     return BLE_STATUS_TIMEOUT;
   
-  if(rp.status)
-    return rp.status;
-
-  *data_len_out_p = rp.value_len;
-
-  BLUENRG_memcpy(data, rp.value, MIN(data_len, *data_len_out_p));
+  status = rsp.len ? rsp.data[0] : BLE_STATUS_FAILED;
+  if(status == 0 && rsp.len < GATT_READ_HANDLE_VALUE_OFFSET_RP_SIZE)
+    status = BLE_STATUS_FAILED;
+  
+  if(status == 0)
+  {
+    *data_len_out_p = rsp.data[1];
+    len = MIN(data_len, *data_len_out_p);
+    len = MIN(len, rsp.len - GATT_READ_HANDLE_VALUE_OFFSET_RP_SIZE);
+    BLUENRG_memcpy(data, rsp.data + GATT_READ_HANDLE_VALUE_OFFSET_RP_SIZE, len);
+  }
+  
+  hci_release_resp(&rsp);
 
-  return 0; 
+  return status; 
 }
 
 tBleStatus aci_gatt_update_char_value_ext_IDB05A1(uint16_t service_handle, uint16_t char_handle,
@@ -1475,23 +1513,28 @@ tBleStatus aci_gatt_update_char_value_ext_IDB05A1(uint16_t service_handle, uint1
 {
   struct hci_request rq;
   uint8_t status;
-  gatt_upd_char_val_ext_cp cp;
+  gatt_upd_char_val_ext_cp *cp;
   
-  if(value_length > sizeof(cp.value))
+  if((GATT_UPD_CHAR_VAL_EXT_CP_SIZE + value_length) > HCI_MAX_CMD_PARAM_SIZE)
     return BLE_STATUS_INVALID_PARAMS;
   
-  cp.service_handle = htobs(service_handle);
-  cp.char_handle = htobs(char_handle);
-  cp.update_type = update_type;
-  cp.char_length = htobs(char_length);
-  cp.value_offset = htobs(value_offset);
-  cp.value_length = value_length;
-  BLUENRG_memcpy(cp.value, value, value_length);
+  /* Serialized in place in the transport TX frame */
+  cp = (gatt_upd_char_val_ext_cp *)hci_cmd_reserve(GATT_UPD_CHAR_VAL_EXT_CP_SIZE + value_length);
+  if (cp == NULL)
+    return BLE_STATUS_TIMEOUT;
+  
+  cp->service_handle = htobs(service_handle);
+  cp->char_handle = htobs(char_handle);
+  cp->update_type = update_type;
+  cp->char_length = htobs(char_length);
+  cp->value_offset = htobs(value_offset);
+  cp->value_length = value_length;
+  BLUENRG_memcpy(cp->value, value, value_length);
   
   BLUENRG_memset(&rq, 0, sizeof(rq));
   rq.ogf = OGF_VENDOR_CMD;
   rq.ocf = OCF_GATT_UPD_CHAR_VAL_EXT;
-  rq.cparam = &cp;
+  rq.cparam = cp;
   rq.clen = GATT_UPD_CHAR_VAL_EXT_CP_SIZE + value_length;
   rq.rparam = &status;
   rq.rlen = 1;
@@ -91,7 +91,8 @@ tBleStatus aci_hal_read_config_data(uint8_t offset, uint16_t data_len, uint8_t *
 {
   struct hci_request rq;
   hal_read_config_data_cp cp;
-  hal_read_config_data_rp rp;
+  tHciRespView rsp;
+  tBleStatus status;
   
   cp.offset = offset;
   
@@ -100,20 +101,21 @@ tBleStatus aci_hal_read_config_data(uint8_t offset, uint16_t data_len, uint8_t *
   rq.ocf = OCF_HAL_READ_CONFIG_DATA;
   rq.cparam = &cp;
   rq.clen = sizeof(cp);
-  rq.rparam = &rp;
-  rq.rlen = sizeof(rp);
   
-  if (hci_send_req(&rq, FALSE) < 0)
+  if (hci_send_req_borrow(&rq, &rsp) < 0)
     return BLE_STATUS_TIMEOUT;
   
-  if(rp.status)
-    return rp.status;
+  status = rsp.len ? rsp.data[0] : BLE_STATUS_FAILED;
   
-  *data_len_out_p = rq.rlen-1;
+  if(status == 0)
+  {
+    *data_len_out_p = rsp.len - HAL_READ_CONFIG_DATA_RP_SIZE;
+    BLUENRG_memcpy(data, rsp.data + HAL_READ_CONFIG_DATA_RP_SIZE, MIN(data_len, *data_len_out_p));
+  }
   
-  BLUENRG_memcpy(data, rp.data, MIN(data_len, *data_len_out_p));
+  hci_release_resp(&rsp);
   
-  return 0;
+  return status;
 }
 
 tBleStatus aci_hal_set_tx_power_level(uint8_t en_high_power, uint8_t pa_level)
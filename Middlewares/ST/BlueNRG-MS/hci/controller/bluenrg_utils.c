@@ -0,0 +1,577 @@
+/******************** (C) COPYRIGHT 2014 STMicroelectronics ********************
+* File Name          : bluenrg_utils.c
+* Author             : AMS - VMA, RF Application Team
+* Version            : V1.1.0
+* Date               : 17-October-2026
+* Description        : Utilities for BlueNRG-MS: firmware updater and IFR
+*                      access through the updater of the controller.
+********************************************************************************
+* THE PRESENT FIRMWARE WHICH IS FOR GUIDANCE ONLY AIMS AT PROVIDING CUSTOMERS
+* WITH CODING INFORMATION REGARDING THEIR PRODUCTS IN ORDER FOR THEM TO SAVE TIME.
+* AS A RESULT, STMICROELECTRONICS SHALL NOT BE HELD LIABLE FOR ANY DIRECT,
+* INDIRECT OR CONSEQUENTIAL DAMAGES WITH RESPECT TO ANY CLAIMS ARISING FROM THE
+* CONTENT OF SUCH FIRMWARE AND/OR THE USE MADE BY CUSTOMERS OF THE CODING
+* INFORMATION CONTAINED HEREIN IN CONNECTION WITH THEIR PRODUCTS.
+*******************************************************************************/
+
+/*
+ * program_device() streams the image through the asynchronous command
+ * pipeline (hci_send_cmd_async()): the erase of a sector, its program
+ * blocks and the CRC of the sector computed by the updater are queued back
+ * to back, so the erase of the next sector and the CRC of the previous one
+ * are already waiting in the controller while the host prepares the next
+ * commands. Before writing, the CRC of every sector in flash is compared to
+ * the image and the matching sectors are skipped: an update interrupted by
+ * a reset or a power loss (the BLUE flag stays erased, the controller boots
+ * in updater mode) resumes where it stopped.
+ */
+
+#include "bluenrg_types.h"
+#include "bluenrg_def.h"
+#include "bluenrg_aci.h"
+#include "bluenrg_utils.h"
+#include "bluenrg_conf.h"
+#include "hci.h"
+#include "hci_tl.h"
+#include "hci_const.h"
+#include "bluenrg_aci_const.h"
+#include "string.h"
+#include <stdint.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define SUPPORTED_BOOTLOADER_VERSION_MIN  3
+#define SUPPORTED_BOOTLOADER_VERSION_MAX  5
+
+#define BASE_ADDRESS    0x10010000
+
+#define FW_OFFSET       (2*1024)  // 2 KB
+#define FW_OFFSET_MS    0
+#define FULL_STACK_SIZE (66*1024) // 66 KB
+#define SECTOR_SIZE     (2*1024)  // 2 KB
+#define DATA_SIZE       64
+
+#define IFR_SIZE 192
+#define IFR_BASE_ADDRESS 0x10020000
+#define IFR_CONFIG_DATA_OFFSET (SECTOR_SIZE-IFR_SIZE)  // Offset in IFR sector containing configuration data
+#define IFR_WRITE_OFFSET_BEGIN IFR_CONFIG_DATA_OFFSET
+
+#define BLUE_FLAG_OFFSET 0x8C0
+
+#define MAX_ERASE_RETRIES 2
+#define MAX_WRITE_RETRIES 2
+#define MIN_WRITE_BLOCK_SIZE 4
+
+/* Largest data block of a program command that fits in an HCI command */
+#define MAX_WRITE_BLOCK_SIZE ((HCI_MAX_CMD_PARAM_SIZE - UPDATER_PROG_DATA_BLOCK_CP_SIZE) & ~(MIN_WRITE_BLOCK_SIZE - 1))
+
+/* Steps of the commands of a sector */
+#define UPD_STEP_ERASE    0
+#define UPD_STEP_PROGRAM  1
+#define UPD_STEP_CRC      2
+
+#define SECTOR_BIT(s)     ((uint64_t)1 << (s))
+
+#define LE_TO_HOST_16(ptr)   (uint16_t) ( ((uint16_t)*((const uint8_t *)(ptr))) | \
+                                          ((uint16_t)*((const uint8_t *)(ptr) + 1) << 8) )
+
+#define LE_TO_HOST_32(ptr)   (uint32_t) ( ((uint32_t)*((const uint8_t *)(ptr))) | \
+                                          ((uint32_t)*((const uint8_t *)(ptr) + 1) << 8)  | \
+                                          ((uint32_t)*((const uint8_t *)(ptr) + 2) << 16) | \
+                                          ((uint32_t)*((const uint8_t *)(ptr) + 3) << 24) )
+
+#define HOST_TO_LE_16(buf, val)    ( ((buf)[0] =  (uint8_t) (val)    ) , \
+                                     ((buf)[1] =  (uint8_t) ((val)>>8) ) )
+
+#define RETRY_COMMAND(func, num_ret, error)  \
+{                                            \
+  uint8_t num_retries;                       \
+  num_retries = 0;                           \
+  error = 0;                                 \
+  while (num_retries++ < num_ret) {          \
+    if (func == BLE_STATUS_SUCCESS)          \
+      break;                                 \
+    if (num_retries == num_ret)              \
+      error = BLE_UTIL_ACI_ERROR;            \
+  }                                          \
+}
+
+/* Private variables ---------------------------------------------------------*/
+/* Pass of program_device() over a set of sectors */
+static struct {
+  const uint8_t *image;
+  uint32_t size;
+  uint32_t fw_offset;       /* Offset of sector 0, the bootloader sector is never written */
+  uint8_t count;            /* Sectors of the image from fw_offset */
+  uint8_t flag_sector;      /* Sector holding the BLUE flag, always the last of a pass */
+  uint8_t block;            /* Bytes of a program command */
+  uint8_t first_step;       /* UPD_STEP_ERASE, or UPD_STEP_CRC to only compare the sectors */
+  uint8_t step;
+  uint8_t pos;              /* Position in the pass of the sector being queued */
+  uint16_t offset;          /* Next byte of the sector to program */
+  uint8_t outstanding;      /* Commands queued and not completed */
+  uint32_t completed;       /* Completions received, to detect a stalled updater */
+  uint64_t todo;            /* Sectors of the pass */
+  uint64_t failed;          /* Sectors whose CRC does not match the image */
+} upd;
+
+static Updater_stats_TypeDef updater_stats;
+
+/* Private functions ---------------------------------------------------------*/
+/* This function calculates the CRC of a sector of flash, if bytes passed are less than sector size,
+   they are extended with 0xFF until sector size is reached
+*/
+static uint32_t updater_calc_crc(const uint8_t* data, uint16_t nr_of_bytes)
+{
+  uint32_t i, j, a1;
+  uint32_t crc, value;
+
+  crc = 0;
+  for (i = 0; i < SECTOR_SIZE; i += 4) {
+    uint8_t *dataw = (uint8_t *) &value;
+
+    dataw[0] = (i < nr_of_bytes) ? data[i] : 0xFF;
+    dataw[1] = ((i + 1) < nr_of_bytes) ? data[i+1] : 0xFF;
+    dataw[2] = ((i + 2) < nr_of_bytes) ? data[i+2] : 0xFF;
+    dataw[3] = ((i + 3) < nr_of_bytes) ? data[i+3] : 0xFF;
+
+    crc ^= value;
+    for (j = 0; j < 32; j ++) {
+      a1 = (crc >> 31) & 0x1;
+      crc = (crc << 1) ^ (a1 * 0x04c11db7);
+    }
+  }
+  return crc;
+}
+
+/* Enter the updater and check its version */
+static int updater_enter(void)
+{
+  uint8_t version;
+
+  /* No command complete: the controller reboots in updater mode. Ignored when
+     the controller already runs the updater (interrupted update). */
+  aci_updater_start();
+
+  if(aci_get_updater_version(&version))
+    return BLE_UTIL_ACI_ERROR;
+
+  if(version < SUPPORTED_BOOTLOADER_VERSION_MIN || version > SUPPORTED_BOOTLOADER_VERSION_MAX)
+    return BLE_UTIL_UNSUPPORTED_VERSION;
+
+  return BLE_STATUS_SUCCESS;
+}
+
+/* Offset of a sector in the image and in flash from BASE_ADDRESS */
+static uint32_t sector_offset(uint8_t sector)
+{
+  return upd.fw_offset + (uint32_t)sector * SECTOR_SIZE;
+}
+
+/* Bytes of the image in a sector, the last one may be partial */
+static uint16_t sector_len(uint8_t sector)
+{
+  uint32_t offset = sector_offset(sector);
+
+  return (upd.size - offset < SECTOR_SIZE) ? (uint16_t)(upd.size - offset) : SECTOR_SIZE;
+}
+
+/* Sector at a position of a pass: in order, except the BLUE flag sector last */
+static uint8_t sector_at(uint8_t pos)
+{
+  if (upd.flag_sector >= upd.count || pos < upd.flag_sector)
+    return pos;
+  return (pos == upd.count - 1) ? upd.flag_sector : pos + 1;
+}
+
+/* Completion of an erase or program command: a failure is caught by the CRC */
+static void on_cmd_done(uint16_t opcode, uint8_t status, const uint8_t *rparam, uint16_t rlen, void *ctx)
+{
+  upd.outstanding--;
+  upd.completed++;
+  if (status != BLE_STATUS_SUCCESS)
+    updater_stats.cmd_errors++;
+}
+
+/* Completion of the CRC of a sector, compared to the CRC of the image */
+static void on_crc_done(uint16_t opcode, uint8_t status, const uint8_t *rparam, uint16_t rlen, void *ctx)
+{
+  uint8_t sector = (uint8_t)(uintptr_t)ctx;
+  uint32_t crc;
+
+  upd.outstanding--;
+  upd.completed++;
+  if (status != BLE_STATUS_SUCCESS || rlen < UPDATER_CALC_CRC_RP_SIZE) {
+    updater_stats.cmd_errors++;
+    upd.failed |= SECTOR_BIT(sector);
+    return;
+  }
+  crc = LE_TO_HOST_32(rparam + 1);
+  if (crc != updater_calc_crc(upd.image + sector_offset(sector), sector_len(sector)))
+    upd.failed |= SECTOR_BIT(sector);
+}
+
+/* Queue a command of the pass, -1 when the command pipeline is full */
+static int upd_send(uint16_t ocf, const void *cp, uint8_t len, tHciCmdCallback cb, void *ctx)
+{
+  /* cb may be called before returning when the command cannot be sent */
+  upd.outstanding++;
+  if (hci_send_cmd_async(OGF_VENDOR_CMD, ocf, len, cp, cb, ctx) < 0) {
+    upd.outstanding--;
+    return -1;
+  }
+  return 0;
+}
+
+/* Queue the commands of the pass while the command pipeline accepts them */
+static void upd_pump(void)
+{
+  updater_erase_sector_cp erase_cp;
+  updater_prog_data_block_cp prog_cp;
+  updater_calc_crc_cp crc_cp;
+  uint32_t address;
+  uint16_t len;
+  uint8_t sector;
+
+  while (upd.pos < upd.count) {
+    sector = sector_at(upd.pos);
+    if (!(upd.todo & SECTOR_BIT(sector))) {
+      upd.pos++;
+      continue;
+    }
+    address = BASE_ADDRESS + sector_offset(sector);
+
+    switch (upd.step) {
+    case UPD_STEP_ERASE:
+      erase_cp.address = htobl(address);
+      if (upd_send(OCF_UPDATER_ERASE_SECTOR, &erase_cp, UPDATER_ERASE_SECTOR_CP_SIZE, on_cmd_done, NULL) < 0)
+        return;
+      upd.offset = 0;
+      upd.step = UPD_STEP_PROGRAM;
+      break;
+
+    case UPD_STEP_PROGRAM:
+      len = sector_len(sector) - upd.offset;
+      if (len > upd.block)
+        len = upd.block;
+      prog_cp.address = htobl(address + upd.offset);
+      prog_cp.data_len = htobs(len);
+      BLUENRG_memcpy(prog_cp.data, upd.image + sector_offset(sector) + upd.offset, len);
+      if (upd_send(OCF_UPDATER_PROG_DATA_BLOCK, &prog_cp, UPDATER_PROG_DATA_BLOCK_CP_SIZE + len, on_cmd_done, NULL) < 0)
+        return;
+      updater_stats.bytes_written += len;
+      upd.offset += len;
+      if (upd.offset == sector_len(sector))
+        upd.step = UPD_STEP_CRC;
+      break;
+
+    case UPD_STEP_CRC:
+      crc_cp.address = htobl(address);
+      crc_cp.num_sectors = 1;
+      if (upd_send(OCF_UPDATER_CALC_CRC, &crc_cp, UPDATER_CALC_CRC_CP_SIZE, on_crc_done, (void *)(uintptr_t)sector) < 0)
+        return;
+      upd.step = upd.first_step;
+      upd.pos++;
+      break;
+    }
+  }
+}
+
+/* Run a pass over a set of sectors, the sectors that fail are left in upd.failed */
+static int upd_run(uint64_t todo, uint8_t first_step)
+{
+  uint32_t tickstart, completed;
+
+  upd.todo = todo;
+  upd.failed = 0;
+  upd.first_step = first_step;
+  upd.step = first_step;
+  upd.pos = 0;
+
+  tickstart = HAL_GetTick();
+  completed = upd.completed;
+  upd_pump();
+  while (upd.pos < upd.count || upd.outstanding) {
+    hci_user_evt_proc();
+    upd_pump();
+    if (upd.completed != completed) {
+      completed = upd.completed;
+      tickstart = HAL_GetTick();
+    } else if ((HAL_GetTick() - tickstart) > HCI_DEFAULT_TIMEOUT_MS) {
+      return BLE_UTIL_ACI_ERROR;
+    }
+  }
+  return BLE_STATUS_SUCCESS;
+}
+
+static uint8_t count_sectors(uint64_t set)
+{
+  uint8_t n = 0;
+
+  for (; set; set &= set - 1)
+    n++;
+  return n;
+}
+
+static int program_sectors(const uint8_t *fw_image, uint32_t fw_size)
+{
+  uint8_t version, status, buffer_size;
+  uint64_t all, todo;
+  uint32_t tick;
+  int pass;
+
+  status = updater_enter();
+  if (status != BLE_STATUS_SUCCESS)
+    return status;
+
+  if(aci_updater_hw_version(&version))
+    return BLE_UTIL_ACI_ERROR;
+
+  upd.fw_offset = FW_OFFSET;
+  if(version==0x31){
+    // It does not contain bootloader inside first sector. It may contain code.
+    upd.fw_offset = FW_OFFSET_MS;
+  }
+
+  if(aci_get_updater_buffer_size(&buffer_size))
+    return BLE_UTIL_ACI_ERROR;
+  upd.block = MAX_WRITE_BLOCK_SIZE;
+  if (buffer_size < upd.block)
+    upd.block = buffer_size & ~(MIN_WRITE_BLOCK_SIZE - 1);
+  if (upd.block < MIN_WRITE_BLOCK_SIZE)
+    return BLE_UTIL_ACI_ERROR;
+  updater_stats.block_size = upd.block;
+
+  upd.image = fw_image;
+  upd.size = fw_size;
+  upd.count = (fw_size - upd.fw_offset + SECTOR_SIZE - 1) / SECTOR_SIZE;
+  upd.flag_sector = (BLUE_FLAG_OFFSET - upd.fw_offset) / SECTOR_SIZE;
+  updater_stats.sectors = upd.count;
+  all = (upd.count == 64) ? ~(uint64_t)0 : SECTOR_BIT(upd.count) - 1;
+
+  /***********************************************************************
+  * Compare the sectors in flash with the image (resume)
+  ************************************************************************/
+  tick = HAL_GetTick();
+  status = upd_run(all, UPD_STEP_CRC);
+  if (status != BLE_STATUS_SUCCESS)
+    return status;
+  todo = upd.failed;
+  updater_stats.sectors_skipped = upd.count - count_sectors(todo);
+  updater_stats.scan_ms = HAL_GetTick() - tick;
+
+  tick = HAL_GetTick();
+  if (todo) {
+    /***********************************************************************
+    * Erase BLUE flag, the sector holding it must be written again
+    ************************************************************************/
+    RETRY_COMMAND(aci_erase_blue_flag(), MAX_WRITE_RETRIES, status);
+    if (status != BLE_STATUS_SUCCESS)
+      return status;
+    if (upd.flag_sector < upd.count && !(todo & SECTOR_BIT(upd.flag_sector))) {
+      todo |= SECTOR_BIT(upd.flag_sector);
+      updater_stats.sectors_skipped--;
+    }
+
+    /***********************************************************************
+    * Erase, program and verify sectors, again for the ones that fail
+    ************************************************************************/
+    for (pass = 0; todo && pass < MAX_ERASE_RETRIES; pass++) {
+      if (pass > 0)
+        updater_stats.sectors_retried += count_sectors(todo);
+      status = upd_run(todo, UPD_STEP_ERASE);
+      if (status != BLE_STATUS_SUCCESS)
+        return status;
+      todo = upd.failed;
+    }
+    if (todo)
+      return BLE_UTIL_CRC_ERROR;
+  }
+  updater_stats.program_ms = HAL_GetTick() - tick;
+
+  /***********************************************************************
+  * Write BLUE flag
+  ************************************************************************/
+  RETRY_COMMAND(aci_reset_blue_flag(), MAX_WRITE_RETRIES, status);
+  if (status != BLE_STATUS_SUCCESS)
+    return status;
+
+  return BLE_STATUS_SUCCESS;
+}
+
+/* Exported functions --------------------------------------------------------*/
+int program_device(const uint8_t *fw_image, uint32_t fw_size)
+{
+  uint32_t tickstart;
+  int status;
+
+  BLUENRG_memset(&updater_stats, 0, sizeof(updater_stats));
+
+  if (fw_size != FULL_STACK_SIZE)
+    return updater_stats.status = BLE_UTIL_WRONG_IMAGE_SIZE;
+
+  if (fw_size % MIN_WRITE_BLOCK_SIZE)
+    return updater_stats.status = BLE_UTIL_WRONG_IMAGE_SIZE;
+
+  tickstart = HAL_GetTick();
+  status = program_sectors(fw_image, fw_size);
+  if (status == BLE_STATUS_SUCCESS)
+    aci_updater_reboot();
+  updater_stats.total_ms = HAL_GetTick() - tickstart;
+  updater_stats.status = status;
+
+  PRINTF("BlueNRG update: status %d, %lu ms (scan %lu ms, program %lu ms), %lu bytes, %d/%d sectors skipped\r\n",
+         status, updater_stats.total_ms, updater_stats.scan_ms, updater_stats.program_ms,
+         updater_stats.bytes_written, updater_stats.sectors_skipped, updater_stats.sectors);
+
+  return status;
+}
+
+const Updater_stats_TypeDef *getBlueNRGUpdaterStats(void)
+{
+  return &updater_stats;
+}
+
+int read_IFR(uint8_t data[192])
+{
+  uint8_t offset;
+  tBleStatus ret;
+
+  offset = 0;
+  ret = updater_enter();
+  if (ret != BLE_STATUS_SUCCESS)
+    return ret;
+
+  /***********************************************************************
+  * Reading last 3 IFR 64-byte blocks
+  ************************************************************************/
+  for(int i = IFR_CONFIG_DATA_OFFSET; i < SECTOR_SIZE; i += DATA_SIZE){
+    ret = aci_updater_read_data_block(IFR_BASE_ADDRESS+i, DATA_SIZE, (data+offset));
+    offset += DATA_SIZE;
+    if(ret) return BLE_UTIL_ACI_ERROR;
+  }
+
+  aci_updater_reboot();
+
+  return BLE_STATUS_SUCCESS;
+}
+
+uint8_t verify_IFR(const IFR_config_TypeDef *ifr_data)
+{
+  uint8_t ifr_updated[DATA_SIZE];
+  uint8_t ret;
+
+  ret = updater_enter();
+  if (ret != BLE_STATUS_SUCCESS)
+    return ret;
+
+  for(int i = 0; i < IFR_SIZE; i += DATA_SIZE){
+    ret = aci_updater_read_data_block(IFR_BASE_ADDRESS+IFR_CONFIG_DATA_OFFSET+i, DATA_SIZE, ifr_updated);
+    if(ret != BLE_STATUS_SUCCESS){
+      ret = BLE_UTIL_ACI_ERROR;
+      break;
+    }
+    if (memcmp(ifr_updated, ((const uint8_t*)ifr_data)+i, DATA_SIZE) != 0) {
+      ret = BLE_UTIL_WRONG_VERIFY;
+      break;
+    }
+  }
+
+  aci_updater_reboot();
+
+  return ret;
+}
+
+int program_IFR(const IFR_config_TypeDef *ifr_image)
+{
+  uint8_t num_erase_retries;
+  tBleStatus ret;
+  const uint8_t *ifr_data = (const uint8_t *)ifr_image;
+  uint8_t ifr_updated[DATA_SIZE];
+
+  ret = updater_enter();
+  if (ret != BLE_STATUS_SUCCESS)
+    return ret;
+
+  /***********************************************************************
+  * Erase & Flashing IFR sectors
+  ************************************************************************/
+  num_erase_retries = 0;
+  while (num_erase_retries++ < MAX_ERASE_RETRIES) {
+    aci_updater_erase_sector(IFR_BASE_ADDRESS);
+    for(int i = IFR_WRITE_OFFSET_BEGIN, j = 0; i < SECTOR_SIZE; i += DATA_SIZE, j += DATA_SIZE) {
+      RETRY_COMMAND(aci_updater_program_data_block(IFR_BASE_ADDRESS+i, DATA_SIZE, ifr_data+j), MAX_WRITE_RETRIES, ret);
+      if (ret != BLE_STATUS_SUCCESS)
+        break;
+    }
+    if (ret == BLE_STATUS_SUCCESS)
+      break;
+  }
+  if (ret != BLE_STATUS_SUCCESS)
+    return BLE_UTIL_ACI_ERROR;
+
+  /***********************************************************************
+  * Verify IFR
+  ************************************************************************/
+  for(int i = IFR_WRITE_OFFSET_BEGIN, j = 0; i < SECTOR_SIZE; i += DATA_SIZE, j += DATA_SIZE) {
+    ret = aci_updater_read_data_block(IFR_BASE_ADDRESS+i, DATA_SIZE, ifr_updated);
+    if (ret != BLE_STATUS_SUCCESS)
+      return BLE_UTIL_ACI_ERROR;
+    if (memcmp(ifr_updated, ifr_data+j, DATA_SIZE) != 0)
+      return BLE_UTIL_WRONG_VERIFY;
+  }
+
+  aci_updater_reboot();
+
+  return BLE_STATUS_SUCCESS;
+}
+
+void parse_IFR_data_config(const uint8_t data[64], IFR_config2_TypeDef *IFR_config)
+{
+  IFR_config->stack_mode = data[0];
+  IFR_config->slave_sca_ppm = LE_TO_HOST_16(data+28);
+  IFR_config->master_sca = data[30];
+  IFR_config->hs_startup_time = LE_TO_HOST_16(data+32);
+  IFR_config->year = BCD_TO_INT(data[41]);
+  IFR_config->month = BCD_TO_INT(data[42]);
+  IFR_config->day = BCD_TO_INT(data[43]);
+}
+
+int IFR_validate(IFR_config2_TypeDef *IFR_config)
+{
+  if(IFR_config->stack_mode < 1 || IFR_config->stack_mode > 4)
+    return BLE_UTIL_PARSE_ERROR; // Unknown Stack Mode
+  if(IFR_config->master_sca > 7)
+    return BLE_UTIL_PARSE_ERROR; // Invalid Master SCA
+  if(IFR_config->month > 12 || IFR_config->month < 1)
+    return BLE_UTIL_PARSE_ERROR; // Invalid date
+  if(IFR_config->day > 31 || IFR_config->day < 1)
+    return BLE_UTIL_PARSE_ERROR; // Invalid date
+
+  return BLE_STATUS_SUCCESS;
+}
+
+void change_IFR_data_config(IFR_config2_TypeDef *IFR_config, uint8_t data[64])
+{
+  data[0] = IFR_config->stack_mode;
+  HOST_TO_LE_16(data+28, IFR_config->slave_sca_ppm);
+  data[30] = IFR_config->master_sca;
+  HOST_TO_LE_16(data+32, IFR_config->hs_startup_time);
+  data[41] = INT_TO_BCD(IFR_config->year);
+  data[42] = INT_TO_BCD(IFR_config->month);
+  data[43] = INT_TO_BCD(IFR_config->day);
+}
+
+uint8_t getBlueNRGUpdaterVersion(uint8_t *version)
+{
+  aci_updater_start();
+
+  if(aci_get_updater_version(version))
+    return BLE_UTIL_ACI_ERROR;
+
+  aci_updater_reboot();
+
+  if(*version < SUPPORTED_BOOTLOADER_VERSION_MIN || *version > SUPPORTED_BOOTLOADER_VERSION_MAX)
+    return BLE_UTIL_UNSUPPORTED_VERSION;
+
+  return BLE_STATUS_SUCCESS;
+}
@@ -42,6 +42,50 @@ int hci_reset(void)
   return status;  
 }
 
+int hci_set_event_mask(const uint8_t mask[8])
+{
+  struct hci_request rq;
+  set_event_mask_cp cp;
+  uint8_t status;
+  
+  BLUENRG_memcpy(cp.mask, mask, sizeof(cp.mask));
+  
+  BLUENRG_memset(&rq, 0, sizeof(rq));
+  rq.ogf = OGF_HOST_CTL;
+  rq.ocf = OCF_SET_EVENT_MASK;
+  rq.cparam = &cp;
+  rq.clen = SET_EVENT_MASK_CP_SIZE;
+  rq.rparam = &status;
+  rq.rlen = 1;
+  
+  if (hci_send_req(&rq, FALSE) < 0)
+    return BLE_STATUS_TIMEOUT;
+  
+  return status;
+}
+
+int hci_le_set_event_mask(const uint8_t mask[8])
+{
+  struct hci_request rq;
+  le_set_event_mask_cp cp;
+  uint8_t status;
+  
+  BLUENRG_memcpy(cp.mask, mask, sizeof(cp.mask));
+  
+  BLUENRG_memset(&rq, 0, sizeof(rq));
+  rq.ogf = OGF_LE_CTL;
+  rq.ocf = OCF_LE_SET_EVENT_MASK;
+  rq.cparam = &cp;
+  rq.clen = LE_SET_EVENT_MASK_CP_SIZE;
+  rq.rparam = &status;
+  rq.rlen = 1;
+  
+  if (hci_send_req(&rq, FALSE) < 0)
+    return BLE_STATUS_TIMEOUT;
+  
+  return status;
+}
+
 int hci_disconnect(uint16_t handle, uint8_t reason)
 {
   struct hci_request rq;
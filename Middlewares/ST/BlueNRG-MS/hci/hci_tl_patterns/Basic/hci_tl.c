@@ -47,24 +47,112 @@
 #include "hci_const.h"
 #include "hci.h"
 #include "hci_tl.h"
+#include "bluenrg_def.h"
+#include "bluenrg_aci_const.h"
+#include "bluenrg_hal_aci.h"
+#include "bluenrg_gap_aci.h"
+
+#include <stddef.h>
 
 #define HCI_LOG_ON                      0
 #define HCI_PCK_TYPE_OFFSET             0
 #define EVENT_PARAMETER_TOT_LEN_OFFSET  2
 
 /**
- * 增加此参数以克服由于BLE设备拥挤的环境而可能出现的问题
+ * 接收环形缓冲区中的记录：tHciDataPacket 头 + 实际读取的字节，按 4 字节对齐。
+ * 增加 HCI_RX_RING_SIZE 以克服由于BLE设备拥挤的环境而可能出现的问题
  * 或来自外围设备的大量传入通知
  */
-#define HCI_READ_PACKET_NUM_MAX 	   (5)
+#define HCI_RX_REC_ALIGN(n)     (((n) + 3U) & ~3U)
+#define HCI_RX_REC_HDR_SIZE     HCI_RX_REC_ALIGN(sizeof(tHciDataPacket))
+#define HCI_RX_REC_MAX_SIZE     HCI_RX_REC_ALIGN(sizeof(tHciDataPacket) + HCI_READ_PACKET_SIZE)
 
 #define MIN(a,b)      ((a) < (b))? (a) : (b)
 #define MAX(a,b)      ((a) > (b))? (a) : (b)
 
-tListNode             hciReadPktPool;
-tListNode             hciReadPktRxQueue;
-static tHciDataPacket hciReadPacketBuffer[HCI_READ_PACKET_NUM_MAX];
 static tHciContext    hciContext;
+static tHciDataPacket * volatile hciRxPendingPacket = NULL;
+
+/* 接收环形缓冲区：记录在头部按到达顺序分配（IO 总线上下文），释放后从尾部回收（主循环）。
+   head == tail 表示为空，分配时保留间隙使写满时两者不会相等。
+   环形缓冲区同时是中断到主循环的单生产者/单消费者队列：read 之前的记录已取出，
+   read 到 head 之间的记录等待处理。head 只由 IO 总线上下文写（EXTI、DMA 与 PendSV
+   中的读取互斥），read/tail 只由主循环写，因此不需要关中断 */
+static uint32_t          hciRxRing[HCI_RX_RING_SIZE / 4];
+static volatile uint16_t hciRxRingHead;
+static volatile uint16_t hciRxRingTail;
+static uint16_t          hciRxRingRead;
+static uint32_t          hciRxRingCommitted; /* 由 IO 总线上下文累加 */
+static uint32_t          hciRxRingDelivered; /* 由主循环累加 */
+static uint32_t          hciRxRingReclaimed; /* 由主循环累加 */
+static uint32_t          hciRxPutCyclesMax;
+static uint32_t          hciRxGetCyclesMax;
+
+/* 主循环放回的事件（流控暂停、hci_send_req() 等待期间收到的事件），先于环形缓冲区中的事件处理；
+   只在主循环中使用 */
+static tListNode         hciReadPktRequeue;
+static uint16_t          hciReadPktRequeued;
+static uint16_t          hciRxRingUsedMax;
+static uint16_t          hciRxRingRecordsMax;
+
+/* 最近一次命令帧的发送状态：HCI_TX_IN_PROGRESS 或 hci_notify_send_complete() 报告的结果 */
+#define HCI_TX_IN_PROGRESS  (1)
+static volatile int32_t hciTxStatus = 0;
+
+/* hci_cmd_reserve() 预留的发送帧；IO 层没有提供 GetTxBuffer 时使用 hciCmdFallbackFrame */
+static uint8_t *hciCmdFrame = NULL;
+static uint8_t  hciCmdFallbackFrame[HCI_MAX_PAYLOAD_SIZE];
+
+/* hci_user_evt_proc() 正在投递的事件是否被 hci_retain_evt() 保留 */
+static BOOL hciEvtRetained = FALSE;
+
+/* 接收流控：接收环形缓冲区已满时停止读取 BlueNRG，记录回收后通过 DataAck 恢复 */
+static volatile BOOL  hciRxStalled = FALSE;
+static tHciflowStatus hciUserEvtFlow = HCI_DATA_FLOW_ENABLE;
+static tHciFlowStats  hciFlowStats;
+
+/* 接收环形缓冲区已满时，事件暂存于此：[长度低字节][长度高字节][数据] 记录 */
+static uint8_t  hciSpillBuf[HCI_EVT_SPILL_SIZE];
+static uint16_t hciSpillHead;
+static uint16_t hciSpillUsed;
+
+/* 投递暂存事件时使用的数据包，不占用接收环形缓冲区 */
+static uint32_t hciSpillPacketBuf[HCI_RX_REC_MAX_SIZE / 4];
+static tHciDataPacket * const hciSpillPacket = (tHciDataPacket *)hciSpillPacketBuf;
+static BOOL     hciSpillPacketBusy = FALSE;
+
+/* 默认 hci_cmd_resp_wait()/hci_cmd_resp_release() 使用的标志 */
+static volatile uint32_t hciCmdRespFlag = 0;
+
+/* 控制器允许发送的命令数（Num_HCI_Command_Packets），在接收到命令完成/状态事件时更新 */
+static volatile uint8_t hciCmdCredits = 1;
+
+/* 等待信用的异步命令 */
+typedef struct
+{
+  uint16_t        ogf;
+  uint16_t        ocf;
+  uint8_t         plen;
+  uint8_t         param[HCI_MAX_CMD_PARAM_SIZE];
+  tHciCmdCallback cb;
+  void           *ctx;
+} tHciCmdQueued;
+
+/* 已发送、等待完成事件的命令，按发送顺序排列 */
+typedef struct
+{
+  uint16_t        opcode;
+  uint8_t         sync;     /* hci_send_req() 的同步命令 */
+  uint8_t         answered; /* 完成事件已由 hci_send_req() 放入临时队列 */
+  tHciCmdCallback cb;
+  void           *ctx;
+} tHciCmdInflight;
+
+static tHciCmdQueued   hciCmdQueue[HCI_CMD_QUEUE_LEN];
+static uint8_t         hciCmdQueueHead;
+static uint8_t         hciCmdQueueCount;
+static tHciCmdInflight hciCmdInflight[HCI_CMD_INFLIGHT_MAX];
+static uint8_t         hciCmdInflightCount;
 
 /************************* Static internal functions **************************/
 
@@ -94,12 +182,28 @@ static int verify_packet(const tHciDataPacket * hciReadPacket)
   * @param  ocf 操作码命令字段（Opcode Command Field）
   * @param  plen HCI 命令的参数长度
   * @param  param HCI 命令的参数
-  * @retval None
+  * @retval 0 命令帧已交给 IO 层，负值表示失败
   */
-static void send_cmd(uint16_t ogf, uint16_t ocf, uint8_t plen, void *param)
+static int32_t send_cmd(uint16_t ogf, uint16_t ocf, uint8_t plen, void *param)
 {
-  uint8_t payload[HCI_MAX_PAYLOAD_SIZE]; // 定义用于存储 HCI 命令的缓冲区
+  uint8_t *payload; // 发送帧（由 IO 层提供，不再占用栈空间）
+  uint8_t *cmd_param;
   hci_command_hdr hc; // 定义 HCI 命令头结构
+  int32_t ret = -1;
+  uint32_t tickstart;
+  
+  // 参数已由 hci_cmd_reserve() 的调用者直接写入发送帧，否则在这里拷贝一次
+  if ((hciCmdFrame == NULL) || (param != hciCmdFrame + HCI_HDR_SIZE + HCI_COMMAND_HDR_SIZE))
+  {
+    cmd_param = hci_cmd_reserve(plen);
+    if (cmd_param == NULL)
+    {
+      return ret;
+    }
+    BLUENRG_memcpy(cmd_param, param, plen); // 将参数复制到发送帧
+  }
+  payload = hciCmdFrame;
+  hciCmdFrame = NULL;
   
   // 将 OGF 和 OCF 打包成完整的操作码，并转换为小端格式
   hc.opcode = htobs(cmd_opcode_pack(ogf, ocf));
@@ -108,31 +212,409 @@ static void send_cmd(uint16_t ogf, uint16_t ocf, uint8_t plen, void *param)
   // 构建 HCI 命令包
   payload[0] = HCI_COMMAND_PKT; // 设置数据包类型为 HCI 命令包
   BLUENRG_memcpy(payload + 1, &hc, sizeof(hc)); // 将命令头复制到缓冲区
-  BLUENRG_memcpy(payload + HCI_HDR_SIZE + HCI_COMMAND_HDR_SIZE, param, plen); // 将参数复制到缓冲区
   
   // 如果定义了发送函数，则通过底层接口发送命令
   if (hciContext.io.Send)
   {
-    hciContext.io.Send (payload, HCI_HDR_SIZE + HCI_COMMAND_HDR_SIZE + plen);
+    tickstart = HAL_GetTick();
+    do
+    {
+      // 必须在 Send 之前设置：发送可能在 Send 返回前就在中断中完成
+      hciTxStatus = HCI_TX_IN_PROGRESS;
+      ret = hciContext.io.Send (payload, HCI_HDR_SIZE + HCI_COMMAND_HDR_SIZE + plen);
+      // IO 层仍在发送上一帧（异步请求之后），等待其完成
+    } while ((ret == HCI_IO_TX_BUSY) && ((HAL_GetTick() - tickstart) <= HCI_DEFAULT_TIMEOUT_MS));
+    
+    if (ret < 0)
+    {
+      hciTxStatus = ret;
+    }
+  }
+  return ret;
+}
+
+/**
+  * @brief  Offset where a record of the maximum size fits in the receive ring.
+  *
+  * @param  head Head of the ring
+  * @param  tail Tail of the ring
+  * @retval int32_t: Offset of the record, -1 if the ring is full
+  */
+static int32_t rx_ring_room(uint16_t head, uint16_t tail)
+{
+  if (head >= tail)
+  {
+    if ((HCI_RX_RING_SIZE - head) >= HCI_RX_REC_MAX_SIZE)
+    {
+      return head;
+    }
+    /* Wrap: the record must end before the tail, else head == tail when full */
+    return (tail > HCI_RX_REC_MAX_SIZE) ? 0 : -1;
+  }
+  return ((tail - head) > HCI_RX_REC_MAX_SIZE) ? head : -1;
+}
+
+/**
+  * @brief  Whether the receive ring can take a read of the BlueNRG.
+  *
+  * @param  None
+  * @retval BOOL: TRUE if a record of the maximum size fits
+  */
+static BOOL rx_ring_has_room(void)
+{
+  return (rx_ring_room(hciRxRingHead, hciRxRingTail) >= 0);
+}
+
+/**
+  * @brief  Reserve a record of the maximum size at the head of the receive
+  *         ring for the next read. Called from the IO bus context only.
+  *
+  * @param  None
+  * @retval tHciDataPacket*: The record, NULL if the ring is full
+  */
+static tHciDataPacket * rx_ring_reserve(void)
+{
+  uint8_t *ring = (uint8_t *)hciRxRing;
+  uint16_t head = hciRxRingHead;
+  int32_t pos = rx_ring_room(head, hciRxRingTail);
+  tHciDataPacket *pad;
+  
+  if (pos < 0)
+  {
+    return NULL;
+  }
+  
+  if ((pos == 0) && (head != 0))
+  {
+    /* 尾部剩余空间不足：写入已释放的填充记录（放不下记录头时由回收方直接跳过），然后回绕 */
+    if ((HCI_RX_RING_SIZE - head) >= HCI_RX_REC_HDR_SIZE)
+    {
+      pad = (tHciDataPacket *)(ring + head);
+      pad->data_len = 0;
+      pad->rec_size = HCI_RX_RING_SIZE - head;
+      pad->released = TRUE;
+    }
+    __DMB();
+    hciRxRingHead = 0;
   }
+  
+  return (tHciDataPacket *)(ring + pos);
 }
 
 /**
-  * @brief  Remove the tail from a source list and insert it to the head 
-  *         of a destination list.
+  * @brief  Shrink the record reserved by rx_ring_reserve() to the bytes read
+  *         and move the head of the receive ring past it.
+  *
+  * @param  hciReadPacket The record, data_len set
+  * @retval None
+  */
+static void rx_ring_commit(tHciDataPacket * hciReadPacket)
+{
+  uint32_t start = BLUENRG_CYCLES();
+  uint32_t cycles;
+  uint16_t head, tail, used, records;
+  
+  hciReadPacket->rec_size = HCI_RX_REC_ALIGN(sizeof(tHciDataPacket) + hciReadPacket->data_len);
+  hciReadPacket->released = FALSE;
+  head = (uint16_t)((uint8_t *)hciReadPacket - (uint8_t *)hciRxRing) + hciReadPacket->rec_size;
+  
+  /* 记录内容必须先于 head 对主循环可见 */
+  __DMB();
+  hciRxRingHead = head;
+  hciRxRingCommitted++;
+  
+  tail = hciRxRingTail;
+  used = (head >= tail) ? (head - tail) : (HCI_RX_RING_SIZE - tail + head);
+  records = (uint16_t)(hciRxRingCommitted - hciRxRingReclaimed);
+  if (used > hciRxRingUsedMax)
+  {
+    hciRxRingUsedMax = used;
+  }
+  if (records > hciRxRingRecordsMax)
+  {
+    hciRxRingRecordsMax = records;
+  }
+  
+  cycles = BLUENRG_CYCLES() - start;
+  if (cycles > hciRxPutCyclesMax)
+  {
+    hciRxPutCyclesMax = cycles;
+  }
+}
+
+/**
+  * @brief  Take the oldest event to process: the events put back by the main
+  *         loop first, then the next record committed to the receive ring.
+  *
+  * @param  None
+  * @retval tHciDataPacket*: The event, NULL if there is none
+  */
+static tHciDataPacket * rx_queue_get(void)
+{
+  uint32_t start = BLUENRG_CYCLES();
+  uint32_t cycles;
+  uint8_t *ring = (uint8_t *)hciRxRing;
+  uint16_t read = hciRxRingRead;
+  uint16_t head;
+  tHciDataPacket *rec = NULL;
+  
+  if (hciReadPktRequeued != 0)
+  {
+    list_remove_head(&hciReadPktRequeue, (tListNode **)&rec);
+    hciReadPktRequeued--;
+    return rec;
+  }
+  
+  head = hciRxRingHead;
+  /* 记录内容在读取 head 之后访问 */
+  __DMB();
+  while (read != head)
+  {
+    if ((HCI_RX_RING_SIZE - read) < HCI_RX_REC_HDR_SIZE)
+    {
+      read = 0;
+      continue;
+    }
+    rec = (tHciDataPacket *)(ring + read);
+    read += rec->rec_size;
+    if (rec->data_len != 0)
+    {
+      break;
+    }
+    /* 填充记录 */
+    rec = NULL;
+  }
+  hciRxRingRead = read;
+  
+  if (rec != NULL)
+  {
+    hciRxRingDelivered++;
+  }
+  cycles = BLUENRG_CYCLES() - start;
+  if (cycles > hciRxGetCyclesMax)
+  {
+    hciRxGetCyclesMax = cycles;
+  }
+  return rec;
+}
+
+/**
+  * @brief  Put an event taken with rx_queue_get() back in front of the queue.
+  *
+  * @param  hciReadPacket The event
+  * @retval None
+  */
+static void rx_queue_unget(tHciDataPacket * hciReadPacket)
+{
+  list_insert_head(&hciReadPktRequeue, (tListNode *)hciReadPacket);
+  hciReadPktRequeued++;
+}
+
+/**
+  * @brief  Number of events waiting to be processed, in constant time.
+  *
+  * @param  None
+  * @retval uint16_t: Number of events
+  */
+static uint16_t rx_queue_size(void)
+{
+  return hciReadPktRequeued + (uint16_t)(hciRxRingCommitted - hciRxRingDelivered);
+}
+
+/**
+  * @brief  Mark a record as released and move the tail of the receive ring
+  *         past the released records. Records may be released in any order:
+  *         the space is reclaimed once the older ones are released too.
+  *
+  * @param  hciReadPacket The record
+  * @retval None
+  */
+static void rx_ring_release(tHciDataPacket * hciReadPacket)
+{
+  uint8_t *ring = (uint8_t *)hciRxRing;
+  uint16_t tail = hciRxRingTail;
+  tHciDataPacket *rec;
+  
+  hciReadPacket->released = TRUE;
+  
+  while (tail != hciRxRingHead)
+  {
+    if ((HCI_RX_RING_SIZE - tail) < HCI_RX_REC_HDR_SIZE)
+    {
+      tail = 0;
+      continue;
+    }
+    rec = (tHciDataPacket *)(ring + tail);
+    if (!rec->released)
+    {
+      break;
+    }
+    if (rec->data_len != 0)
+    {
+      hciRxRingReclaimed++;
+    }
+    tail += rec->rec_size;
+  }
+  hciRxRingTail = tail;
+}
+
+/**
+  * @brief  Commit a record filled by the IO bus to the receive ring and queue
+  *         it for the application. Empty or malformed packets are not
+  *         committed: the space is reused by the next read.
+  *
+  * @param  hciReadPacket The HCI data packet
+  * @param  data_len Number of bytes read by the IO bus
+  * @retval None
+  */
+static void queue_read_packet(tHciDataPacket * hciReadPacket, int32_t data_len)
+{
+  const uint8_t *evt = hciReadPacket->dataBuff + HCI_HDR_SIZE;
+  
+  if (data_len > 0)
+  {
+    hciReadPacket->data_len = data_len;
+    if (verify_packet(hciReadPacket) == 0)
+    {
+      /* 在接收时就更新命令信用，等待信用的 hci_send_req() 不依赖 hci_user_evt_proc() */
+      if (evt[0] == EVT_CMD_COMPLETE)
+      {
+        hciCmdCredits = ((evt_cmd_complete *)(evt + HCI_EVENT_HDR_SIZE))->ncmd;
+      }
+      else if (evt[0] == EVT_CMD_STATUS)
+      {
+        hciCmdCredits = ((evt_cmd_status *)(evt + HCI_EVENT_HDR_SIZE))->ncmd;
+      }
+
+      rx_ring_commit(hciReadPacket);
+      hci_cmd_resp_release(1);
+    }
+  }
+}
+
+/**
+  * @brief  Give a packet back and resume the reads of the BlueNRG if they
+  *         were stopped on a full receive ring.
+  *
+  * @param  hciReadPacket The HCI data packet
+  * @retval None
+  */
+static void pool_put(tHciDataPacket * hciReadPacket)
+{
+  if (hciReadPacket == hciSpillPacket)
+  {
+    hciSpillPacketBusy = FALSE;
+    return;
+  }
+  rx_ring_release(hciReadPacket);
+  
+  if (hciRxStalled && rx_ring_has_room())
+  {
+    hciRxStalled = FALSE;
+    if (hciContext.io.DataAck)
+    {
+      hciContext.io.DataAck(NULL, NULL);
+    }
+  }
+}
+
+/**
+  * @brief  Low priority events, dropped first when the host runs out of memory:
+  *         advertising reports are repeated by the peers.
+  *
+  * @param  hciReadPacket The HCI data packet
+  * @retval BOOL: TRUE if the event may be dropped
+  */
+static BOOL evt_is_droppable(const tHciDataPacket * hciReadPacket)
+{
+  const hci_event_pckt *event_pckt = (void *)(hciReadPacket->dataBuff + HCI_HDR_SIZE);
+  
+  if (event_pckt->evt == EVT_LE_META_EVENT)
+  {
+    return (((evt_le_meta_event *)event_pckt->data)->subevent == EVT_LE_ADVERTISING_REPORT);
+  }
+  if (event_pckt->evt == EVT_VENDOR)
+  {
+    return (((evt_blue_aci *)event_pckt->data)->ecode == EVT_BLUE_GAP_DEVICE_FOUND);
+  }
+  return FALSE;
+}
+
+/**
+  * @brief  Keep a copy of an event that cannot keep its record, so that the
+  *         ring space can be used to read the BlueNRG. Only low priority events
+  *         or events that do not fit in the spill buffer are dropped.
+  *
+  * @param  hciReadPacket The HCI data packet, still to be given back by the caller
+  * @retval None
+  */
+static void spill_event(const tHciDataPacket * hciReadPacket)
+{
+  uint16_t i, pos;
+  
+  if (evt_is_droppable(hciReadPacket) ||
+      ((hciSpillUsed + 2 + hciReadPacket->data_len) > HCI_EVT_SPILL_SIZE))
+  {
+    hciFlowStats.evt_dropped++;
+    return;
+  }
+  
+  pos = (hciSpillHead + hciSpillUsed) % HCI_EVT_SPILL_SIZE;
+  hciSpillBuf[pos] = (uint8_t)hciReadPacket->data_len;
+  hciSpillBuf[(pos + 1) % HCI_EVT_SPILL_SIZE] = (uint8_t)(hciReadPacket->data_len >> 8);
+  for (i = 0; i < hciReadPacket->data_len; i++)
+  {
+    hciSpillBuf[(pos + 2 + i) % HCI_EVT_SPILL_SIZE] = hciReadPacket->dataBuff[i];
+  }
+  hciSpillUsed += 2 + hciReadPacket->data_len;
+  hciFlowStats.evt_spilled++;
+}
+
+/**
+  * @brief  Move the oldest spilled event into the spill packet.
+  *
+  * @param  None
+  * @retval tHciDataPacket*: The packet, NULL if no event is spilled or the
+  *         spill packet is still held (retained event)
+  */
+static tHciDataPacket * unspill_event(void)
+{
+  tHciDataPacket * hciReadPacket = hciSpillPacket;
+  uint16_t i;
+  
+  if ((hciSpillUsed == 0) || hciSpillPacketBusy)
+  {
+    return NULL;
+  }
+  
+  hciSpillPacketBusy = TRUE;
+  hciReadPacket->data_len = hciSpillBuf[hciSpillHead] |
+                            (hciSpillBuf[(hciSpillHead + 1) % HCI_EVT_SPILL_SIZE] << 8);
+  for (i = 0; i < hciReadPacket->data_len; i++)
+  {
+    hciReadPacket->dataBuff[i] = hciSpillBuf[(hciSpillHead + 2 + i) % HCI_EVT_SPILL_SIZE];
+  }
+  hciSpillHead = (hciSpillHead + 2 + hciReadPacket->data_len) % HCI_EVT_SPILL_SIZE;
+  hciSpillUsed -= 2 + hciReadPacket->data_len;
+  
+  return hciReadPacket;
+}
+
+/**
+  * @brief  Remove the tail from a source list and put it back in front 
+  *         of the receive queue, keeping the order of the list.
   *
-  * @param  dest_list
   * @param  src_list
   * @retval None
   */
-static void move_list(tListNode * dest_list, tListNode * src_list)
+static void move_list(tListNode * src_list)
 {
   pListNode tmp_node;
   
   while (!list_is_empty(src_list))
   {
     list_remove_tail(src_list, &tmp_node);
-    list_insert_head(dest_list, tmp_node);
+    rx_queue_unget((tHciDataPacket *)tmp_node);
   }
 }
 
@@ -146,12 +628,14 @@ static void free_event_list(void)
 {
   tHciDataPacket * pckt;
   
-  // 当空闲的 HCI 数据包池中的节点数量小于最大数量的一半时，释放事件队列中的数据包
-  while(list_get_size(&hciReadPktPool) < HCI_READ_PACKET_NUM_MAX/2) {
+  // 当接收环形缓冲区放不下一次读取时，从最老的记录开始释放事件队列中的数据包
+  // 事件先暂存到溢出缓冲区，由 hci_user_evt_proc() 稍后投递，不直接丢弃
+  while(!rx_ring_has_room() && (rx_queue_size() != 0)) {
     // 从接收队列中移除队列头的数据包
-    list_remove_head(&hciReadPktRxQueue, (tListNode **)&pckt);
-    // 将移除的数据包插入到空闲数据包池的队列尾部
-    list_insert_tail(&hciReadPktPool, (tListNode *)pckt);
+    pckt = rx_queue_get();
+    spill_event(pckt);
+    // 释放记录，回收环形缓冲区空间
+    pool_put(pckt);
   }
 }
 
@@ -159,8 +643,6 @@ static void free_event_list(void)
 
 void hci_init(void(* UserEvtRx)(void* pData), void* pConf)
 {
-  uint8_t index;
-  
   if(UserEvtRx != NULL)
   {
     hciContext.UserEvtRx = UserEvtRx; // 注册 HCI 回调函数
@@ -172,15 +654,14 @@ void hci_init(void(* UserEvtRx)(void* pData), void* pConf)
    */
   hci_tl_lowlevel_init();
   
-  /* 初始化就绪和空闲hci数据包队列的列表头 */
-  list_init_head(&hciReadPktPool);
-  list_init_head(&hciReadPktRxQueue);
-  
-  /* 初始化空闲hci数据包队列，也就是说有 HCI_READ_PACKET_NUM_MAX(5) 个节点可以用来存储数据 */
-  for (index = 0; index < HCI_READ_PACKET_NUM_MAX; index++)
-  {
-    list_insert_tail(&hciReadPktPool, (tListNode *)&hciReadPacketBuffer[index]);
-  } 
+  /* 初始化就绪hci数据包队列的列表头，清空接收环形缓冲区（HCI_RX_RING_SIZE 字节，按实际长度存放事件） */
+  list_init_head(&hciReadPktRequeue);
+  hciReadPktRequeued = 0;
+  hciRxRingHead = 0;
+  hciRxRingTail = 0;
+  hciRxRingRead = 0;
+  hciRxRingDelivered = hciRxRingCommitted;
+  hciRxRingReclaimed = hciRxRingCommitted;
   
   /* 初始化底层驱动 */
   if (hciContext.io.Init)  hciContext.io.Init(NULL); // 初始化 SPI
@@ -196,6 +677,270 @@ void hci_register_io_bus(tHciIO* fops)
   hciContext.io.Send    = fops->Send;
   hciContext.io.GetTick = fops->GetTick;
   hciContext.io.Reset   = fops->Reset;    
+  hciContext.io.GetTxBuffer = fops->GetTxBuffer;
+  hciContext.io.DataAck = fops->DataAck;
+}
+
+/**
+  * @brief  Wait for a controller credit and take it.
+  *
+  * @param  None
+  * @retval None
+  */
+static void cmd_take_credit(void)
+{
+  uint32_t tickstart = HAL_GetTick();
+  uint32_t uwPRIMASK_Bit;
+  
+  while (hciCmdCredits == 0)
+  {
+    /* 完成事件丢失时不永久阻塞：控制器不会超过超时时间仍不处理命令 */
+    if ((HAL_GetTick() - tickstart) > HCI_DEFAULT_TIMEOUT_MS)
+    {
+      hciCmdCredits = 1;
+    }
+  }
+  
+  uwPRIMASK_Bit = __get_PRIMASK();
+  __disable_irq();
+  if (hciCmdCredits > 0)
+  {
+    hciCmdCredits--;
+  }
+  __set_PRIMASK(uwPRIMASK_Bit);
+}
+
+/**
+  * @brief  Give back the credit of a command that did not reach the controller.
+  *
+  * @param  None
+  * @retval None
+  */
+static void cmd_give_credit(void)
+{
+  uint32_t uwPRIMASK_Bit = __get_PRIMASK();
+  
+  __disable_irq();
+  hciCmdCredits++;
+  __set_PRIMASK(uwPRIMASK_Bit);
+}
+
+/**
+  * @brief  Record a command sent and waiting for its completion event.
+  *
+  * @retval int: 0 on success, -1 when HCI_CMD_INFLIGHT_MAX commands are in flight
+  */
+static int cmd_inflight_add(uint16_t opcode, uint8_t sync, tHciCmdCallback cb, void *ctx)
+{
+  tHciCmdInflight *cmd;
+  
+  if (hciCmdInflightCount >= HCI_CMD_INFLIGHT_MAX)
+    return -1;
+  
+  cmd = &hciCmdInflight[hciCmdInflightCount++];
+  cmd->opcode = opcode;
+  cmd->sync = sync;
+  cmd->answered = FALSE;
+  cmd->cb = cb;
+  cmd->ctx = ctx;
+  return 0;
+}
+
+/**
+  * @brief  Remove a command from the in flight list, keeping the send order.
+  */
+static void cmd_inflight_remove(uint8_t index)
+{
+  hciCmdInflightCount--;
+  for (; index < hciCmdInflightCount; index++)
+  {
+    hciCmdInflight[index] = hciCmdInflight[index + 1];
+  }
+}
+
+/**
+  * @brief  Remove the synchronous command from the in flight list.
+  */
+static void cmd_inflight_remove_sync(void)
+{
+  uint8_t i;
+  
+  for (i = 0; i < hciCmdInflightCount; i++)
+  {
+    if (hciCmdInflight[i].sync)
+    {
+      cmd_inflight_remove(i);
+      return;
+    }
+  }
+}
+
+/**
+  * @brief  Find which command a completion event seen by hci_send_req() answers:
+  *         the oldest command with this opcode not answered yet.
+  *
+  * @param  opcode Opcode of the Command Complete/Status event
+  * @retval int: 0 the synchronous command, 1 an asynchronous command (the event
+  *         is left to hci_user_evt_proc()), -1 no command
+  */
+static int cmd_inflight_answer(uint16_t opcode)
+{
+  uint8_t i;
+  
+  for (i = 0; i < hciCmdInflightCount; i++)
+  {
+    if ((hciCmdInflight[i].opcode == opcode) && !hciCmdInflight[i].answered)
+    {
+      hciCmdInflight[i].answered = TRUE;
+      return hciCmdInflight[i].sync ? 0 : 1;
+    }
+  }
+  return -1;
+}
+
+/**
+  * @brief  Give a Command Complete/Status event to the asynchronous command
+  *         it completes.
+  *
+  * @param  hciReadPacket The HCI data packet
+  * @retval int: 1 if the event has been consumed, 0 otherwise
+  */
+static int cmd_complete_async(tHciDataPacket * hciReadPacket)
+{
+  hci_event_pckt *event_pckt = (void *)(hciReadPacket->dataBuff + HCI_HDR_SIZE);
+  uint8_t *ptr = hciReadPacket->dataBuff + (1 + HCI_EVENT_HDR_SIZE);
+  uint16_t len = hciReadPacket->data_len - (1 + HCI_EVENT_HDR_SIZE);
+  const uint8_t *rparam = NULL;
+  uint16_t rlen = 0;
+  uint16_t opcode;
+  uint8_t status;
+  tHciCmdInflight cmd;
+  uint8_t i;
+  
+  if (event_pckt->evt == EVT_CMD_COMPLETE)
+  {
+    opcode = ((evt_cmd_complete *)ptr)->opcode;
+    rparam = ptr + EVT_CMD_COMPLETE_SIZE;
+    rlen = len - EVT_CMD_COMPLETE_SIZE;
+    status = rlen ? rparam[0] : 0;
+  }
+  else if (event_pckt->evt == EVT_CMD_STATUS)
+  {
+    opcode = ((evt_cmd_status *)ptr)->opcode;
+    status = ((evt_cmd_status *)ptr)->status;
+  }
+  else
+  {
+    return 0;
+  }
+  
+  for (i = 0; i < hciCmdInflightCount; i++)
+  {
+    if ((hciCmdInflight[i].opcode == opcode) && !hciCmdInflight[i].sync)
+    {
+      cmd = hciCmdInflight[i];
+      cmd_inflight_remove(i);
+      if (cmd.cb != NULL)
+      {
+        cmd.cb(btohs(opcode), status, rparam, rlen, cmd.ctx);
+      }
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+  * @brief  Send the queued asynchronous commands the controller has credits for.
+  *
+  * @param  None
+  * @retval None
+  */
+static void cmd_pump(void)
+{
+  tHciCmdQueued *cmd;
+  tHciCmdCallback cb;
+  void *ctx;
+  uint16_t opcode;
+  int ret;
+  
+  while ((hciCmdQueueCount > 0) && (hciCmdCredits > 0) && (hciCmdInflightCount < HCI_CMD_INFLIGHT_MAX))
+  {
+    cmd = &hciCmdQueue[hciCmdQueueHead];
+    opcode = htobs(cmd_opcode_pack(cmd->ogf, cmd->ocf));
+    cb = cmd->cb;
+    ctx = cmd->ctx;
+    
+    cmd_take_credit();
+    cmd_inflight_add(opcode, FALSE, cb, ctx);
+    ret = send_cmd(cmd->ogf, cmd->ocf, cmd->plen, cmd->param);
+    
+    /* 先移出队列再调用回调：回调可能再次调用 hci_send_cmd_async()/cmd_pump() */
+    hciCmdQueueHead = (hciCmdQueueHead + 1) % HCI_CMD_QUEUE_LEN;
+    hciCmdQueueCount--;
+    
+    if (ret < 0)
+    {
+      cmd_inflight_remove(hciCmdInflightCount - 1);
+      cmd_give_credit();
+      if (cb != NULL)
+      {
+        cb(btohs(opcode), BLE_STATUS_TIMEOUT, NULL, 0, ctx);
+      }
+    }
+  }
+}
+
+int hci_send_cmd_async(uint16_t ogf, uint16_t ocf, uint8_t plen, const void *param,
+                       tHciCmdCallback cb, void *ctx)
+{
+  tHciCmdQueued *cmd;
+  
+  if ((hciCmdQueueCount >= HCI_CMD_QUEUE_LEN) || (plen > HCI_MAX_CMD_PARAM_SIZE))
+    return -1;
+  
+  cmd = &hciCmdQueue[(hciCmdQueueHead + hciCmdQueueCount) % HCI_CMD_QUEUE_LEN];
+  cmd->ogf = ogf;
+  cmd->ocf = ocf;
+  cmd->plen = plen;
+  BLUENRG_memcpy(cmd->param, param, plen);
+  cmd->cb = cb;
+  cmd->ctx = ctx;
+  hciCmdQueueCount++;
+  
+  cmd_pump();
+  return 0;
+}
+
+uint8_t hci_cmd_pending(void)
+{
+  return hciCmdQueueCount + hciCmdInflightCount;
+}
+
+uint8_t *hci_cmd_reserve(uint16_t plen)
+{
+  uint8_t *frame = hciCmdFallbackFrame;
+  uint32_t tickstart = HAL_GetTick();
+  
+  if (plen > HCI_MAX_CMD_PARAM_SIZE)
+  {
+    return NULL;
+  }
+  
+  if (hciContext.io.GetTxBuffer)
+  {
+    // IO 层仍在发送上一帧（异步请求之后），等待其完成
+    while ((frame = hciContext.io.GetTxBuffer()) == NULL)
+    {
+      if ((HAL_GetTick() - tickstart) > HCI_DEFAULT_TIMEOUT_MS)
+      {
+        return NULL;
+      }
+    }
+  }
+  
+  hciCmdFrame = frame;
+  return frame + HCI_HDR_SIZE + HCI_COMMAND_HDR_SIZE;
 }
 
 /**
@@ -203,12 +948,15 @@ void hci_register_io_bus(tHciIO* fops)
   *
   * @param  r      指向 HCI 请求结构的指针，包含 OGF、OCF、参数和期望的事件
   * @param  async  是否为异步请求（TRUE 表示异步，FALSE 表示同步）
+  * @param  view   非 NULL 时借出响应所在的数据包，不拷贝到 r->rparam
   * @retval 0      成功
   * @retval -1     失败
   */
-int hci_send_req(struct hci_request* r, BOOL async)
+static int send_req(struct hci_request* r, BOOL async, tHciRespView *view)
 {
   uint8_t *ptr; // 指向事件数据的指针，用于遍历接收到的事件包数据
+  uint8_t *rsp = NULL;  // 响应参数在数据包中的位置
+  uint32_t rsp_len = 0; // 响应参数长度
   // 将 OGF（操作组字段）和 OCF（操作字段）打包成操作码 Opcode，
   // 并将其从主机字节序转换为蓝牙协议所需的小端字节序
   uint16_t opcode = htobs(cmd_opcode_pack(r->ogf, r->ocf));
@@ -216,16 +964,33 @@ int hci_send_req(struct hci_request* r, BOOL async)
   hci_uart_pckt *hci_hdr;     // HCI UART 包头结构体指针，用于获取包类型及数据偏移
 
   tHciDataPacket * hciReadPacket = NULL; // 用于存储从底层接收队列中取出的 HCI 数据包
+  tHciDataPacket * pckt;
   tListNode hciTempQueue; // 临时队列节点，用于暂存非当前请求相关的事件包
   
   // 初始化临时队列头，确保队列为空
   list_init_head(&hciTempQueue);
 
   // 释放之前可能残留在接收队列中的数据包，将它们归还给空闲池，防止资源耗尽
-  free_event_list();
+  // 异步命令的完成事件保留在队列中，由 hci_user_evt_proc() 处理
+  if (hciCmdInflightCount == 0)
+  {
+    free_event_list();
+  }
+  
+  // 等待控制器的命令信用
+  cmd_take_credit();
+  
+  // 同步命令也记录在发送列表中，以便区分同一操作码的异步命令的完成事件
+  if (!async && (cmd_inflight_add(opcode, TRUE, NULL, NULL) < 0))
+  {
+    goto not_sent;
+  }
   
   // 发送 HCI 命令，参数包含 OGF、OCF、参数长度和参数内容
-  send_cmd(r->ogf, r->ocf, r->clen, r->cparam);
+  if (send_cmd(r->ogf, r->ocf, r->clen, r->cparam) < 0)
+  {
+    goto not_sent;
+  }
 
   // 如果是异步请求，则不等待响应，直接返回成功
   if (async)
@@ -250,15 +1015,21 @@ int hci_send_req(struct hci_request* r, BOOL async)
       {
         goto failed;
       }
+      // 命令帧没有写入 BlueNRG，不会有响应
+      if (hciTxStatus < 0)
+      {
+        goto not_sent;
+      }
       // 如果有数据包到达，那么跳出循环
-      if (!list_is_empty(&hciReadPktRxQueue)) 
+      if (rx_queue_size() != 0) 
       {
         break;
       }
+      hci_cmd_resp_wait(HCI_DEFAULT_TIMEOUT_MS - (HAL_GetTick() - tickstart));
     }
     
     /* 从 HCI 事件接收队列中取出一个数据包 */
-    list_remove_head(&hciReadPktRxQueue, (tListNode **)&hciReadPacket);    
+    hciReadPacket = rx_queue_get();
     
     // 数据包缓冲区起始地址即为 UART 包头
     hci_hdr = (void *)hciReadPacket->dataBuff;
@@ -277,6 +1048,10 @@ int hci_send_req(struct hci_request* r, BOOL async)
       case EVT_CMD_STATUS: // HCI 命令状态事件
         cs = (void *) ptr;
         
+        // 异步命令的完成事件，留给 hci_user_evt_proc()
+        if (cmd_inflight_answer(cs->opcode) > 0)
+          break;
+        
         if (cs->opcode != opcode)
           goto failed;
         
@@ -287,21 +1062,25 @@ int hci_send_req(struct hci_request* r, BOOL async)
           break;
         }
 
-        r->rlen = MIN(len, r->rlen);
-        BLUENRG_memcpy(r->rparam, ptr, r->rlen);
+        rsp = ptr;
+        rsp_len = len;
         goto done;
       
       case EVT_CMD_COMPLETE: // HCI 命令完成事件
         cc = (void *) ptr;
       
+        // 异步命令的完成事件，留给 hci_user_evt_proc()
+        if (cmd_inflight_answer(cc->opcode) > 0)
+          break;
+      
         if (cc->opcode != opcode)
           goto failed;
       
         ptr += EVT_CMD_COMPLETE_SIZE;
         len -= EVT_CMD_COMPLETE_SIZE;
       
-        r->rlen = MIN(len, r->rlen);
-        BLUENRG_memcpy(r->rparam, ptr, r->rlen);
+        rsp = ptr;
+        rsp_len = len;
         goto done;
       
       case EVT_LE_META_EVENT:
@@ -310,9 +1089,8 @@ int hci_send_req(struct hci_request* r, BOOL async)
         if (me->subevent != r->event)
           break;
       
-        len -= 1;
-        r->rlen = MIN(len, r->rlen);
-        BLUENRG_memcpy(r->rparam, me->data, r->rlen);
+        rsp = me->data;
+        rsp_len = len - 1;
         goto done;
       
       case EVT_HARDWARE_ERROR:            
@@ -323,12 +1101,20 @@ int hci_send_req(struct hci_request* r, BOOL async)
       }
     }
     
-    /* If there are no more packets to be processed, be sure there is at list one
-       packet in the pool to process the expected event.
-       If no free packets are available, discard the processed event and insert it
-       into the pool. */
-    if (list_is_empty(&hciReadPktPool) && list_is_empty(&hciReadPktRxQueue)) {
-      list_insert_tail(&hciReadPktPool, (tListNode *)hciReadPacket);
+    /* If there are no more packets to be processed, be sure the receive ring
+       can take the expected event.
+       If it cannot, the events kept so far and the processed one are copied in
+       the spill buffer (dropped only if they are low priority events or the
+       buffer is full) and their records are released: the oldest ones hold
+       the tail of the ring. */
+    if (!rx_ring_has_room() && (rx_queue_size() == 0)) {
+      while (!list_is_empty(&hciTempQueue)) {
+        list_remove_head(&hciTempQueue, (tListNode **)&pckt);
+        spill_event(pckt);
+        pool_put(pckt);
+      }
+      spill_event(hciReadPacket);
+      pool_put(hciReadPacket);
       hciReadPacket=NULL;
     }
     else {
@@ -341,72 +1127,278 @@ int hci_send_req(struct hci_request* r, BOOL async)
     }
   }
   
+not_sent:
+  // 命令帧没有到达控制器，归还取走的信用
+  cmd_give_credit();
+  
 failed: 
+  // 超时或出错时不会再有完成事件归还信用，下一条命令不必等待超时
+  if (hciCmdCredits == 0)
+  {
+    hciCmdCredits = 1;
+  }
+  cmd_inflight_remove_sync();
   if (hciReadPacket!=NULL) {
-    list_insert_head(&hciReadPktPool, (tListNode *)hciReadPacket);
+    pool_put(hciReadPacket);
   }
-  move_list(&hciReadPktRxQueue, &hciTempQueue);  
+  move_list(&hciTempQueue);  
   return -1;
   
 done:
-  /* Insert the packet back into the pool.*/
-  list_insert_head(&hciReadPktPool, (tListNode *)hciReadPacket); 
-  move_list(&hciReadPktRxQueue, &hciTempQueue);
+  cmd_inflight_remove_sync();
+  if (view != NULL)
+  {
+    /* The record is not reclaimed until hci_release_resp() */
+    view->data = rsp;
+    view->len = rsp_len;
+    view->pkt = hciReadPacket;
+  }
+  else
+  {
+    r->rlen = MIN(rsp_len, r->rlen);
+    BLUENRG_memcpy(r->rparam, rsp, r->rlen);
+    
+    /* Insert the packet back into the pool.*/
+    pool_put(hciReadPacket); 
+  }
+  move_list(&hciTempQueue);
   return 0;
 }
 
+int hci_send_req(struct hci_request* r, BOOL async)
+{
+  return send_req(r, async, NULL);
+}
+
+int hci_send_req_borrow(struct hci_request* r, tHciRespView *view)
+{
+  return send_req(r, FALSE, view);
+}
+
+void hci_release_resp(tHciRespView *view)
+{
+  if (view->pkt != NULL)
+  {
+    pool_put(view->pkt);
+  }
+  view->data = NULL;
+  view->len = 0;
+  view->pkt = NULL;
+}
+
+void hci_retain_evt(void)
+{
+  hciEvtRetained = TRUE;
+}
+
+void hci_release_evt(void *pdata)
+{
+  tHciDataPacket * hciReadPacket;
+  
+  hciReadPacket = (tHciDataPacket *)((uint8_t *)pdata - offsetof(tHciDataPacket, dataBuff));
+  pool_put(hciReadPacket);
+}
+
+/**
+  * @brief  Track the events lost by the controller and report them.
+  *
+  * @param  hciReadPacket The HCI data packet
+  * @retval None
+  */
+static void check_events_lost(const tHciDataPacket * hciReadPacket)
+{
+  const hci_event_pckt *event_pckt = (void *)(hciReadPacket->dataBuff + HCI_HDR_SIZE);
+  const evt_blue_aci *blue_evt = (void *)event_pckt->data;
+  const evt_hal_events_lost_IDB05A1 *lost;
+  uint8_t i;
+  
+  if ((event_pckt->evt != EVT_VENDOR) || (blue_evt->ecode != EVT_BLUE_HAL_EVENTS_LOST_IDB05A1))
+  {
+    return;
+  }
+  
+  lost = (void *)blue_evt->data;
+  hciFlowStats.ctrl_evt_lost++;
+  for (i = 0; i < sizeof(hciFlowStats.lost_events); i++)
+  {
+    hciFlowStats.lost_events[i] |= lost->lost_events[i];
+  }
+  hci_events_lost_cb(lost->lost_events);
+}
+
 void hci_user_evt_proc(void)
 {
   tHciDataPacket * hciReadPacket = NULL;
      
-  /* process any pending events read */
-  while (list_is_empty(&hciReadPktRxQueue) == FALSE)
+  /* process any pending events read, the spilled ones first */
+  while (hciUserEvtFlow == HCI_DATA_FLOW_ENABLE)
   {
-    list_remove_head (&hciReadPktRxQueue, (tListNode **)&hciReadPacket);
+    hciReadPacket = unspill_event();
+    if (hciReadPacket == NULL)
+    {
+      hciReadPacket = rx_queue_get();
+      if (hciReadPacket == NULL)
+      {
+        break;
+      }
+    }
+    hciEvtRetained = FALSE;
+    
+    /* Completion of an asynchronous command: given to its callback */
+    if (cmd_complete_async(hciReadPacket))
+    {
+      pool_put(hciReadPacket);
+      continue;
+    }
+    
+    check_events_lost(hciReadPacket);
+    
     if (hciContext.UserEvtRx != NULL)
     {
       hciContext.UserEvtRx(hciReadPacket->dataBuff);
     }
-    list_insert_tail(&hciReadPktPool, (tListNode *)hciReadPacket);
+    
+    /* Not processed by the application: delivered again on hci_resume_flow() */
+    if (hciUserEvtFlow == HCI_DATA_FLOW_DISABLE)
+    {
+      rx_queue_unget(hciReadPacket);
+      break;
+    }
+    
+    /* A retained event is given back by hci_release_evt() */
+    if (hciEvtRetained == FALSE)
+    {
+      pool_put(hciReadPacket);
+    }
   }
+  
+  /* Send the asynchronous commands waiting for a credit */
+  cmd_pump();
 }
 
 int32_t hci_notify_asynch_evt(void* pdata)
 {
   tHciDataPacket * hciReadPacket = NULL;
-  uint8_t data_len;
+  int32_t data_len;
   
   int32_t ret = 0;
   
-  if (list_is_empty (&hciReadPktPool) == FALSE)
+  /* 上一次接收（DMA）尚未完成，由 hci_notify_receive_complete() 继续处理 */
+  if (hciRxPendingPacket != NULL)
+  {
+    return 1;
+  }
+  
+  /* 接收环形缓冲区已满：停止读取，BlueNRG 保留数据直到记录被回收（pool_put） */
+  hciRxStalled = TRUE;
+  hciReadPacket = rx_ring_reserve();
+  if (hciReadPacket != NULL)
   {
-    /* Queuing a packet to read */
-    list_remove_head (&hciReadPktPool, (tListNode **)&hciReadPacket);
+    hciRxStalled = FALSE;
     
     if (hciContext.io.Receive)
     {
+      /* The packet is owned by the IO bus until the transfer completes.
+         Set before the receive: a higher priority DMA interrupt may report
+         the completion before Receive() returns */
+      hciRxPendingPacket = hciReadPacket;
       data_len = hciContext.io.Receive(hciReadPacket->dataBuff, HCI_READ_PACKET_SIZE);
-      if (data_len > 0)
-      {                    
-        hciReadPacket->data_len = data_len;
-        if (verify_packet(hciReadPacket) == 0)
-          list_insert_tail(&hciReadPktRxQueue, (tListNode *)hciReadPacket);
-        else
-          list_insert_head(&hciReadPktPool, (tListNode *)hciReadPacket);          
+      if (data_len == HCI_IO_RX_PENDING)
+      {
+        ret = 1;
       }
-      else 
+      else
       {
-        /* Insert the packet back into the pool*/
-        list_insert_head(&hciReadPktPool, (tListNode *)hciReadPacket);
+        hciRxPendingPacket = NULL;
+        queue_read_packet(hciReadPacket, data_len);
       }
     }
   }
   else 
   {
+    hciFlowStats.rx_stalls++;
     ret = 1;
   }
   return ret;
 
 }
 
+void hci_notify_receive_complete(int32_t len)
+{
+  tHciDataPacket * hciReadPacket = hciRxPendingPacket;
+  
+  if (hciReadPacket != NULL)
+  {
+    hciRxPendingPacket = NULL;
+    queue_read_packet(hciReadPacket, len);
+  }
+}
+
+void hci_notify_send_complete(int32_t status)
+{
+  hciTxStatus = status;
+}
+
+void hci_stop_flow(void)
+{
+  hciUserEvtFlow = HCI_DATA_FLOW_DISABLE;
+}
+
+void hci_resume_flow(void)
+{
+  hciUserEvtFlow = HCI_DATA_FLOW_ENABLE;
+}
+
+void hci_get_flow_stats(tHciFlowStats *stats)
+{
+  *stats = hciFlowStats;
+}
+
+void hci_reset_flow_stats(void)
+{
+  BLUENRG_memset(&hciFlowStats, 0, sizeof(hciFlowStats));
+}
+
+void hci_get_rx_ring_stats(tHciRxRingStats *stats)
+{
+  uint16_t head = hciRxRingHead;
+  uint16_t tail = hciRxRingTail;
+  
+  stats->size = HCI_RX_RING_SIZE;
+  stats->used = (head >= tail) ? (head - tail) : (HCI_RX_RING_SIZE - tail + head);
+  stats->used_max = hciRxRingUsedMax;
+  stats->records = (uint16_t)(hciRxRingCommitted - hciRxRingReclaimed);
+  stats->records_max = hciRxRingRecordsMax;
+  stats->pending = rx_queue_size();
+  stats->put_cycles_max = hciRxPutCyclesMax;
+  stats->get_cycles_max = hciRxGetCyclesMax;
+}
+
+void hci_reset_rx_ring_stats(void)
+{
+  hciRxRingUsedMax = 0;
+  hciRxRingRecordsMax = 0;
+  hciRxPutCyclesMax = 0;
+  hciRxGetCyclesMax = 0;
+}
+
+__weak void hci_events_lost_cb(const uint8_t lost_events[8])
+{
+}
+
+__weak void hci_cmd_resp_wait(uint32_t timeout)
+{
+  uint32_t tickstart = HAL_GetTick();
+  
+  while (!hciCmdRespFlag && ((HAL_GetTick() - tickstart) < timeout))
+  {
+  }
+  hciCmdRespFlag = 0;
+}
+
+__weak void hci_cmd_resp_release(uint32_t flag)
+{
+  hciCmdRespFlag = flag;
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -58,19 +58,99 @@ struct hci_request {
  */
  
 /**
- * @brief Structure used to read received HCI data packet
+ * @brief Structure used to read received HCI data packet: header of a record
+ *        of the receive ring, followed by the data_len bytes read
  * @{
  */
 typedef struct _tHciDataPacket
 {
   tListNode currentNode;
-  uint8_t dataBuff[HCI_READ_PACKET_SIZE];
-  uint8_t data_len;
+  uint16_t data_len;
+  uint16_t rec_size;  /**< 记录在接收环形缓冲区中占用的字节数（含本结构体） */
+  uint8_t  released;  /**< 记录已释放，等待从环形缓冲区尾部回收 */
+  uint8_t  dataBuff[]; /**< 最多 HCI_READ_PACKET_SIZE 字节 */
 } tHciDataPacket;
 /**
  * @}
  */
 
+/**
+ * @brief 借用的命令响应：直接指向接收池数据包中的响应参数（不拷贝），
+ *        使用完后必须调用 hci_release_resp() 释放，否则接收环形缓冲区无法回收该记录之后的空间
+ * @{
+ */
+typedef struct
+{
+  const uint8_t  *data; /**< 响应参数，与 hci_send_req() 拷贝到 rparam 的字节相同 */
+  uint16_t        len;  /**< 响应参数的实际长度，读取 data 前必须检查 */
+  tHciDataPacket *pkt;  /**< 持有响应的数据包 */
+} tHciRespView;
+/**
+ * @}
+ */
+
+/**
+ * @brief tHciIO.Receive 的返回值：传输已启动但尚未完成（例如 DMA），
+ *        完成后由 IO 层调用 hci_notify_receive_complete() 通知 HCI 层
+ */
+#define HCI_IO_RX_PENDING   (-1)
+
+/**
+ * @brief tHciIO.Send 的返回值：IO 层仍持有上一帧，尚未发送完成。
+ *        tHciIO.Send 返回 0 只表示帧已被接收，发送结果由 IO 层
+ *        调用 hci_notify_send_complete() 通知 HCI 层
+ */
+#define HCI_IO_TX_BUSY      (-4)
+
+/**
+ * @brief 一条命令最多可携带的参数长度：发送帧去掉包类型（1 字节）和命令头（3 字节）
+ */
+#define HCI_MAX_CMD_PARAM_SIZE  (HCI_MAX_PAYLOAD_SIZE - 4)
+
+/**
+ * @brief HCI 接收流控统计
+ * @{
+ */
+typedef struct
+{
+  uint32_t rx_stalls;       /**< 接收池耗尽、停止读取 BlueNRG 的次数 */
+  uint32_t evt_spilled;     /**< 没有空闲数据包时暂存到溢出缓冲区的事件数 */
+  uint32_t evt_dropped;     /**< 丢弃的事件数（仅低优先级事件，或溢出缓冲区已满） */
+  uint32_t ctrl_evt_lost;   /**< 收到 EVT_BLUE_HAL_EVENTS_LOST_IDB05A1 的次数 */
+  uint8_t  lost_events[8];  /**< 控制器报告丢失的事件位图（累计），详见 @ref Lost_Events */
+} tHciFlowStats;
+/**
+ * @}
+ */
+
+/**
+ * @brief HCI 接收环形缓冲区统计
+ * @{
+ */
+typedef struct
+{
+  uint16_t size;         /**< 环形缓冲区大小（字节），HCI_RX_RING_SIZE */
+  uint16_t used;         /**< 当前占用的字节数（含记录头和对齐） */
+  uint16_t used_max;     /**< 占用字节数的最大值 */
+  uint16_t records;      /**< 当前未回收的事件数 */
+  uint16_t records_max;  /**< 未回收事件数的最大值 */
+  uint16_t pending;      /**< 等待 hci_user_evt_proc()/hci_send_req() 处理的事件数 */
+  uint32_t put_cycles_max; /**< 中断中提交一个事件的最大周期数（BLUENRG_STATS） */
+  uint32_t get_cycles_max; /**< 主循环取出一个事件的最大周期数（BLUENRG_STATS） */
+} tHciRxRingStats;
+/**
+ * @}
+ */
+
+/**
+ * @brief 异步命令完成回调，在 hci_user_evt_proc() 中调用
+ *        opcode: 命令操作码；status: 命令状态（Command Complete 返回参数的第一个字节或
+ *        Command Status 中的状态，发送失败时为 BLE_STATUS_TIMEOUT）；
+ *        rparam/rlen: Command Complete 的返回参数（包含状态字节），Command Status 时为 NULL/0；
+ *        ctx: hci_send_cmd_async() 传入的用户参数
+ */
+typedef void (* tHciCmdCallback)(uint16_t opcode, uint8_t status, const uint8_t *rparam, uint16_t rlen, void *ctx);
+
 /**
  * @brief Structure used to manage the BUS IO operations.
  *        All the structure fields will point to functions defined at user level.
@@ -83,8 +163,9 @@ typedef struct
   int32_t (* Reset)   (void); /**< 指向HCI TL函数的指针，用于IO总线复位 */    
   int32_t (* Receive) (uint8_t*, uint16_t); /**< 指向用于IO总线数据接收的HCI TL函数的指针 */
   int32_t (* Send)    (uint8_t*, uint16_t); /**< 指向HCI TL函数的指针，用于IO总线数据传输 */
-  int32_t (* DataAck) (uint8_t*, uint16_t* len); /**< 指向用于IO总线数据接收的HCI TL函数的指针 */	
+  int32_t (* DataAck) (uint8_t*, uint16_t* len); /**< 指向HCI TL函数的指针，接收池有空闲数据包后通知IO总线恢复接收，参数可为 NULL */	
   int32_t (* GetTick) (void); /**< 指向BSP函数的指针，用于获取HAL时间基时间戳 */    
+  uint8_t* (* GetTxBuffer) (void); /**< 指向HCI TL函数的指针，返回IO层的发送帧（HCI_MAX_PAYLOAD_SIZE 字节），IO层仍在发送上一帧时返回 NULL；可为 NULL */
 } tHciIO;
 /**
  * @}
@@ -133,6 +214,88 @@ typedef struct
   * @retval int: 0 when success, -1 when failure
   */
 int hci_send_req(struct hci_request *r, BOOL async);
+
+/**
+  * @brief  Send an HCI request in synchronous mode and borrow the response
+  *         in place instead of copying it into r->rparam (r->rparam and 
+  *         r->rlen are not used).
+  *         The record holding the response is not reclaimed until
+  *         hci_release_resp() is called.
+  *
+  * @param  r: The HCI request
+  * @param  view: Filled with the response parameters on success
+  * @retval int: 0 when success, -1 when failure (nothing to release)
+  */
+int hci_send_req_borrow(struct hci_request *r, tHciRespView *view);
+
+/**
+  * @brief  Reserve the parameters of the next command in the transport TX frame.
+  *         The caller serializes the parameters in the returned buffer and
+  *         passes it as r->cparam to hci_send_req(): the command header is
+  *         written in front of it and the frame goes to tHciIO.Send without
+  *         any copy. Waits up to HCI_DEFAULT_TIMEOUT_MS for the transport to
+  *         release the previous frame.
+  *
+  * @param  plen: Length of the parameters, at most HCI_MAX_CMD_PARAM_SIZE
+  * @retval uint8_t*: Parameter buffer, NULL if plen is too long or on timeout
+  */
+uint8_t *hci_cmd_reserve(uint16_t plen);
+
+/**
+  * @brief  Send an HCI command without waiting for its completion.
+  *         The command is sent as soon as the controller grants a credit
+  *         (Num_HCI_Command_Packets of the last Command Complete/Status event),
+  *         meanwhile the parameters are kept in a queue of HCI_CMD_QUEUE_LEN 
+  *         entries. The Command Complete or Command Status event is matched by 
+  *         opcode and given to cb from hci_user_evt_proc() instead of UserEvtRx().
+  *         Only for commands completed by Command Complete or Command Status.
+  *
+  * @param  ogf: Opcode Group Field
+  * @param  ocf: Opcode Command Field
+  * @param  plen: Length of the parameters, at most HCI_MAX_CMD_PARAM_SIZE
+  * @param  param: The parameters, copied before returning
+  * @param  cb: Completion callback, may be NULL
+  * @param  ctx: User parameter passed to cb
+  * @retval int: 0 when the command is sent or queued, -1 when the queue is full
+  */
+int hci_send_cmd_async(uint16_t ogf, uint16_t ocf, uint8_t plen, const void *param,
+                       tHciCmdCallback cb, void *ctx);
+
+/**
+  * @brief  Number of asynchronous commands queued or waiting for their completion.
+  *
+  * @param  None
+  * @retval uint8_t: Number of commands
+  */
+uint8_t hci_cmd_pending(void);
+
+/**
+  * @brief  Release the record borrowed by hci_send_req_borrow().
+  *
+  * @param  view: The borrowed response, cleared on return
+  * @retval None
+  */
+void hci_release_resp(tHciRespView *view);
+
+/**
+  * @brief  Keep the event being delivered to UserEvtRx() in the receive ring
+  *         after the callback returns, e.g. to process it later without a copy.
+  *         Must be called from UserEvtRx(); each retained event must be given
+  *         back with hci_release_evt(). A retained event holds the space of the
+  *         receive ring from its record onwards until it is released.
+  *
+  * @param  None
+  * @retval None
+  */
+void hci_retain_evt(void);
+
+/**
+  * @brief  Release an event retained with hci_retain_evt().
+  *
+  * @param  pdata: The pointer passed to UserEvtRx()
+  * @retval None
+  */
+void hci_release_evt(void *pdata);
  
 /**
  * @brief  Register IO bus services.
@@ -190,6 +353,28 @@ void hci_register_io_bus(tHciIO* fops);
  */
 int32_t hci_notify_asynch_evt(void* pdata);
 
+/**
+ * @brief  Must be called by the IO bus layer when a receive that tHciIO.Receive 
+ *         left pending (HCI_IO_RX_PENDING) has completed, e.g. from the DMA 
+ *         transfer complete interrupt.
+ *         The packet is verified and queued exactly as a synchronous receive.
+ *
+ * @param  len Number of bytes stored in the receive buffer, 0 if the transfer failed
+ * @retval None
+ */
+void hci_notify_receive_complete(int32_t len);
+
+/**
+ * @brief  Must be called by the IO bus layer when the frame accepted by 
+ *         tHciIO.Send has been written to the BlueNRG or given up.
+ *         A synchronous hci_send_req() fails as soon as the write fails 
+ *         instead of waiting for HCI_DEFAULT_TIMEOUT_MS.
+ *
+ * @param  status 0 if the frame has been written, a negative value otherwise
+ * @retval None
+ */
+void hci_notify_send_complete(int32_t status);
+
 /**
  * @brief  This function resume the User Event Flow which has been stopped on return 
  *         from UserEvtRx() when the User Event has not been processed.
@@ -199,11 +384,67 @@ int32_t hci_notify_asynch_evt(void* pdata);
  */
 void hci_resume_flow(void);
 
+/**
+ * @brief  Called from UserEvtRx() when the event cannot be processed now:
+ *         the event is kept at the head of the queue and hci_user_evt_proc()
+ *         stops delivering events until hci_resume_flow() is called.
+ *         While the events are held the BlueNRG is read until the receive
+ *         ring is full, then the reads stop until records are released.
+ *
+ * @param  None
+ * @retval None
+ */
+void hci_stop_flow(void);
+
+/**
+ * @brief  Called by the HCI layer when the controller reports lost events
+ *         (EVT_BLUE_HAL_EVENTS_LOST_IDB05A1), before the event is given to
+ *         UserEvtRx(). Weak, to be implemented by the application to recover
+ *         e.g. a lost disconnection.
+ *
+ * @param  lost_events: Bitmap of the lost events, see @ref Lost_Events
+ * @retval None
+ */
+void hci_events_lost_cb(const uint8_t lost_events[8]);
+
+/**
+ * @brief  Get the receive flow control statistics.
+ *
+ * @param  stats: Filled with the statistics collected since the last reset
+ * @retval None
+ */
+void hci_get_flow_stats(tHciFlowStats *stats);
+
+/**
+ * @brief  Reset the receive flow control statistics.
+ *
+ * @param  None
+ * @retval None
+ */
+void hci_reset_flow_stats(void);
+
+/**
+ * @brief  Get the occupancy of the receive ring.
+ *
+ * @param  stats: Filled with the current occupancy and the high-water marks
+ * @retval None
+ */
+void hci_get_rx_ring_stats(tHciRxRingStats *stats);
+
+/**
+ * @brief  Reset the high-water marks of the receive ring.
+ *
+ * @param  None
+ * @retval None
+ */
+void hci_reset_rx_ring_stats(void);
+
 /**
  * @brief  This function is called when an ACI/HCI command is sent and the response 
  *         is waited from the BLE core.
  *         The application shall implement a mechanism to not return from this function 
  *         until the waited event is received.
+ *         Weak: the default implementation spins until a packet is queued.
  *         This is notified to the application with hci_cmd_resp_release().
  *         It is called from the same context the HCI command has been sent.
  *
@@ -215,6 +456,8 @@ void hci_cmd_resp_wait(uint32_t timeout);
 /**
  * @brief  This function is called when an ACI/HCI command is sent and the response is
  *         received from the BLE core.
+ *         Called by the HCI layer, from the IO bus context, for every packet queued.
+ *         Weak: the default implementation releases the default hci_cmd_resp_wait().
  *
  * @param  flag: Release flag
  * @retval None
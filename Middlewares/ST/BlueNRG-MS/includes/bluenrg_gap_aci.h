@@ -567,6 +567,35 @@ tBleStatus aci_gap_delete_ad_type(uint8_t ad_type);
 tBleStatus aci_gap_get_security_level(uint8_t* mitm_protection, uint8_t* bonding,
                                       uint8_t* oob_data, uint8_t* passkey_required);
 
+/**
+ * @anchor GAP_Event_Mask
+ * @name GAP event mask
+ * Bits of aci_gap_set_event_mask(). The L2CAP events reported to the host
+ * are masked with the same command.
+ * @{
+ */
+#define GAP_LIMITED_DISCOVERABLE_EVT_MASK     (0x0001)
+#define GAP_PAIRING_CMPLT_EVT_MASK            (0x0002)
+#define GAP_PASS_KEY_REQUEST_EVT_MASK         (0x0004)
+#define GAP_AUTHORIZATION_REQUEST_EVT_MASK    (0x0008)
+#define GAP_SLAVE_SECURITY_INITIATED_EVT_MASK (0x0010)
+#define GAP_BOND_LOST_EVT_MASK                (0x0020)
+#define GAP_PROCEDURE_COMPLETE_EVT_MASK       (0x0080)
+#define L2CAP_CONN_UPD_RESP_EVT_MASK          (0x0100)
+#define L2CAP_PROCEDURE_TIMEOUT_EVT_MASK      (0x0200)
+#define GAP_ADDR_NOT_RESOLVED_EVT_MASK        (0x0400)
+/**
+ * @}
+ */
+
+/**
+ * @brief Select the GAP and L2CAP events reported by the controller.
+ * @param event_mask Bitmask of the events, see @ref GAP_Event_Mask. A masked
+ * 		  event is not sent to the host at all.
+ * @return Value indicating success or error code.
+ */
+tBleStatus aci_gap_set_event_mask(uint16_t event_mask);
+
 /**
  * @brief Add addresses of bonded devices into the controller's whitelist.
  * @note  The command will return an error if there are no devices in the database or if it was unable
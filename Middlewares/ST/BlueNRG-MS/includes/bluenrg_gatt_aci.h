@@ -764,6 +764,42 @@ tBleStatus aci_gatt_update_char_value_ext_IDB05A1(uint16_t service_handle, uint1
                                                   uint16_t value_offset, uint8_t value_length,
                                                   const uint8_t* value);
 
+/**
+ * @anchor GATT_Event_Mask
+ * @name GATT event mask
+ * Bits of aci_gatt_set_event_mask(). The permit requests and the server
+ * confirmation are not masked: they are only raised when requested.
+ * @{
+ */
+#define GATT_ATTRIBUTE_MODIFIED_EVT_MASK        (0x00000001)
+#define GATT_PROCEDURE_TIMEOUT_EVT_MASK         (0x00000002)
+#define ATT_EXCHANGE_MTU_RESP_EVT_MASK          (0x00000004)
+#define ATT_FIND_INFORMATION_RESP_EVT_MASK      (0x00000008)
+#define ATT_FIND_BY_TYPE_VAL_RESP_EVT_MASK      (0x00000010)
+#define ATT_READ_BY_TYPE_RESP_EVT_MASK          (0x00000020)
+#define ATT_READ_RESP_EVT_MASK                  (0x00000040)
+#define ATT_READ_BLOB_RESP_EVT_MASK             (0x00000080)
+#define ATT_READ_MULTIPLE_RESP_EVT_MASK         (0x00000100)
+#define ATT_READ_BY_GROUP_TYPE_RESP_EVT_MASK    (0x00000200)
+#define ATT_WRITE_RESP_EVT_MASK                 (0x00000400)
+#define ATT_PREPARE_WRITE_RESP_EVT_MASK         (0x00000800)
+#define ATT_EXEC_WRITE_RESP_EVT_MASK            (0x00001000)
+#define GATT_INDICATION_EVT_MASK                (0x00002000)
+#define GATT_NOTIFICATION_EVT_MASK              (0x00004000)
+#define GATT_ERROR_RESP_EVT_MASK                (0x00008000)
+#define GATT_PROCEDURE_COMPLETE_EVT_MASK        (0x00010000)
+#define GATT_DISC_READ_CHAR_BY_UUID_RESP_EVT_MASK (0x00020000)
+#define GATT_TX_POOL_AVAILABLE_EVT_MASK         (0x00040000)
+/**
+ * @}
+ */
+
+/**
+ * @brief Select the GATT events reported by the controller.
+ * @param event_mask Bitmask of the events, see @ref GATT_Event_Mask. A masked
+ * 		  event is not sent to the host at all.
+ * @return Value indicating success or error code.
+ */
 tBleStatus aci_gatt_set_event_mask(uint32_t event_mask);
 
 /**
@@ -61,6 +61,22 @@ typedef __packed struct{
   uint32_t unused[5];
 } PACKED IFR_config_TypeDef;
 
+/**
+ * Statistics of the last program_device() call, see getBlueNRGUpdaterStats().
+ */
+typedef struct{
+  int status;               /* Return value of program_device() */
+  uint32_t total_ms;        /* From the entry in the updater to the reboot */
+  uint32_t scan_ms;         /* CRC of the sectors in flash, compared to the image */
+  uint32_t program_ms;      /* Erase, program and CRC of the sectors written */
+  uint32_t bytes_written;
+  uint32_t cmd_errors;      /* Erase, program or CRC commands that failed */
+  uint8_t block_size;       /* Bytes of each program command */
+  uint8_t sectors;          /* Sectors of the image */
+  uint8_t sectors_skipped;  /* Sectors already holding the image (resumed update) */
+  uint8_t sectors_retried;  /* Sectors written again after a CRC mismatch */
+} Updater_stats_TypeDef;
+
 /* Exported constants --------------------------------------------------------*/
 extern const IFR_config_TypeDef IFR_config;
 
@@ -92,12 +108,23 @@ extern const IFR_config_TypeDef IFR_config;
   *                      little-endian).
   * @param  fw_size      Size of the firmware image. The firmware image size shall
   *                      be multiple of 4 bytes.
+  * @note   The image is streamed with asynchronous commands, the events
+  *         are processed by hci_user_evt_proc() until the end. The sectors
+  *         already holding the image are skipped, so an interrupted update
+  *         is resumed by calling program_device() again. The controller
+  *         reboots on success and sends EVT_BLUE_HAL_INITIALIZED.
   * @retval int      It returns 0 if successful, or a number not equal to 0 in
   *                  case of error (ACI_ERROR, UNSUPPORTED_VERSION,
   *                  WRONG_IMAGE_SIZE, CRC_ERROR)
   */
 int program_device(const uint8_t *fw_image, uint32_t fw_size);
 
+/**
+  * @brief  Statistics of the last program_device() call, e.g. the flashing time.
+  * @retval Pointer to the statistics
+  */
+const Updater_stats_TypeDef *getBlueNRGUpdaterStats(void);
+
 /**
   * @brief  Read raw data from IFR (3 64-bytes blocks).
   * @param  data     Pointer to the buffer that will contain the read data.
@@ -95,12 +95,17 @@ typedef __packed struct _disconnect_cp{
  */
 #define OGF_HOST_CTL            0x03
 
-/* 具体结构体定义通过如下方式查询 --- 这里并未定义相关结构体
+/* 具体结构体定义通过如下方式查询
  * core 5.4 -> vol4: Host Controller Interface -> 
  * Part E: HOST CONTROLLER INTERFACE FUNCTIONAL SPECIFICATION -> 
- * 77.3.1 Set Event Mask command
+ * 7.3.1 Set Event Mask command
+ * 事件代码 n（0x01 ~ 0x3E）对应 mask 的第 n-1 位，例如 EVT_DISCONN_COMPLETE 为第 4 位，EVT_LE_META_EVENT 为第 61 位
  */
 #define OCF_SET_EVENT_MASK      0x0001
+typedef __packed struct _set_event_mask_cp{
+  uint8_t mask[8];
+} PACKED set_event_mask_cp;
+#define SET_EVENT_MASK_CP_SIZE  8
 /* 具体结构体定义通过如下方式查询 --- 这里并未定义相关结构体
  * core 5.4 -> vol4: Host Controller Interface -> 
  * Part E: HOST CONTROLLER INTERFACE FUNCTIONAL SPECIFICATION -> 
@@ -107,6 +107,12 @@
 
 int hci_reset(void);
 
+/* Event masks: bit n-1 enables the HCI event code n (Set Event Mask),
+ * bit n-1 enables the LE meta subevent n (LE Set Event Mask) */
+int hci_set_event_mask(const uint8_t mask[8]);
+
+int hci_le_set_event_mask(const uint8_t mask[8]);
+
 int hci_disconnect(uint16_t handle, uint8_t reason);
 
 int hci_le_set_advertise_enable(uint8_t enable);
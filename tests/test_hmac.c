@@ -0,0 +1,110 @@
+/*
+ * test_hmac.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Host test of sha256.c against the vectors of FIPS 180-4 and RFC 4231.
+ *
+ *  make -C tests
+ */
+
+#include "sha256.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do{ \
+		if(!(cond)){ \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			failures++; \
+		} \
+	} while(0)
+
+/*
+ * @brief Compare a digest with its hex string
+ */
+static int digest_is(const uint8_t digest[SHA256_DIGEST_SIZE], const char *hex){
+	char s[2 * SHA256_DIGEST_SIZE + 1];
+	int i;
+
+	for(i = 0; i < SHA256_DIGEST_SIZE; i++)
+		sprintf(s + 2 * i, "%02x", digest[i]);
+	return strcmp(s, hex) == 0;
+}
+
+static void sha256_of(const void *data, uint32_t len, uint8_t digest[SHA256_DIGEST_SIZE]){
+	sha256_t ctx;
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, data, len);
+	sha256_final(&ctx, digest);
+}
+
+/*
+ * @brief FIPS 180-4 examples, the padding on one and on two blocks
+ */
+static void test_sha256(void){
+	static const char two_blocks[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	uint8_t digest[SHA256_DIGEST_SIZE];
+
+	sha256_of("", 0, digest);
+	CHECK(digest_is(digest, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+	sha256_of("abc", 3, digest);
+	CHECK(digest_is(digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+	sha256_of(two_blocks, sizeof(two_blocks) - 1, digest);
+	CHECK(digest_is(digest, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+}
+
+/*
+ * @brief One million 'a' hashed in pieces of odd lengths, across the blocks
+ */
+static void test_sha256_stream(void){
+	uint8_t chunk[1000], digest[SHA256_DIGEST_SIZE];
+	uint32_t left = 1000000, n, step = 1;
+	sha256_t ctx;
+
+	memset(chunk, 'a', sizeof(chunk));
+	sha256_init(&ctx);
+	while(left > 0){
+		n = step < left ? step : left;
+		sha256_update(&ctx, chunk, n);
+		left -= n;
+		step = (step * 7 + 3) % sizeof(chunk) + 1;
+	}
+	sha256_final(&ctx, digest);
+	CHECK(digest_is(digest, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+}
+
+/*
+ * @brief RFC 4231 test cases 1, 2 and 6 (key longer than a block)
+ */
+static void test_hmac(void){
+	uint8_t key[131], mac[SHA256_DIGEST_SIZE];
+	static const char msg6[] = "Test Using Larger Than Block-Size Key - Hash Key First";
+
+	memset(key, 0x0b, 20);
+	hmac_sha256(key, 20, (const uint8_t *)"Hi There", 8, mac);
+	CHECK(digest_is(mac, "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"));
+
+	hmac_sha256((const uint8_t *)"Jefe", 4, (const uint8_t *)"what do ya want for nothing?", 28, mac);
+	CHECK(digest_is(mac, "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+
+	memset(key, 0xaa, sizeof(key));
+	hmac_sha256(key, sizeof(key), (const uint8_t *)msg6, sizeof(msg6) - 1, mac);
+	CHECK(digest_is(mac, "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"));
+}
+
+int main(void){
+	test_sha256();
+	test_sha256_stream();
+	test_hmac();
+
+	if(failures){
+		printf("test_hmac: %d checks failed\n", failures);
+		return 1;
+	}
+	printf("test_hmac: passed\n");
+	return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * test_ifr.c
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Host test of the encoding of the IFR configuration block: offsets of
+ *  the fields, little-endian and BCD fields, bytes left untouched,
+ *  validation, sleep clock classes and profiles. Only the encoding helpers
+ *  of bluenrg_utils.c and ble_ifr.c are linked, see the Makefile.
+ *
+ *  make -C tests
+ */
+
+#include "ble_ifr.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define IFR_CONFIG_BLOCK       offsetof(IFR_config_TypeDef, stack_mode)
+#define IFR_CONFIG_BLOCK_LEN   64
+
+static int failures;
+
+#define CHECK(cond) do{ \
+		if(!(cond)){ \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			failures++; \
+		} \
+	} while(0)
+
+static const IFR_config2_TypeDef sample = {
+	.stack_mode = 3, .day = 17, .month = 10, .year = 26,
+	.slave_sca_ppm = 0x1234, .master_sca = 5, .hs_startup_time = 0x0ABC,
+};
+
+/*
+ * @brief Layout of the IFR, the configuration block at byte 128
+ */
+static void test_layout(void){
+	CHECK(sizeof(IFR_config_TypeDef) == 192);
+	CHECK(IFR_CONFIG_BLOCK == 128);
+	CHECK(offsetof(IFR_config_TypeDef, slave_sca_ppm) == IFR_CONFIG_BLOCK + 28);
+	CHECK(offsetof(IFR_config_TypeDef, master_sca) == IFR_CONFIG_BLOCK + 30);
+	CHECK(offsetof(IFR_config_TypeDef, hs_startup_time) == IFR_CONFIG_BLOCK + 32);
+	CHECK(offsetof(IFR_config_TypeDef, year) == IFR_CONFIG_BLOCK + 41);
+}
+
+/*
+ * @brief change_IFR_data_config() writes its fields only, then
+ * 			parse_IFR_data_config() reads them back
+ */
+static void test_encode_parse(void){
+	uint8_t data[IFR_CONFIG_BLOCK_LEN];
+	IFR_config2_TypeDef in = sample, out;
+	uint8_t i;
+
+	memset(data, 0xA5, sizeof(data));
+	change_IFR_data_config(&in, data);
+	CHECK(data[0] == 3);
+	CHECK(data[28] == 0x34 && data[29] == 0x12);
+	CHECK(data[30] == 5);
+	CHECK(data[32] == 0xBC && data[33] == 0x0A);
+	CHECK(data[41] == 0x26 && data[42] == 0x10 && data[43] == 0x17);
+	for(i = 0; i < sizeof(data); i++){
+		if(i == 0 || i == 28 || i == 29 || i == 30 || i == 32 || i == 33 || (i >= 41 && i <= 43))
+			continue;
+		CHECK(data[i] == 0xA5);
+	}
+
+	memset(&out, 0, sizeof(out));
+	parse_IFR_data_config(data, &out);
+	CHECK(out.stack_mode == in.stack_mode);
+	CHECK(out.slave_sca_ppm == in.slave_sca_ppm);
+	CHECK(out.master_sca == in.master_sca);
+	CHECK(out.hs_startup_time == in.hs_startup_time);
+	CHECK(out.year == in.year && out.month == in.month && out.day == in.day);
+}
+
+/*
+ * @brief IFR_validate() refuses the fields out of range
+ */
+static void test_validate(void){
+	IFR_config2_TypeDef config = sample;
+
+	CHECK(IFR_validate(&config) == BLE_UTIL_SUCCESS);
+	config.stack_mode = 5;
+	CHECK(IFR_validate(&config) == BLE_UTIL_PARSE_ERROR);
+	config.stack_mode = 3;
+	config.master_sca = 8;
+	CHECK(IFR_validate(&config) == BLE_UTIL_PARSE_ERROR);
+	config.master_sca = 5;
+	config.month = 13;
+	CHECK(IFR_validate(&config) == BLE_UTIL_PARSE_ERROR);
+}
+
+/*
+ * @brief Bounds of the master sleep clock accuracy classes
+ */
+static void test_sca_class(void){
+	CHECK(ble_ifr_sca_class(500) == 0);
+	CHECK(ble_ifr_sca_class(251) == 0);
+	CHECK(ble_ifr_sca_class(250) == 1);
+	CHECK(ble_ifr_sca_class(50) == 5);
+	CHECK(ble_ifr_sca_class(31) == 5);
+	CHECK(ble_ifr_sca_class(20) == 7);
+	CHECK(ble_ifr_sca_class(0) == 7);
+}
+
+/*
+ * @brief The profiles change their fields only and stay valid
+ */
+static void test_profiles(void){
+	IFR_config2_TypeDef config = sample;
+
+	ble_ifr_profile_config(BLE_IFR_PROFILE_NONE, &config);
+	CHECK(config.stack_mode == sample.stack_mode);
+	CHECK(config.slave_sca_ppm == sample.slave_sca_ppm && config.master_sca == sample.master_sca);
+
+	ble_ifr_profile_config(BLE_IFR_PROFILE_MAX_THROUGHPUT, &config);
+	CHECK(config.stack_mode == 2);
+	CHECK(config.slave_sca_ppm == sample.slave_sca_ppm && config.master_sca == sample.master_sca);
+
+	ble_ifr_profile_config(BLE_IFR_PROFILE_MAX_LINKS, &config);
+	CHECK(config.stack_mode == 3);
+
+	ble_ifr_profile_config(BLE_IFR_PROFILE_LOW_POWER, &config);
+	CHECK(config.stack_mode == 1);
+	CHECK(config.slave_sca_ppm == BLE_IFR_SLEEP_CLOCK_PPM);
+	CHECK(config.master_sca == ble_ifr_sca_class(BLE_IFR_SLEEP_CLOCK_PPM));
+	CHECK(IFR_validate(&config) == BLE_UTIL_SUCCESS);
+}
+
+int main(void){
+	test_layout();
+	test_encode_parse();
+	test_validate();
+	test_sca_class();
+	test_profiles();
+
+	if(failures){
+		printf("test_ifr: %d checks failed\n", failures);
+		return 1;
+	}
+	printf("test_ifr: passed\n");
+	return 0;
+}